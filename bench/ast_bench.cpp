@@ -0,0 +1,216 @@
+// AST walk microbenchmark
+// Parse a synthetic program into the pointer-based AST, convert it into a
+// FlatAST and compare the time of full walks over both representations
+//
+// Usage: ast_bench [-functions <N>] [-reps <N>]
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Errors.h"
+#include "FlatAST.h"
+#include "Init.h"
+#include "Parser.h"
+#include "synthetic.h"
+
+using namespace myComp;
+
+namespace {
+// Visit every node of the pointer-based tree
+uint64_t walk(const ASTNode_ *node) {
+    if (node == nullptr)
+        return 0;
+
+    uint64_t sum = static_cast<uint64_t>(node->node_type()) + 1;
+    switch (node->node_type()) {
+    case ASTNodeType::COMPOUND:
+        for (auto *statement :
+             static_cast<const CodeBlockNode *>(node)->get_statements())
+            sum += walk(statement);
+        break;
+    case ASTNodeType::FUNCTION_DECLARATION:
+        sum += walk(
+            static_cast<const FunctionDefinitionNode *>(node)->get_code_block());
+        break;
+    case ASTNodeType::IF: {
+        auto *if_node = static_cast<const IfNode *>(node);
+        sum += walk(if_node->get_condition()) + walk(if_node->get_if_block()) +
+               walk(if_node->get_else_block());
+        break;
+    }
+    case ASTNodeType::WHILE: {
+        auto *while_node = static_cast<const WhileNode *>(node);
+        sum += walk(while_node->get_condition()) +
+               walk(while_node->get_code_block());
+        break;
+    }
+    case ASTNodeType::FOR: {
+        auto *for_node = static_cast<const ForNode *>(node);
+        sum += walk(for_node->get_initializer()) +
+               walk(for_node->get_condition()) +
+               walk(for_node->get_increment()) +
+               walk(for_node->get_code_block());
+        break;
+    }
+    case ASTNodeType::RETURN:
+        sum += walk(static_cast<const ReturnNode *>(node)->get_expression());
+        break;
+    case ASTNodeType::INT_LITERAL:
+        sum += static_cast<const LiteralNode *>(node)->get_int_value();
+        break;
+    case ASTNodeType::FUNCTION_CALL:
+        for (auto *argument :
+             static_cast<const FunctionCallNode *>(node)->get_arguments())
+            sum += walk(argument);
+        break;
+    case ASTNodeType::VARIABLE:
+    case ASTNodeType::VARIABLE_DECLARATION:
+    case ASTNodeType::STRING_LITERAL:
+        break;
+    default: {
+        auto *expression = static_cast<const ExpressionNode *>(node);
+        if (expression->is_binary()) {
+            auto *binary = static_cast<const BinaryExpressionNode *>(node);
+            sum += walk(binary->get_left()) + walk(binary->get_right());
+        } else {
+            sum += walk(static_cast<const UnaryExpressionNode *>(node)
+                            ->get_operand());
+        }
+    }
+    }
+    return sum;
+}
+
+// Visit every node of the flat tree, same result as the walk above
+uint64_t walk(const FlatAST &ast, FlatAST::Index index) {
+    if (index == FlatAST::NONE)
+        return 0;
+
+    const FlatAST::Node &node = ast.node(index);
+    uint64_t sum = static_cast<uint64_t>(node.kind) + 1;
+    if (node.kind == ASTNodeType::INT_LITERAL)
+        sum += node.value;
+    for (FlatAST::Index child : ast.children(index))
+        sum += walk(ast, child);
+    return sum;
+}
+
+// Nodes are contiguous, a visit that does not need the structure is a scan
+uint64_t scan(const FlatAST &ast) {
+    uint64_t sum = 0;
+    for (FlatAST::Index i = 0; i < ast.size(); i++) {
+        const FlatAST::Node &node = ast.node(i);
+        sum += static_cast<uint64_t>(node.kind) + 1;
+        if (node.kind == ASTNodeType::INT_LITERAL)
+            sum += node.value;
+    }
+    return sum;
+}
+
+template <typename F> double time_reps(int reps, uint64_t &result, F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++)
+        result = f();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / reps * 1e3;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    int functions = 20000;
+    int reps = 10;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-functions" && i + 1 < argc) {
+            functions = std::stoi(argv[++i]);
+        } else if (arg == "-reps" && i + 1 < argc) {
+            reps = std::stoi(argv[++i]);
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        auto source =
+            std::filesystem::temp_directory_path() / "mycomp_ast_bench.c";
+        {
+            std::ofstream out(source);
+            out << bench::many_functions(functions);
+        }
+
+        // Parse with the regular front end
+        Init::init();
+        Arena arena;
+        TokenProcessor token_processor;
+        token_processor.set_input(source);
+        token_processor.stream();
+        Parser parser;
+        parser.set_processor(&token_processor);
+        parser.set_arena(&arena);
+
+        std::vector<ASTNode_ *> trees;
+        while (!token_processor.eof()) {
+            if (ASTNode_ *tree = parser.build_tree(); tree != nullptr)
+                trees.push_back(tree);
+        }
+        std::filesystem::remove(source);
+
+        // Convert, keeping the roots
+        FlatAST ast;
+        std::vector<FlatAST::Index> roots;
+        auto start = std::chrono::steady_clock::now();
+        for (auto *tree : trees)
+            roots.push_back(ast.convert(tree));
+        std::chrono::duration<double> convert_time =
+            std::chrono::steady_clock::now() - start;
+
+        // Both representations must describe the same program
+        std::ostringstream tree_dump, flat_dump;
+        for (size_t i = 0; i < trees.size(); i++) {
+            trees[i]->print(tree_dump, 0);
+            ast.print(flat_dump, roots[i], 0);
+        }
+        if (tree_dump.str() != flat_dump.str())
+            throw LogicException("flat AST differs from the tree");
+
+        uint64_t tree_sum = 0, flat_sum = 0, scan_sum = 0;
+        double tree_ms = time_reps(reps, tree_sum, [&] {
+            uint64_t sum = 0;
+            for (auto *tree : trees)
+                sum += walk(tree);
+            return sum;
+        });
+        double flat_ms = time_reps(reps, flat_sum, [&] {
+            uint64_t sum = 0;
+            for (auto root : roots)
+                sum += walk(ast, root);
+            return sum;
+        });
+        double scan_ms = time_reps(reps, scan_sum, [&] { return scan(ast); });
+        if (tree_sum != flat_sum || flat_sum != scan_sum)
+            throw LogicException("walks disagree");
+
+        std::cout << std::fixed << std::setprecision(2) << ast.size()
+                  << " nodes, converted in " << convert_time.count() * 1e3
+                  << " ms\n"
+                  << "  tree  " << std::setw(10) << arena.bytes_used()
+                  << " bytes  walk " << std::setw(8) << tree_ms << " ms\n"
+                  << "  flat  " << std::setw(10) << ast.bytes()
+                  << " bytes  walk " << std::setw(8) << flat_ms << " ms"
+                  << "  scan " << scan_ms << " ms\n";
+        Init::end();
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,359 @@
+// Compile throughput benchmark
+// Generate synthetic programs that each stress one part of the compiler, run
+// the whole compilation on them and report the time of every phase with the
+// throughput in tokens/s, AST nodes/s and bytes of output/s
+// - Each compilation runs in a child process, so that its peak RSS is its
+//   own
+// - The median of the repetitions is kept and the results are also written
+//   as JSON, so that the numbers of two revisions can be compared
+//
+// Usage: compile_bench [-scale <F>] [-reps <N>] [-only <scenario>]
+//                      [-label <text>] [-o <file>]
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Compiler.h"
+#include "Errors.h"
+#include "TimeReport.h"
+#include "synthetic.h"
+
+using namespace myComp;
+
+namespace {
+// A few functions, each assigning one expression of `n` terms
+std::string long_expressions(int n) {
+    static const char *operators[] = {"+", "-", "*", "&", "|", "^"};
+    std::mt19937 rng(42);
+    std::vector<std::string> leaves = {"a", "b", "c", "d"};
+    std::ostringstream out;
+    for (int f = 0; f < 8; f++) {
+        out << "int e" << f << "(int a, int b, int c, int d) {\n"
+            << "    int x;\n    x = " << leaves[f % leaves.size()];
+        // A long chain, some of the terms small trees of their own
+        for (int i = 1; i < n; i++) {
+            out << " " << operators[rng() % std::size(operators)] << " "
+                << (rng() % 8 == 0 ? bench::expression(rng, 2, leaves)
+                                   : leaves[rng() % leaves.size()]);
+        }
+        out << ";\n    return x;\n}\n";
+    }
+    return out.str();
+}
+
+// Blocks nested `n` deep, cycling through if, while and for
+std::string deep_nesting(int n) {
+    std::ostringstream out;
+    out << "int nest(int a) {\n    int x;\n    int i;\n    x = 0;\n";
+    for (int i = 0; i < n; i++) {
+        switch (i % 3) {
+        case 0:
+            out << "if (x < a) {\n";
+            break;
+        case 1:
+            out << "while (x < a) {\n";
+            break;
+        default:
+            out << "for (i = 0; i < a; i++) {\n";
+            break;
+        }
+        out << "x = x + " << i % 7 + 1 << ";\n";
+    }
+    for (int i = 0; i < n; i++)
+        out << "}\n";
+    out << "    return x;\n}\n";
+    return out.str();
+}
+
+// `n` global variables of every type, written and read by functions of 64
+// statements each
+std::string many_globals(int n) {
+    static const char *types[] = {"int", "char", "long"};
+    std::mt19937 rng(42);
+    std::ostringstream out;
+    for (int g = 0; g < n; g++) {
+        out << types[g % std::size(types)] << " g" << g;
+        if (g % 5 == 4)
+            out << "[" << 1 + rng() % 64 << "]";
+        out << ";\n";
+    }
+    for (int g = 0, f = 0; g < n; f++) {
+        out << "long use" << f << "(long a) {\n";
+        for (int s = 0; s < 64 && g < n; s++, g++) {
+            if (g % 5 == 4)
+                out << "    g" << g << "[0] = a;\n    a = a + g" << g
+                    << "[0];\n";
+            else
+                out << "    g" << g << " = a;\n    a = a + g" << g << ";\n";
+        }
+        out << "    return a;\n}\n";
+    }
+    return out.str();
+}
+
+// `n` string literals, printed by functions of 64 calls each
+std::string many_strings(int n) {
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyz ";
+    std::mt19937 rng(42);
+    std::ostringstream out;
+    out << "void printf(char *fmt, ...);\n";
+    for (int s = 0, f = 0; s < n; f++) {
+        out << "void print" << f << "(int a) {\n";
+        for (int i = 0; i < 64 && s < n; i++, s++) {
+            std::string text;
+            for (int len = 4 + rng() % 40; len > 0; len--)
+                text += letters[rng() % (std::size(letters) - 1)];
+            out << "    printf(\"" << s << " " << text << " %d\\n\", a);\n";
+        }
+        out << "}\n";
+    }
+    return out.str();
+}
+
+struct Scenario {
+    const char *name;
+    int size; // At -scale 1
+    std::function<std::string(int)> generate;
+};
+
+// What a compilation measured, sent back by the child process
+struct Sample {
+    double scan_ms;
+    double parse_ms;
+    double codegen_ms;
+    double write_ms;
+    uint64_t tokens;
+    uint64_t nodes;
+    uint64_t output_bytes;
+    long peak_rss_kb;
+};
+
+// Compile a file to an object file, the way the compiler does it
+Sample compile(const std::filesystem::path &source,
+               const std::filesystem::path &output) {
+    CompileOptions options;
+    options.timing = true;
+    options.output = output.string();
+    TimeReport report;
+    std::ostringstream log;
+    CompileResult result =
+        myComp::compile(source.string(), options, report, log);
+
+    Sample sample{};
+    sample.scan_ms = report.usage("scan").milliseconds;
+    sample.parse_ms = report.usage("parse").milliseconds;
+    sample.codegen_ms = report.usage("codegen").milliseconds;
+    sample.write_ms = report.usage("write").milliseconds;
+    sample.tokens = result.tokens;
+    sample.nodes = result.nodes;
+    sample.output_bytes = std::filesystem::file_size(output);
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    sample.peak_rss_kb = usage.ru_maxrss;
+    return sample;
+}
+
+// Compile in a child process
+Sample compile_in_child(const std::filesystem::path &source,
+                        const std::filesystem::path &output) {
+    int fds[2];
+    if (pipe(fds) != 0)
+        throw IOException("cannot create a pipe");
+
+    pid_t pid = fork();
+    if (pid < 0)
+        throw IOException("cannot fork");
+    if (pid == 0) {
+        close(fds[0]);
+        int status = 0;
+        try {
+            Sample sample = compile(source, output);
+            if (write(fds[1], &sample, sizeof(sample)) != sizeof(sample))
+                status = 1;
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            status = 1;
+        }
+        _exit(status);
+    }
+
+    close(fds[1]);
+    Sample sample{};
+    ssize_t received = read(fds[0], &sample, sizeof(sample));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (received != sizeof(sample) || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0)
+        throw LogicException("compilation of " + source.string() + " failed");
+    return sample;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 == 1
+               ? values[middle]
+               : (values[middle - 1] + values[middle]) / 2;
+}
+
+// Per second, 0 if the time is too short to tell
+double rate(double count, double ms) { return ms > 0 ? count / ms * 1e3 : 0; }
+
+struct Result {
+    std::string scenario;
+    int size;
+    uint64_t source_bytes;
+    Sample sample; // Median times
+};
+
+void write_json(std::ostream &os, const std::string &label, int reps,
+                const std::vector<Result> &results) {
+    os << std::fixed << std::setprecision(3) << "{\n  \"label\": \"";
+    for (char c : label) {
+        if (c == '"' || c == '\\')
+            os << '\\';
+        os << c;
+    }
+    os << "\",\n  \"reps\": " << reps << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        const Sample &s = r.sample;
+        double total = s.scan_ms + s.parse_ms + s.codegen_ms + s.write_ms;
+        os << (i == 0 ? "\n" : ",\n") << "    {\"scenario\": \"" << r.scenario
+           << "\", \"size\": " << r.size
+           << ", \"source_bytes\": " << r.source_bytes
+           << ", \"tokens\": " << s.tokens << ", \"nodes\": " << s.nodes
+           << ", \"output_bytes\": " << s.output_bytes
+           << ", \"scan_ms\": " << s.scan_ms
+           << ", \"parse_ms\": " << s.parse_ms
+           << ", \"codegen_ms\": " << s.codegen_ms
+           << ", \"write_ms\": " << s.write_ms << ", \"total_ms\": " << total
+           << ", \"tokens_per_s\": " << rate(s.tokens, s.scan_ms)
+           << ", \"nodes_per_s\": " << rate(s.nodes, s.parse_ms)
+           << ", \"output_bytes_per_s\": "
+           << rate(s.output_bytes, s.codegen_ms + s.write_ms)
+           << ", \"peak_rss_kb\": " << s.peak_rss_kb << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    double scale = 1;
+    int reps = 5;
+    std::string only;
+    std::string label;
+    std::string output = "compile_bench.json";
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-scale" && i + 1 < argc) {
+            scale = std::stod(argv[++i]);
+        } else if (arg == "-reps" && i + 1 < argc) {
+            reps = std::stoi(argv[++i]);
+        } else if (arg == "-only" && i + 1 < argc) {
+            only = argv[++i];
+        } else if (arg == "-label" && i + 1 < argc) {
+            label = argv[++i];
+        } else if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    const std::vector<Scenario> scenarios = {
+        {"functions", 2000, bench::many_functions},
+        {"expressions", 2000, long_expressions},
+        {"nesting", 300, deep_nesting},
+        {"globals", 5000, many_globals},
+        {"strings", 5000, many_strings},
+    };
+
+    try {
+        if (reps < 1)
+            throw InvalidException("repetition count " + std::to_string(reps));
+
+        auto directory = std::filesystem::temp_directory_path();
+        auto source = directory / "mycomp_compile_bench.c";
+        auto object = directory / "mycomp_compile_bench.o";
+
+        std::vector<Result> results;
+        for (const auto &scenario : scenarios) {
+            if (!only.empty() && only != scenario.name)
+                continue;
+            int size = std::max(1, static_cast<int>(scenario.size * scale));
+            std::string code = scenario.generate(size);
+            {
+                std::ofstream out(source);
+                out << code;
+            }
+
+            std::vector<Sample> samples;
+            for (int r = 0; r < reps; r++)
+                samples.push_back(compile_in_child(source, object));
+
+            // The counts are the same every time, the times are medians
+            Sample sample = samples[0];
+            auto middle = [&](double Sample::*field) {
+                std::vector<double> values;
+                for (const auto &s : samples)
+                    values.push_back(s.*field);
+                return median(values);
+            };
+            sample.scan_ms = middle(&Sample::scan_ms);
+            sample.parse_ms = middle(&Sample::parse_ms);
+            sample.codegen_ms = middle(&Sample::codegen_ms);
+            sample.write_ms = middle(&Sample::write_ms);
+            results.push_back({scenario.name, size, code.size(), sample});
+        }
+        std::filesystem::remove(source);
+        std::filesystem::remove(object);
+        if (results.empty())
+            throw InvalidException("scenario " + only);
+
+        std::cout << std::left << std::setw(12) << "scenario" << std::right
+                  << std::setw(10) << "tokens" << std::setw(10) << "nodes"
+                  << std::setw(10) << "scan ms" << std::setw(10) << "parse ms"
+                  << std::setw(10) << "cg ms" << std::setw(10) << "write ms"
+                  << std::setw(10) << "Mtok/s" << std::setw(10) << "Mnode/s"
+                  << std::setw(10) << "MB out/s" << '\n'
+                  << std::fixed << std::setprecision(2);
+        for (const auto &r : results) {
+            const Sample &s = r.sample;
+            std::cout << std::left << std::setw(12) << r.scenario << std::right
+                      << std::setw(10) << s.tokens << std::setw(10) << s.nodes
+                      << std::setw(10) << s.scan_ms << std::setw(10)
+                      << s.parse_ms << std::setw(10) << s.codegen_ms
+                      << std::setw(10) << s.write_ms << std::setw(10)
+                      << rate(s.tokens, s.scan_ms) / 1e6 << std::setw(10)
+                      << rate(s.nodes, s.parse_ms) / 1e6 << std::setw(10)
+                      << rate(s.output_bytes, s.codegen_ms + s.write_ms) /
+                             1e6
+                      << '\n';
+        }
+
+        std::ofstream out(output);
+        write_json(out, label, reps, results);
+        std::cout << "Results written to " << output << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+// Lexer microbenchmark
+// Scan synthetic and real inputs with every scan kernel level supported by
+// the CPU and report the throughput in MB/s
+//
+// Usage: lexer_bench [-size <MB>] [-reps <N>] [files...]
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ScanKernel.h"
+#include "Scanner.h"
+
+using namespace myComp;
+
+namespace {
+// Generate C-like source code of roughly `size` bytes
+std::string generate_source(size_t size) {
+    static const char *keywords[] = {"int", "char", "long", "if",
+                                     "while", "for", "return", "void"};
+    static const char *operators[] = {"+",  "-",  "*",  "/", "=", "==",
+                                      "<=", ">>", "&&", ";", ",", "("};
+    std::mt19937 rng(42);
+    std::string out;
+    out.reserve(size + 256);
+
+    auto identifier = [&] {
+        int len = 1 + rng() % 24;
+        std::string id(1, "abcdefghijklmnopqrstuvwxyz_"[rng() % 27]);
+        for (int i = 1; i < len; i++)
+            id += "abcdefghijklmnopqrstuvwxyz_0123456789"[rng() % 37];
+        return id;
+    };
+
+    while (out.size() < size) {
+        // Indentation
+        out.append(4 * (rng() % 4), ' ');
+
+        // A statement of a few tokens
+        int n = 3 + rng() % 10;
+        for (int i = 0; i < n; i++) {
+            switch (rng() % 4) {
+            case 0:
+                out += keywords[rng() % std::size(keywords)];
+                break;
+            case 1:
+                out += std::to_string(rng() % 1000000);
+                break;
+            case 2:
+                out += operators[rng() % std::size(operators)];
+                break;
+            default:
+                out += identifier();
+                break;
+            }
+            out += ' ';
+        }
+        out += rng() % 8 == 0 ? "\n\n" : "\n";
+    }
+    return out;
+}
+
+// Scan the whole file, return the number of tokens
+size_t scan_file(const std::string &filename) {
+    Scanner scanner;
+    scanner.set_input(filename);
+    uint8_t kind = 0;
+    uint32_t payload = 0;
+    size_t count = 0;
+    for (scanner.next(kind, payload);
+         static_cast<TokenType>(kind) != TokenType::T_EOF;
+         scanner.next(kind, payload))
+        count++;
+    return count;
+}
+
+void run(const std::string &label, const std::string &filename, int reps) {
+    double megabytes =
+        static_cast<double>(std::filesystem::file_size(filename)) / 1e6;
+
+    std::cout << label << " (" << std::fixed << std::setprecision(1)
+              << megabytes << " MB)\n";
+
+    for (auto level : {ScanKernel::Level::SCALAR, ScanKernel::Level::SSE2,
+                       ScanKernel::Level::AVX2}) {
+        if (level > ScanKernel::detect())
+            continue;
+        ScanKernel::select(level);
+
+        // Warm up the page cache and the symbol table
+        size_t tokens = scan_file(filename);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < reps; i++)
+            scan_file(filename);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        std::cout << "  " << std::setw(8) << std::left
+                  << ScanKernel::name(level) << std::right << std::setw(10)
+                  << std::setprecision(1) << megabytes * reps / elapsed.count()
+                  << " MB/s  " << tokens << " tokens\n";
+    }
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t size = 16;
+    int reps = 5;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-size" && i + 1 < argc) {
+            size = std::stoul(argv[++i]);
+        } else if (arg == "-reps" && i + 1 < argc) {
+            reps = std::stoi(argv[++i]);
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    try {
+        // Synthetic input
+        auto synthetic = std::filesystem::temp_directory_path() /
+                         "mycomp_lexer_bench.c";
+        {
+            std::ofstream out(synthetic);
+            out << generate_source(size * 1000000);
+        }
+        run("synthetic", synthetic, reps);
+        std::filesystem::remove(synthetic);
+
+        // Real inputs
+        for (auto &file : files)
+            run(file, file, reps);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
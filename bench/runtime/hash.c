@@ -0,0 +1,74 @@
+void printint(long n);
+
+long keys[262144];
+int used[262144];
+char text[65536];
+
+long hash_key(long key) {
+    return (key * 40503 + (key >> 7)) & 262143;
+}
+
+int insert(long key) {
+    long slot;
+    slot = hash_key(key);
+    while (used[slot] && keys[slot] != key) {
+        slot = (slot + 1) & 262143;
+    }
+    if (used[slot]) {
+        return 0;
+    }
+    used[slot] = 1;
+    keys[slot] = key;
+    return 1;
+}
+
+int contains(long key) {
+    long slot;
+    slot = hash_key(key);
+    while (used[slot]) {
+        if (keys[slot] == key) {
+            return 1;
+        }
+        slot = (slot + 1) & 262143;
+    }
+    return 0;
+}
+
+long fnv(int n) {
+    long h;
+    int i;
+    h = 2166136261;
+    for (i = 0; i < n; i++) {
+        h = ((h ^ text[i]) * 16777619) & 4294967295;
+    }
+    return h;
+}
+
+int main() {
+    long seed;
+    int i;
+    int inserted;
+    int found;
+    long h;
+    seed = 7;
+    inserted = 0;
+    for (i = 0; i < 150000; i++) {
+        seed = (seed * 1103515245 + 12345) & 2147483647;
+        inserted = inserted + insert(seed % 1000000);
+    }
+    found = 0;
+    for (i = 0; i < 1000000; i++) {
+        found = found + contains(i);
+    }
+    for (i = 0; i < 65536; i++) {
+        text[i] = 97 + i * 31 % 26;
+    }
+    h = 0;
+    for (i = 0; i < 40; i++) {
+        h = h ^ fnv(65536 - i);
+    }
+    printint(inserted);
+    printint(found);
+    printint(h);
+    return 0;
+}
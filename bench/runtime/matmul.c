@@ -0,0 +1,41 @@
+void printint(long n);
+
+int ma[40000];
+int mb[40000];
+long mc[40000];
+
+int main() {
+    int n;
+    int i;
+    int j;
+    int k;
+    long sum;
+    long trace;
+    n = 200;
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            ma[i * n + j] = (i * 7 + j * 3) % 17 - 8;
+            mb[i * n + j] = (i * 5 + j * 11) % 13 - 6;
+        }
+    }
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            sum = 0;
+            for (k = 0; k < n; k++) {
+                sum = sum + ma[i * n + k] * mb[k * n + j];
+            }
+            mc[i * n + j] = sum;
+        }
+    }
+    trace = 0;
+    sum = 0;
+    for (i = 0; i < n; i++) {
+        trace = trace + mc[i * n + i];
+        for (j = 0; j < n; j++) {
+            sum = sum + mc[i * n + j] * (j % 5);
+        }
+    }
+    printint(trace);
+    printint(sum);
+    return 0;
+}
@@ -0,0 +1,36 @@
+void printint(long n);
+
+char composite[2000000];
+
+int sieve(int n) {
+    int i;
+    int j;
+    int count;
+    for (i = 0; i < n; i++) {
+        composite[i] = 0;
+    }
+    count = 0;
+    for (i = 2; i < n; i++) {
+        if (composite[i] == 0) {
+            count++;
+            if (i < 46341) {
+                for (j = i * i; j < n; j = j + i) {
+                    composite[j] = 1;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+int main() {
+    int round;
+    long total;
+    total = 0;
+    for (round = 0; round < 5; round++) {
+        total = total + sieve(2000000 - round * 1000);
+    }
+    printint(sieve(2000000));
+    printint(total);
+    return 0;
+}
@@ -0,0 +1,67 @@
+void printint(long n);
+
+int a[200000];
+long seed;
+
+int next_random() {
+    seed = (seed * 1103515245 + 12345) & 2147483647;
+    return seed % 1000000;
+}
+
+void quicksort(int lo, int hi) {
+    int pivot;
+    int i;
+    int j;
+    int t;
+    if (lo < hi) {
+        pivot = a[(lo + hi) / 2];
+        i = lo;
+        j = hi;
+        while (i <= j) {
+            while (a[i] < pivot) {
+                i++;
+            }
+            while (a[j] > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                t = a[i];
+                a[i] = a[j];
+                a[j] = t;
+                i++;
+                j--;
+            }
+        }
+        quicksort(lo, j);
+        quicksort(i, hi);
+    }
+}
+
+int main() {
+    int n;
+    int i;
+    int round;
+    int unsorted;
+    long checksum;
+    n = 200000;
+    seed = 1;
+    unsorted = 0;
+    checksum = 0;
+    for (round = 0; round < 5; round++) {
+        for (i = 0; i < n; i++) {
+            a[i] = next_random();
+        }
+        quicksort(0, n - 1);
+        for (i = 1; i < n; i++) {
+            if (a[i - 1] > a[i]) {
+                unsorted++;
+            }
+        }
+        for (i = 0; i < n; i = i + 1000) {
+            checksum = checksum + a[i];
+        }
+    }
+    printint(unsorted);
+    printint(checksum);
+    return 0;
+}
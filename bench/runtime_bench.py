@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+
+# 生成代码的运行时间基准测试
+# 用 myComp, cc -O0 和 cc -O2 编译 test/algorithm 中的程序和 bench/runtime 中的
+# 计算内核, 每个程序运行多次, 报告运行时间的中位数和最小值
+#
+# 用法: python3 bench/runtime_bench.py [-reps N] [-only 名字] [-label 文本]
+#                                      [-o 文件] [myComp 的参数...]
+# 例如 python3 bench/runtime_bench.py -reps 3 -const-propagation
+
+import argparse
+import json
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+root = Path(__file__).resolve().parent.parent
+
+
+def programs():
+    # 算法测试和计算内核, 每一项是 (名字, 源文件, 输入文件)
+    found = []
+    for source in sorted(root.joinpath("test", "algorithm", "codes").glob("*.c")):
+        input_file = source.parent.parent.joinpath("outputs", source.stem + ".in")
+        found.append(
+            (source.stem, source, input_file if input_file.exists() else None)
+        )
+    for source in sorted(root.joinpath("bench", "runtime").glob("*.c")):
+        found.append((source.stem, source, None))
+    return found
+
+
+def build(compiler, source, directory, my_args):
+    # 生成可执行文件, 失败时返回错误信息
+    executable = directory.joinpath(compiler.replace(" ", ""))
+    runtime = root.joinpath("lib", "printint.c")
+    if compiler == "myComp":
+        # myComp 在当前目录生成 out.o, 带 -S 时生成 out.s
+        result = subprocess.run(
+            [root.joinpath("myComp"), *my_args, source],
+            cwd=directory,
+            capture_output=True,
+        )
+        if result.returncode != 0:
+            return None, result.stderr.decode("utf-8").strip()
+        output_file = "out.s" if "-S" in my_args else "out.o"
+        command = ["cc", "-o", executable, directory.joinpath(output_file), runtime]
+    else:
+        # 语言中 char 是无符号的, 测试程序自己声明 printf, 所以关掉警告
+        level = compiler.split()[1]
+        command = ["cc", level, "-w", "-funsigned-char", "-o", executable, source, runtime]
+    result = subprocess.run(command, capture_output=True)
+    if result.returncode != 0:
+        return None, result.stderr.decode("utf-8").strip()
+    return executable, None
+
+
+def run(executable, input_file):
+    # 运行一次, 返回输出和以毫秒计的运行时间
+    stdin = open(input_file, "r") if input_file else subprocess.DEVNULL
+    start = time.perf_counter()
+    result = subprocess.run([executable], stdin=stdin, stdout=subprocess.PIPE)
+    elapsed = (time.perf_counter() - start) * 1000
+    if stdin is not subprocess.DEVNULL:
+        stdin.close()
+    return result.stdout.decode("utf-8").strip(), elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(allow_abbrev=False)
+    parser.add_argument("-reps", type=int, default=5)
+    parser.add_argument("-only", default="")
+    parser.add_argument("-label", default="")
+    parser.add_argument("-o", dest="output", default="runtime_bench.json")
+    # 其余的参数会传给 myComp
+    args, my_args = parser.parse_known_args()
+    if args.reps < 1:
+        print(f"Invalid repetition count {args.reps}")
+        sys.exit(1)
+
+    compilers = ["myComp", "cc -O0", "cc -O2"]
+    results = []
+    all_correct = True
+
+    print(
+        f"{'program':<16}"
+        + "".join(f"{c + ' ms':>14}" for c in compilers)
+        + f"{'vs -O0':>10}{'vs -O2':>10}"
+    )
+    with tempfile.TemporaryDirectory() as temp:
+        directory = Path(temp)
+        for name, source, input_file in programs():
+            if args.only and args.only != name:
+                continue
+
+            result = {"program": name}
+            expected = None
+            line = f"{name:<16}"
+            for compiler in compilers:
+                executable, error = build(compiler, source, directory, my_args)
+                if executable is None:
+                    print(f"{name}: {compiler} failed\n{error}")
+                    all_correct = False
+                    break
+
+                outputs = set()
+                times = []
+                for _ in range(args.reps):
+                    output, elapsed = run(executable, input_file)
+                    outputs.add(output)
+                    times.append(elapsed)
+
+                # 以 cc -O0 的输出为准, myComp 必须与它一致
+                if compiler == "cc -O0":
+                    expected = outputs
+                result[compiler] = {
+                    "median_ms": statistics.median(times),
+                    "min_ms": min(times),
+                    "outputs": outputs,
+                }
+                line += f"{statistics.median(times):>14.2f}"
+            else:
+                if result["myComp"]["outputs"] != expected:
+                    print(f"{name}: myComp output differs from cc -O0")
+                    all_correct = False
+                    result["correct"] = False
+                else:
+                    result["correct"] = True
+                mine = result["myComp"]["median_ms"]
+                for compiler in compilers:
+                    del result[compiler]["outputs"]
+                    result[compiler]["ratio"] = mine / result[compiler]["median_ms"]
+                line += f"{result['cc -O0']['ratio']:>10.2f}"
+                line += f"{result['cc -O2']['ratio']:>10.2f}"
+                print(line)
+                results.append(result)
+
+    with open(args.output, "w") as f:
+        json.dump(
+            {
+                "label": args.label,
+                "reps": args.reps,
+                "args": my_args,
+                "results": results,
+            },
+            f,
+            indent=2,
+        )
+        f.write("\n")
+    print(f"Results written to {args.output}")
+
+    if not all_correct:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,65 @@
+#ifndef MYCOMP_BENCH_SYNTHETIC_H
+#define MYCOMP_BENCH_SYNTHETIC_H
+
+// Synthetic programs shared by the benchmarks, the same size always gives
+// the same program
+
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+// A random expression over the given leaves, `depth` levels deep at most
+inline std::string expression(std::mt19937 &rng, int depth,
+                              const std::vector<std::string> &leaves) {
+    static const char *operators[] = {"+", "-", "*", "&", "|",
+                                      "^", "<", "==", "&&", "||"};
+    if (depth == 0 || rng() % 4 == 0) {
+        return rng() % 3 == 0 ? std::to_string(rng() % 100)
+                              : leaves[rng() % leaves.size()];
+    }
+    return "(" + expression(rng, depth - 1, leaves) + " " +
+           operators[rng() % std::size(operators)] + " " +
+           expression(rng, depth - 1, leaves) + ")";
+}
+
+// `n` functions of random statements, each calling the one before it
+inline std::string many_functions(int n) {
+    std::mt19937 rng(42);
+    std::vector<std::string> leaves = {"a", "b", "x", "y"};
+    std::ostringstream out;
+    for (int f = 0; f < n; f++) {
+        out << "int f" << f << "(int a, int b) {\n"
+            << "    int x;\n    int y;\n    x = a;\n    y = b;\n";
+        for (int s = 0; s < 8; s++) {
+            switch (rng() % 4) {
+            case 0:
+                out << "    x = " << expression(rng, 4, leaves) << ";\n";
+                break;
+            case 1:
+                out << "    if (" << expression(rng, 2, leaves) << ") {\n"
+                    << "        y = " << expression(rng, 3, leaves) << ";\n"
+                    << "    } else {\n        y = y + 1;\n    }\n";
+                break;
+            case 2:
+                out << "    while (" << expression(rng, 2, leaves) << ") {\n"
+                    << "        x = x - 1;\n    }\n";
+                break;
+            default:
+                out << "    for (y = 0; y < 10; y++) {\n"
+                    << "        x = " << expression(rng, 3, leaves) << ";\n"
+                    << "    }\n";
+                break;
+            }
+        }
+        if (f > 0)
+            out << "    x = x + f" << f - 1 << "(b, x);\n";
+        out << "    return x + y;\n}\n";
+    }
+    return out.str();
+}
+} // namespace bench
+
+#endif // MYCOMP_BENCH_SYNTHETIC_H
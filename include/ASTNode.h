@@ -1,10 +1,10 @@
 #ifndef MYCOMP_AST_H
 #define MYCOMP_AST_H
 
-#include <optional>
+#include <span>
 
+#include "Arena.h"
 #include "Type.h"
-#include "CodeGenerator.h"
 #include "Context.h"
 
 namespace myComp {
@@ -60,24 +60,25 @@ enum class ASTNodeType {
 };
 
 // Base class for all AST nodes
+// Nodes are allocated in an Arena and released all at once, so they must not
+// own any resource and are never deleted one by one
 class ASTNode_ {
   public:
-    virtual ~ASTNode_() = default;
-
     // Add flags for different types of nodes
     virtual bool is_function_definition() const = 0;
     virtual bool is_statement() const = 0;
     virtual bool is_code_block() const = 0;
 
-    virtual Type *type() const = 0;
+    // The kind of the node, lets walks dispatch with a switch
+    virtual ASTNodeType node_type() const = 0;
 
-    // Do code generation
-    // Return the register number of the return value if exists
-    virtual std::optional<int>
-    generate_code(CodeGenerator *code_generator) const = 0;
+    virtual Type *type() const = 0;
 
     // Print the AST node for debugging
     virtual void print(std::ostream &os, int indent) const = 0;
+
+  protected:
+    ~ASTNode_() = default;
 };
 
 // Base class for all statements
@@ -98,14 +99,8 @@ class StatementNode : public ASTNode_ {
 
 class CodeBlockNode : public ASTNode_ {
   public:
-    ~CodeBlockNode() override {
-        for (auto &statement : statements_) {
-            delete statement;
-        }
-    }
-
-    explicit CodeBlockNode(std::vector<StatementNode *> statements)
-        : statements_(std::move(statements)) {}
+    explicit CodeBlockNode(std::span<StatementNode *> statements)
+        : statements_(statements) {}
 
     bool is_function_definition() const override { return false; }
     bool is_statement() const override { return false; }
@@ -113,19 +108,21 @@ class CodeBlockNode : public ASTNode_ {
 
     Type *type() const override;
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::COMPOUND; }
 
     void print(std::ostream &os, int indent) const override;
 
+    std::span<StatementNode *> get_statements() const { return statements_; }
+    void set_statements(std::span<StatementNode *> statements) {
+        statements_ = statements;
+    }
+
   private:
-    std::vector<StatementNode *> statements_;
+    std::span<StatementNode *> statements_;
 };
 
 class FunctionDefinitionNode : public ASTNode_ {
   public:
-    ~FunctionDefinitionNode() override { delete code_block_; }
-
     FunctionDefinitionNode(FunctionPrototype *prototype,
                            CodeBlockNode *code_block)
         : prototype_(prototype), code_block_(code_block) {}
@@ -137,11 +134,15 @@ class FunctionDefinitionNode : public ASTNode_ {
     // The return type of the function
     Type *type() const override { return prototype_->return_type_; }
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override {
+        return ASTNodeType::FUNCTION_DECLARATION;
+    }
 
     void print(std::ostream &os, int indent) const override;
 
+    FunctionPrototype *get_prototype() const { return prototype_; }
+    CodeBlockNode *get_code_block() const { return code_block_; }
+
   private:
     FunctionPrototype *prototype_ = nullptr;
     CodeBlockNode *code_block_ = nullptr;
@@ -177,8 +178,6 @@ class ExpressionNode : public StatementNode {
 
 class VariableDeclarationNode : public StatementNode {
   public:
-    ~VariableDeclarationNode() override { delete initializer_; }
-
     VariableDeclarationNode(Variable *variable, ExpressionNode *initializer)
         : variable_(variable), initializer_(initializer) {}
 
@@ -191,11 +190,15 @@ class VariableDeclarationNode : public StatementNode {
 
     Type *type() const override { return variable_->type; }
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override {
+        return ASTNodeType::VARIABLE_DECLARATION;
+    }
 
     void print(std::ostream &os, int indent) const override;
 
+    Variable *get_variable() const { return variable_; }
+    ExpressionNode *get_initializer() const { return initializer_; }
+
   private:
     Variable *variable_ = nullptr;
     ExpressionNode *initializer_ = nullptr;
@@ -203,12 +206,6 @@ class VariableDeclarationNode : public StatementNode {
 
 class IfNode : public StatementNode {
   public:
-    ~IfNode() override {
-        delete condition_;
-        delete if_block_;
-        delete else_block_;
-    }
-
     IfNode(ExpressionNode *condition, CodeBlockNode *if_block,
            CodeBlockNode *else_block)
         : condition_(condition), if_block_(if_block), else_block_(else_block) {}
@@ -222,11 +219,15 @@ class IfNode : public StatementNode {
 
     Type *type() const override;
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::IF; }
 
     void print(std::ostream &os, int indent) const override;
 
+    ExpressionNode *get_condition() const { return condition_; }
+    CodeBlockNode *get_if_block() const { return if_block_; }
+    CodeBlockNode *get_else_block() const { return else_block_; }
+    void set_condition(ExpressionNode *condition) { condition_ = condition; }
+
   private:
     ExpressionNode *condition_ = nullptr;
     CodeBlockNode *if_block_ = nullptr;
@@ -235,11 +236,6 @@ class IfNode : public StatementNode {
 
 class WhileNode : public StatementNode {
   public:
-    ~WhileNode() override {
-        delete condition_;
-        delete code_block_;
-    }
-
     WhileNode(ExpressionNode *condition, CodeBlockNode *code_block)
         : condition_(condition), code_block_(code_block) {}
 
@@ -252,11 +248,14 @@ class WhileNode : public StatementNode {
 
     Type *type() const override;
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::WHILE; }
 
     void print(std::ostream &os, int indent) const override;
 
+    ExpressionNode *get_condition() const { return condition_; }
+    CodeBlockNode *get_code_block() const { return code_block_; }
+    void set_condition(ExpressionNode *condition) { condition_ = condition; }
+
   private:
     ExpressionNode *condition_ = nullptr;
     CodeBlockNode *code_block_ = nullptr;
@@ -264,13 +263,6 @@ class WhileNode : public StatementNode {
 
 class ForNode : public StatementNode {
   public:
-    ~ForNode() override {
-        delete initializer_;
-        delete condition_;
-        delete increment_;
-        delete code_block_;
-    }
-
     ForNode(ExpressionNode *initializer, ExpressionNode *condition,
             ExpressionNode *increment, CodeBlockNode *code_block)
         : initializer_(initializer), condition_(condition),
@@ -285,11 +277,20 @@ class ForNode : public StatementNode {
 
     Type *type() const override;
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::FOR; }
 
     void print(std::ostream &os, int indent) const override;
 
+    ExpressionNode *get_initializer() const { return initializer_; }
+    ExpressionNode *get_condition() const { return condition_; }
+    ExpressionNode *get_increment() const { return increment_; }
+    CodeBlockNode *get_code_block() const { return code_block_; }
+    void set_initializer(ExpressionNode *initializer) {
+        initializer_ = initializer;
+    }
+    void set_condition(ExpressionNode *condition) { condition_ = condition; }
+    void set_increment(ExpressionNode *increment) { increment_ = increment; }
+
   private:
     ExpressionNode *initializer_ = nullptr;
     ExpressionNode *condition_ = nullptr;
@@ -299,8 +300,6 @@ class ForNode : public StatementNode {
 
 class ReturnNode : public StatementNode {
   public:
-    ~ReturnNode() override { delete expression_; }
-
     explicit ReturnNode(ExpressionNode *expression) : expression_(expression) {}
 
     bool is_expression() const override { return false; }
@@ -312,11 +311,15 @@ class ReturnNode : public StatementNode {
 
     Type *type() const override { return expression_->type(); }
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::RETURN; }
 
     void print(std::ostream &os, int indent) const override;
 
+    ExpressionNode *get_expression() const { return expression_; }
+    void set_expression(ExpressionNode *expression) {
+        expression_ = expression;
+    }
+
   private:
     ExpressionNode *expression_ = nullptr;
 };
@@ -324,14 +327,9 @@ class ReturnNode : public StatementNode {
 // Base class for all binary expressions
 class BinaryExpressionNode : public ExpressionNode {
   public:
-    ~BinaryExpressionNode() override {
-        delete left_;
-        delete right_;
-    }
-
-    BinaryExpressionNode(std::string op, ExpressionNode *left,
+    BinaryExpressionNode(const char *op, ExpressionNode *left,
                          ExpressionNode *right)
-        : op_(std::move(op)), left_(left), right_(right) {}
+        : op_(op), left_(left), right_(right) {}
 
     bool is_binary() const override { return true; }
     bool is_unary() const override { return false; }
@@ -341,10 +339,13 @@ class BinaryExpressionNode : public ExpressionNode {
 
     ExpressionNode *get_left() const { return left_; }
     ExpressionNode *get_right() const { return right_; }
+    const char *get_op() const { return op_; }
+    void set_left(ExpressionNode *left) { left_ = left; }
+    void set_right(ExpressionNode *right) { right_ = right; }
     void swap_operands() { std::swap(left_, right_); }
 
   private:
-    std::string op_;
+    const char *op_;
     ExpressionNode *left_ = nullptr;
     ExpressionNode *right_ = nullptr;
 };
@@ -352,10 +353,8 @@ class BinaryExpressionNode : public ExpressionNode {
 // Base class for all unary expressions
 class UnaryExpressionNode : public ExpressionNode {
   public:
-    ~UnaryExpressionNode() override { delete operand_; }
-
-    UnaryExpressionNode(std::string op, ExpressionNode *operand)
-        : op_(std::move(op)), operand_(operand) {}
+    UnaryExpressionNode(const char *op, ExpressionNode *operand)
+        : op_(op), operand_(operand) {}
 
     bool is_binary() const override { return false; }
     bool is_unary() const override { return true; }
@@ -364,9 +363,11 @@ class UnaryExpressionNode : public ExpressionNode {
     void print(std::ostream &os, int indent) const override;
 
     ExpressionNode *get_operand() const { return operand_; }
+    const char *get_op() const { return op_; }
+    void set_operand(ExpressionNode *operand) { operand_ = operand; }
 
   private:
-    std::string op_;
+    const char *op_;
     ExpressionNode *operand_ = nullptr;
 };
 
@@ -386,268 +387,203 @@ class AddNode : public BinaryExpressionNode {
   public:
     AddNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
-
-  private:
-    bool _arithmetic_flag = false;
-    bool _left_pointer_flag = false;
-    bool _right_pointer_flag = false;
+    ASTNodeType node_type() const override { return ASTNodeType::ADD; }
 };
 
 class SubtractNode : public BinaryExpressionNode {
   public:
     SubtractNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
-
-  private:
-    bool _arithmetic_flag = false;
-    bool _pointer_integer_flag = false;
-    bool _pointer_flag = false;
+    ASTNodeType node_type() const override { return ASTNodeType::SUBTRACT; }
 };
 
 class MultiplyNode : public BinaryExpressionNode {
   public:
     MultiplyNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::MULTIPLY; }
 };
 
 class DivideNode : public BinaryExpressionNode {
   public:
     DivideNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::DIVIDE; }
 };
 
 class ModuloNode : public BinaryExpressionNode {
   public:
     ModuloNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::MODULO; }
 };
 
 class InvertNode : public UnaryExpressionNode {
   public:
     explicit InvertNode(ExpressionNode *operand);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::INVERT; }
 };
 
 class OrNode : public BinaryExpressionNode {
   public:
     OrNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::OR; }
 };
 
 class AndNode : public BinaryExpressionNode {
   public:
     AndNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::AND; }
 };
 
 class XorNode : public BinaryExpressionNode {
   public:
     XorNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::XOR; }
 };
 
 class LeftShiftNode : public BinaryExpressionNode {
   public:
     LeftShiftNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::L_SHIFT; }
 };
 
 class RightShiftNode : public BinaryExpressionNode {
   public:
     RightShiftNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::R_SHIFT; }
 };
 
 class LessNode : public BinaryExpressionNode {
   public:
     LessNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
-
-  private:
-    bool _arithmetic_flag = false;
-    bool _pointer_flag = false;
+    ASTNodeType node_type() const override { return ASTNodeType::LESS; }
 };
 
 class LessEqualsNode : public BinaryExpressionNode {
   public:
     LessEqualsNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
-
-  private:
-    bool _arithmetic_flag = false;
-    bool _pointer_flag = false;
+    ASTNodeType node_type() const override { return ASTNodeType::LESS_EQ; }
 };
 
 class GreaterNode : public BinaryExpressionNode {
   public:
     GreaterNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
-
-  private:
-    bool _arithmetic_flag = false;
-    bool _pointer_flag = false;
+    ASTNodeType node_type() const override { return ASTNodeType::GREATER; }
 };
 
 class GreaterEqualsNode : public BinaryExpressionNode {
   public:
     GreaterEqualsNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
-
-  private:
-    bool _arithmetic_flag = false;
-    bool _pointer_flag = false;
+    ASTNodeType node_type() const override { return ASTNodeType::GREATER_EQ; }
 };
 
 class EqualsNode : public BinaryExpressionNode {
   public:
     EqualsNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
-
-  private:
-    bool _arithmetic_flag = false;
-    bool _pointer_flag = false;
-    bool _pointer_NULL_flag = false;
+    ASTNodeType node_type() const override { return ASTNodeType::EQUALS; }
 };
 
 class NotEqualsNode : public BinaryExpressionNode {
   public:
     NotEqualsNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
-
-  private:
-    bool _arithmetic_flag = false;
-    bool _pointer_flag = false;
-    bool _pointer_NULL_flag = false;
+    ASTNodeType node_type() const override { return ASTNodeType::NEQ; }
 };
 
 class NotNode : public UnaryExpressionNode {
   public:
     explicit NotNode(ExpressionNode *operand);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::NOT; }
 };
 
 class LogicalOrNode : public BinaryExpressionNode {
   public:
     LogicalOrNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::LOGICAL_OR; }
 };
 
 class LogicalAndNode : public BinaryExpressionNode {
   public:
     LogicalAndNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::LOGICAL_AND; }
 };
 
 class AssignNode : public BinaryExpressionNode {
   public:
     AssignNode(ExpressionNode *left, ExpressionNode *right);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::ASSIGN; }
 };
 
 class AddressNode : public UnaryExpressionNode {
   public:
     explicit AddressNode(ExpressionNode *operand);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::ADDRESS; }
 };
 
 class DereferenceNode : public UnaryExpressionNode {
   public:
     explicit DereferenceNode(ExpressionNode *operand);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::DEREFERENCE; }
 };
 
 class PostIncrementNode : public UnaryExpressionNode {
   public:
     explicit PostIncrementNode(ExpressionNode *operand);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::POST_INC; }
 };
 
 class PostDecrementNode : public UnaryExpressionNode {
   public:
     explicit PostDecrementNode(ExpressionNode *operand);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::POST_DEC; }
 };
 
 class PreIncrementNode : public UnaryExpressionNode {
   public:
     explicit PreIncrementNode(ExpressionNode *operand);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::PRE_INC; }
 };
 
 class PreDecrementNode : public UnaryExpressionNode {
   public:
     explicit PreDecrementNode(ExpressionNode *operand);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::PRE_DEC; }
 };
 
 class NegativeNode : public UnaryExpressionNode {
   public:
     explicit NegativeNode(ExpressionNode *operand);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::NEGATIVE; }
 };
 
 class PositiveNode : public UnaryExpressionNode {
   public:
     explicit PositiveNode(ExpressionNode *operand);
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::POSITIVE; }
 };
 
 class VariableNode : public LeafExpressionNode {
@@ -658,8 +594,7 @@ class VariableNode : public LeafExpressionNode {
     bool is_literal() const override { return false; }
     bool is_function_call() const override { return false; }
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override { return ASTNodeType::VARIABLE; }
 
     void print(std::ostream &os, int indent) const override;
 
@@ -671,7 +606,7 @@ class VariableNode : public LeafExpressionNode {
 
 class LiteralNode : public LeafExpressionNode {
   public:
-    explicit LiteralNode(Type *type, const std::string &string_value);
+    explicit LiteralNode(Type *type, Symbol string_value);
 
     explicit LiteralNode(Type *type, long long int_value);
 
@@ -679,43 +614,42 @@ class LiteralNode : public LeafExpressionNode {
     bool is_literal() const override { return true; }
     bool is_function_call() const override { return false; }
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override {
+        return is_string_ ? ASTNodeType::STRING_LITERAL
+                          : ASTNodeType::INT_LITERAL;
+    }
 
     void print(std::ostream &os, int indent) const override;
 
     long long get_int_value() const;
-    std::string get_string_value() const;
+    Symbol get_string_value() const;
 
   private:
-    std::string string_value_;
+    Symbol string_value_;
     long long int_value_{};
     bool is_string_{false};
 };
 
 class FunctionCallNode : public LeafExpressionNode {
   public:
-    ~FunctionCallNode() override {
-        for (auto argument : arguments_) {
-            delete argument;
-        }
-    }
-
-    FunctionCallNode(const std::string &name,
-                     std::vector<ExpressionNode *> arguments);
+    FunctionCallNode(Symbol name, std::span<ExpressionNode *> arguments);
 
     bool is_variable() const override { return false; }
     bool is_literal() const override { return false; }
     bool is_function_call() const override { return true; }
 
-    std::optional<int>
-    generate_code(CodeGenerator *code_generator) const override;
+    ASTNodeType node_type() const override {
+        return ASTNodeType::FUNCTION_CALL;
+    }
 
     void print(std::ostream &os, int indent) const override;
 
+    Symbol get_name() const { return name_; }
+    std::span<ExpressionNode *> get_arguments() const { return arguments_; }
+
   private:
-    std::string name_;
-    std::vector<ExpressionNode *> arguments_;
+    Symbol name_;
+    std::span<ExpressionNode *> arguments_;
 };
 } // namespace myComp
 
@@ -0,0 +1,78 @@
+#ifndef MYCOMP_ARENA_H
+#define MYCOMP_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace myComp {
+// Bump allocator for objects that live as long as a translation unit
+// Objects are never destroyed one by one, all the memory is released at once
+// by reset() or the destructor, so they must not own any other resource
+class Arena {
+  public:
+    explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE)
+        : block_size_(block_size) {}
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    // Allocate raw memory, `align` must be a power of two
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    // Allocate memory for an AST node, counted in nodes()
+    void *allocate_node(size_t size) {
+        nodes_++;
+        return allocate(size);
+    }
+
+    // Copy the elements of a vector into the arena
+    template <typename T> std::span<T> copy(const std::vector<T> &items) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (items.empty())
+            return {};
+        T *data =
+            static_cast<T *>(allocate(sizeof(T) * items.size(), alignof(T)));
+        std::uninitialized_copy(items.begin(), items.end(), data);
+        return {data, items.size()};
+    }
+
+    // Release all the memory
+    void reset();
+
+    // Number of nodes and bytes allocated since the last reset
+    size_t nodes() const { return nodes_; }
+    size_t bytes_used() const { return bytes_used_; }
+
+    // Bytes obtained from the system
+    size_t bytes_reserved() const { return bytes_reserved_; }
+
+  private:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    // Get a new block of `size` bytes from the system
+    std::byte *new_block(size_t size);
+
+    size_t block_size_;
+    std::vector<std::unique_ptr<std::byte[]>> blocks_;
+
+    // Free space in the current block
+    std::byte *cur_ = nullptr;
+    std::byte *end_ = nullptr;
+
+    size_t nodes_ = 0;
+    size_t bytes_used_ = 0;
+    size_t bytes_reserved_ = 0;
+};
+} // namespace myComp
+
+// Allocate an AST node in an arena: new (arena) Node(...)
+inline void *operator new(size_t size, myComp::Arena &arena) {
+    return arena.allocate_node(size);
+}
+
+// Called only if the constructor throws, the memory is reclaimed by the arena
+inline void operator delete(void *, myComp::Arena &) noexcept {}
+
+#endif // MYCOMP_ARENA_H
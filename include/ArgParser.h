@@ -7,6 +7,8 @@
 #include <string>
 #include <vector>
 
+#include "Compiler.h"
+
 namespace myComp {
 class ArgParser {
   public:
@@ -14,9 +16,24 @@ class ArgParser {
 
     bool debug() const { return _debug; }
     bool const_propagation() const { return _const_propagation; }
-    const std::string &file_name() const { return _file_name; }
+    bool mem2reg() const { return _mem2reg; }
+    bool assembly() const { return _assembly; }
+    bool jit() const { return _jit; }
+    size_t jobs() const { return _jobs; }
+    bool time_report() const { return _time_report; }
+    size_t slowest_functions() const { return _slowest_functions; }
+    bool time_trace() const { return _time_trace; }
+    const std::string &peephole() const { return _peephole; }
+    const std::vector<std::string> &file_names() const { return _file_names; }
     const std::string &program_name() const { return _program_name; }
 
+    // Where the output of an input file goes, out.o or out.s for a single
+    // file, the name of each file with .o or .s for several
+    std::string output_name(const std::string &file_name) const;
+
+    // How to compile an input file, its dumps go to the default directory
+    CompileOptions options(const std::string &file_name) const;
+
   private:
     // Convert c-style string to std::string
     void _stringfy(int argc, char **argv);
@@ -24,7 +41,15 @@ class ArgParser {
     std::vector<std::string> _args;
     bool _debug = false;
     bool _const_propagation = false;
-    std::string _file_name;
+    bool _mem2reg = true;
+    bool _assembly = false;
+    bool _jit = false;
+    size_t _jobs = 1;
+    bool _time_report = false;
+    size_t _slowest_functions = 10;
+    bool _time_trace = false;
+    std::string _peephole = "all";
+    std::vector<std::string> _file_names;
     std::string _program_name;
 };
 } // namespace myComp
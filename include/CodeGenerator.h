@@ -1,31 +1,64 @@
 #ifndef MYCOMP_CODEGENERATOR_H
 #define MYCOMP_CODEGENERATOR_H
 
+#include <ostream>
 #include <vector>
 
 #include "Variable.h"
 
 namespace myComp {
+struct FunctionPrototype;
+
+// Relation tested by a comparison
+enum class Comparison : uint8_t {
+    EQUAL,
+    NOT_EQUAL,
+    LESS,
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+};
+
+// A memory operand: the address of a variable or a base register, plus an
+// index register times 1, 2, 4 or 8 and a displacement
+struct MemoryAddress {
+    Variable *variable = nullptr;
+    int base = -1;
+    int index = -1;
+    int scale = 1;
+    long long disp = 0;
+};
+
 class CodeGenerator {
   public:
     virtual ~CodeGenerator() = default;
 
-    // Set the output file
+    // Set the output file, an object file if its name ends with .o
     virtual void set_output(std::string_view filename) = 0;
 
+    // Keep the code in memory to run it in this process, instead of writing
+    // a file
+    virtual void set_jit() = 0;
+
+    // Run the main function compiled in memory, return its result
+    virtual int run_main() = 0;
+
+    // Select the peephole rules, a comma-separated list of names, "all" or
+    // "none"
+    virtual void set_peephole(std::string_view rules) = 0;
+
+    // Print what the optimizations did, under -D
+    virtual void print_statistics(std::ostream &os) const = 0;
+
     // Prelude and postlude of the code
     virtual void prelude() = 0;
     virtual void postlude() = 0;
 
-    // Manually release the register
-    virtual void free_register(int reg) = 0;
-    virtual void free_all_registers() = 0;
-
     // Generate function prelude
-    // Mark the start of a function(record the function name)
+    // Mark the start of a function(record the function prototype)
     // Initialize stack size = 0
     // Set the end label
-    virtual void function_prelude(std::string_view name) = 0;
+    virtual void function_prelude(FunctionPrototype *function) = 0;
 
     // Generate end label
     // Mark the end of a function
@@ -38,7 +71,7 @@ class CodeGenerator {
     // Record the variables and their offsets
     virtual void load_parameters(const std::vector<Variable *> &params) = 0;
 
-    // Allocate and record a string literal
+    // Allocate and record a string literal, `str` holds its bytes
     virtual void allocate_string_literal(std::string_view str,
                                          std::string_view label) = 0;
 
@@ -58,15 +91,28 @@ class CodeGenerator {
     // Add a label
     virtual void add_label(std::string_view label) = 0;
 
-    // Jump
-    virtual void jump_on_zero(int reg, std::string_view label) = 0;
-    virtual void jump_on_non_zero(int reg, std::string_view label) = 0;
+    // Jump, parameter `type` indicates the type of the tested value
+    virtual void jump_on_zero(int reg, Type *type, std::string_view label) = 0;
+    virtual void jump_on_non_zero(int reg, Type *type,
+                                  std::string_view label) = 0;
     virtual void jump(std::string_view label) = 0;
 
+    // Compare two registers, or a register and an immediate value, and jump
+    // if `relation` holds, parameter `type` indicates the type of the operands
+    virtual void jump_on_compare(int reg1, int reg2, Type *type,
+                                 Comparison relation,
+                                 std::string_view label) = 0;
+    virtual void jump_on_compare_immediate(int reg, long long val, Type *type,
+                                           Comparison relation,
+                                           std::string_view label) = 0;
+
     // Move value in register
     // Jump to the end label
     virtual void return_from_function(int reg) = 0;
 
+    // Jump to the end label without a value
+    virtual void return_from_function() = 0;
+
     // Type cast in place
     virtual void type_cast(int reg, Type *src, Type *dest) = 0;
 
@@ -97,26 +143,26 @@ class CodeGenerator {
 
     virtual int logical_not(int reg, Type *type) = 0;
 
-    // Multiply/divide a register by an immediate value in place
-    // Immediate value must be a power of 2
-    virtual void immediate_multiply(int reg, int val) = 0;
-    virtual void immediate_divide(int reg, int val) = 0;
+    // Multiply a register by an immediate value in place
+    virtual void immediate_multiply(int reg, long long val, Type *type) = 0;
 
-    // Add an immediate value to a register
-    virtual void immediate_add(int reg, int val) = 0;
+    // Add a register times 1, 2, 4 or 8 to another one
+    // Return the register number
+    virtual int add_scaled(int reg1, int reg2, int scale, Type *type) = 0;
 
-    virtual int post_increment(Variable *var) = 0;
-    virtual int post_decrement(Variable *var) = 0;
-    virtual int pre_increment(Variable *var) = 0;
-    virtual int pre_decrement(Variable *var) = 0;
+    // Divide a register by an immediate value, or take the remainder
+    // Immediate value must not be 0
+    // Return the register number
+    virtual int immediate_divide(int reg, long long val, Type *type) = 0;
+    virtual int immediate_modulo(int reg, long long val, Type *type) = 0;
 
     // Load an immediate value into a register
     // Return the register number
-    virtual int load_immediate(int val) = 0;
+    virtual int load_immediate(long long val) = 0;
 
     // Load address of string literal into a register
     // Return the register number
-    virtual int load_string_literal(std::string_view str) = 0;
+    virtual int load_string_literal(Symbol str) = 0;
 
     // Load a variable's value into a register
     // Return the register number
@@ -127,29 +173,36 @@ class CodeGenerator {
     virtual int load_variable_address(Variable *var) = 0;
 
     // Move an immediate value into a register
-    // The register will not be released
-    virtual void move_immediate(int reg, int val) = 0;
+    virtual void move_immediate(int reg, long long val) = 0;
 
     // Move a register's value into a variable
     virtual void move_register(int reg, Variable *var) = 0;
 
-    // Move a register's value into an address
-    virtual void move_register(int reg, int address_reg, Type *data_type) = 0;
+    // Move a register's value into memory
+    virtual void move_register(int reg, const MemoryAddress &address,
+                               Type *data_type) = 0;
 
-    // Load a value from an address in reg to another register
+    // Load a value from memory into a register
     // Return the register number
-    virtual int load_from_memory(int address_reg, Type *data_type) = 0;
+    virtual int load_from_memory(const MemoryAddress &address,
+                                 Type *data_type) = 0;
 
     // Duplicate a register's value
     // Return the register number
     virtual int duplicate_register(int reg) = 0;
 
-    // Move a register's value as nth argument
+    // Allocate a register that is only written by copy_register
+    virtual int allocate_register() = 0;
+
+    // Copy a register's value into another register
+    virtual void copy_register(int dest, int src) = 0;
+
+    // Record a register's value as nth argument of the next call
     virtual void move_to_argument(int reg, int n) = 0;
 
-    // Call a function
-    // Return the register number
-    virtual int call_function(std::string_view name) = 0;
+    // Pass the `num_args` last recorded arguments and call a function
+    // Return the register number, -1 if the function returns void
+    virtual int call_function(FunctionPrototype *function, int num_args) = 0;
 
   private:
 };
@@ -0,0 +1,47 @@
+#ifndef MYCOMP_COMPILER_H
+#define MYCOMP_COMPILER_H
+
+#include <cstddef>
+#include <filesystem>
+#include <ostream>
+#include <string>
+
+#include "TimeReport.h"
+
+namespace myComp {
+// How to compile a translation unit
+struct CompileOptions {
+    // Dump the tokens, trees and IR to `logs` and print statistics
+    bool debug = false;
+    std::filesystem::path logs = "logs";
+
+    bool const_propagation = false;
+    bool mem2reg = true;
+    std::string peephole = "all";
+
+    // Measure the scanning done while parsing, for the time report
+    bool timing = false;
+
+    // Run main in memory instead of writing `output`, an object file or
+    // assembly code by its extension
+    bool jit = false;
+    std::string output = "out.o";
+};
+
+// What came of a compilation
+struct CompileResult {
+    int exit_code = 0; // Of main, when run in memory
+    size_t tokens = 0; // T_EOF excluded
+    size_t nodes = 0;  // Of the AST
+};
+
+// Compile a file, "-" for the standard input, timing the phases in `report`
+// - The statistics of -D and the times of -jit go to `log`
+// - Throws on errors, the caller then ends the compilation with Init::end()
+//   and removes the output written so far
+CompileResult compile(const std::string &file_name,
+                      const CompileOptions &options, TimeReport &report,
+                      std::ostream &log);
+} // namespace myComp
+
+#endif // MYCOMP_COMPILER_H
@@ -0,0 +1,75 @@
+#ifndef MYCOMP_CONSTANTFOLDING_H
+#define MYCOMP_CONSTANTFOLDING_H
+
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ASTNode.h"
+
+namespace myComp {
+// AST-level constant folding and propagation, enabled by -const-propagation
+// - Integer operators whose operands are literals are replaced by a literal,
+//   computed with the C semantics of the operand types
+// - Reads of locals holding a known constant are replaced by a literal, values
+//   flow through straight-line code and are merged at branches
+// - If and while statements with a constant condition are pruned
+// Trees are rewritten in place, new nodes come from the arena
+class ConstantFolding {
+  public:
+    explicit ConstantFolding(Arena *arena) : arena_(arena) {}
+
+    // Run on a top-level tree
+    void run(ASTNode_ *node);
+
+    // Operator nodes replaced by a literal
+    size_t folded() const { return folded_; }
+    // Variable reads replaced by a literal
+    size_t propagated() const { return propagated_; }
+    // If and while statements removed or replaced by one of their blocks
+    size_t pruned() const { return pruned_; }
+
+  private:
+    // Known values of locals, normalized to the type of the variable
+    using Values = std::unordered_map<Variable *, long long>;
+
+    // Rewrite the statements of a block
+    void block(CodeBlockNode *node);
+
+    // Rewrite the statements of a block, appending them to `out`
+    void statements(CodeBlockNode *node, std::vector<StatementNode *> &out);
+
+    // Rewrite an expression, return the node that replaces it
+    ExpressionNode *expression(ExpressionNode *node);
+
+    // Fold an operator whose operands have been rewritten
+    std::optional<long long> evaluate(const ExpressionNode *node) const;
+
+    // Record an assignment of a possibly unknown value
+    void assign(Variable *var, std::optional<long long> value);
+
+    // Whether the value of a variable can be tracked
+    bool trackable(const Variable *var) const;
+
+    // Keep only the values known on both sides of a branch
+    void merge(const Values &other);
+
+    // Forget the variables assigned anywhere in a tree
+    void kill_assigned(const ASTNode_ *node);
+
+    LiteralNode *literal(Type *type, long long value);
+
+    Arena *arena_;
+
+    Values values_;
+
+    // Locals of the current function whose address is taken
+    std::unordered_set<const Variable *> address_taken_;
+
+    size_t folded_ = 0;
+    size_t propagated_ = 0;
+    size_t pruned_ = 0;
+};
+} // namespace myComp
+
+#endif // MYCOMP_CONSTANTFOLDING_H
@@ -8,28 +8,37 @@
 
 namespace myComp {
 struct ContextNode {
-    std::string name_;
+    Symbol name_;
     bool has_return_ = false;
 };
 
 class Context {
   public:
-    static std::string &get_name() { return get_stack().top().name_; }
-    static void push(const std::string &name) { get_stack().push({name}); }
+    static Symbol get_name() { return get_stack().top().name_; }
+    static void push(Symbol name) { get_stack().push({name}); }
     static void pop() { get_stack().pop(); }
     static bool has_return() { return get_stack().top().has_return_; }
     static void set_return_flag() { get_stack().top().has_return_ = true; }
 
+    // Leave every scope, at the end of a translation unit
+    static void clear() { get_stack() = {}; }
+
+    // Name of the global scope
+    static Symbol global() {
+        static const Symbol name("global");
+        return name;
+    }
+
   private:
     static std::stack<ContextNode> &get_stack() {
-        static std::stack<ContextNode> stack;
+        static thread_local std::stack<ContextNode> stack;
         return stack;
     }
 };
 
 struct FunctionPrototype {
     Type *return_type_ = nullptr;
-    std::string name_;
+    Symbol name_;
     std::vector<Variable *> parameters_;
     bool is_variadic_ = false;
 
@@ -38,20 +47,23 @@ struct FunctionPrototype {
 
 class FunctionManager {
   public:
-    static bool exists(const std::string &name);
+    static bool exists(Symbol name);
 
-    static void ensure_exists(const std::string &name);
+    static void ensure_exists(Symbol name);
 
-    static FunctionPrototype *find(const std::string &name);
+    static FunctionPrototype *find(Symbol name);
 
-    static void insert(Type *return_type, const std::string &name,
+    static void insert(Type *return_type, Symbol name,
                        std::vector<Variable *> parameters, bool is_variadic);
 
+    // Forget every function, at the end of a translation unit
+    static void clear() { getCache().clear(); }
+
   private:
-    static std::unordered_map<std::string, std::unique_ptr<FunctionPrototype>> &
+    static std::unordered_map<Symbol, std::unique_ptr<FunctionPrototype>> &
     getCache() {
-        static std::unordered_map<std::string,
-                                  std::unique_ptr<FunctionPrototype>>
+        static thread_local std::unordered_map<
+            Symbol, std::unique_ptr<FunctionPrototype>>
             cache;
         return cache;
     }
@@ -4,29 +4,31 @@
 #include <exception>
 #include <string_view>
 
+#include "SourceBuffer.h"
 #include "Token.h"
 
 namespace myComp {
 // Throw this exception when an unexpected token is found
 class UnexpectedTokenException : public std::exception {
   public:
-    UnexpectedTokenException(TokenType got, int line,
+    UnexpectedTokenException(TokenType got, SourceLocation location,
                              std::string_view expected) {
         msg_ = "Expected ";
         msg_ += expected;
         msg_ += " but got token ";
         msg_ += token_str.at(got);
-        msg_ += " on line ";
-        msg_ += std::to_string(line);
+        msg_ += " on ";
+        msg_ += location.str();
     }
 
-    UnexpectedTokenException(TokenType got, int line, TokenType expected) {
+    UnexpectedTokenException(TokenType got, SourceLocation location,
+                             TokenType expected) {
         msg_ = "Expected ";
         msg_ += token_str.at(expected);
         msg_ += " but got token ";
         msg_ += token_str.at(got);
-        msg_ += " on line ";
-        msg_ += std::to_string(line);
+        msg_ += " on ";
+        msg_ += location.str();
     }
 
     const char *what() const noexcept override { return msg_.c_str(); }
@@ -43,11 +45,11 @@ class InvalidException : public std::exception {
         msg_ += msg;
     }
 
-    InvalidException(std::string_view msg, int line) {
+    InvalidException(std::string_view msg, SourceLocation location) {
         msg_ = "Invalid ";
         msg_ += msg;
-        msg_ += " on line ";
-        msg_ += std::to_string(line);
+        msg_ += " on ";
+        msg_ += location.str();
     }
 
     const char *what() const noexcept override { return msg_.c_str(); }
@@ -92,11 +94,11 @@ class SyntaxException : public std::exception {
         msg_ += msg;
     }
 
-    SyntaxException(std::string_view msg, int line) {
+    SyntaxException(std::string_view msg, SourceLocation location) {
         msg_ = "Syntax error: ";
         msg_ += msg;
-        msg_ += " on line ";
-        msg_ += std::to_string(line);
+        msg_ += " on ";
+        msg_ += location.str();
     }
 
     const char *what() const noexcept override { return msg_.c_str(); }
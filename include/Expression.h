@@ -12,10 +12,13 @@ class Expression {
   private:
     TokenProcessor *token_processor_ = nullptr;
 
+    // Where the nodes are allocated
+    Arena *arena_ = nullptr;
+
     ExpressionNode *primary();
     ExpressionNode *prefix();
     ExpressionNode *identifier();
-    ExpressionNode *postfix(const std::string &identifier);
+    ExpressionNode *postfix(Symbol identifier);
     std::vector<ExpressionNode *> parse_arguments();
 
   public:
@@ -23,6 +26,8 @@ class Expression {
         token_processor_ = token_processor;
     }
 
+    void set_arena(Arena *arena) { arena_ = arena; }
+
     // Build the AST
     ExpressionNode *build_tree(int pre_precedence);
 
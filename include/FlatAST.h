@@ -0,0 +1,79 @@
+#ifndef MYCOMP_FLATAST_H
+#define MYCOMP_FLATAST_H
+
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "ASTNode.h"
+
+namespace myComp {
+// Compact AST stored in contiguous arrays
+// Nodes are addressed by 32-bit indices and tagged with their ASTNodeType, so
+// walks are a switch over the tag instead of virtual calls
+// Nodes are stored in pre-order, a parent always comes before its children
+class FlatAST {
+  public:
+    using Index = uint32_t;
+
+    // A missing child, e.g. an if without else
+    static constexpr Index NONE = UINT32_MAX;
+
+    struct Node {
+        ASTNodeType kind;
+        bool lvalue = false;
+
+        // Children are children_[first, first + count)
+        Index first = 0;
+        Index count = 0;
+
+        Type *type = nullptr;
+
+        // Meaning depends on the kind, `raw` zeroes all of it
+        union {
+            long long value;              // INT_LITERAL
+            uint32_t symbol;              // STRING_LITERAL, FUNCTION_CALL
+            Variable *variable;           // VARIABLE, VARIABLE_DECLARATION
+            FunctionPrototype *function;  // FUNCTION_DECLARATION
+            const char *op;               // operators
+            uint64_t raw = 0;
+        };
+    };
+
+    // Append a tree, return the index of its root
+    Index convert(const ASTNode_ *node);
+
+    const Node &node(Index index) const { return nodes_[index]; }
+
+    std::span<const Index> children(Index index) const {
+        const Node &n = nodes_[index];
+        return {children_.data() + n.first, n.count};
+    }
+
+    // Number of nodes
+    size_t size() const { return nodes_.size(); }
+
+    // Bytes used by the arrays
+    size_t bytes() const {
+        return nodes_.size() * sizeof(Node) + children_.size() * sizeof(Index);
+    }
+
+    // Print a tree in the same format as ASTNode_::print
+    void print(std::ostream &os, Index index, int indent) const;
+
+  private:
+    // Append a node without children
+    Index add(ASTNodeType kind, const ASTNode_ *node);
+
+    // Convert the children of nodes_[index] in order, nullptr becomes NONE
+    template <typename Range> void add_children(Index index, Range &&children);
+    void add_children(Index index,
+                      std::initializer_list<const ASTNode_ *> children);
+
+    std::vector<Node> nodes_;
+    std::vector<Index> children_;
+};
+} // namespace myComp
+
+#endif // MYCOMP_FLATAST_H
@@ -0,0 +1,144 @@
+#ifndef MYCOMP_IR_H
+#define MYCOMP_IR_H
+
+#include <deque>
+#include <ostream>
+#include <vector>
+
+#include "Context.h"
+#include "Symbol.h"
+#include "Type.h"
+#include "Variable.h"
+
+namespace myComp {
+// Mid-level IR between the AST and the code generator
+// - A function is a list of basic blocks, the first one is the entry
+// - Every instruction is a value in SSA form, typed with the Type hierarchy,
+//   instructions without a result have the void type
+// - Only the low type()->size() bytes of a value are meaningful, a CAST
+//   extends them
+// - Variables live in memory and are accessed with GET and SET, phi nodes
+//   merge the values computed on different paths
+enum class IROp : uint8_t {
+    CONST,  // value
+    STRING, // address of the string literal `symbol`
+    GET,    // value of `variable`
+    SET,    // store operand 0 in `variable`
+    ADDR,   // address of `variable`
+    LOAD,   // load from the address in operand 0
+    STORE,  // store operand 1 at the address in operand 0
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+    AND,
+    OR,
+    XOR,
+    SHL,
+    SHR, // arithmetic if the type is signed
+    NEG,
+    NOT,
+    CAST, // convert operand 0 to the type of the instruction
+    CMP,  // compare two operands of the same type with `cond`, give 0 or 1
+    CALL, // call `function` with the operands as arguments
+    PHI,  // operand i is the value coming from `targets[i]`
+    // Terminators, the last instruction of every block
+    JUMP,   // go to targets[0]
+    BRANCH, // go to targets[0] if operand 0 is not zero, else to targets[1]
+    RET,    // return operand 0 if any
+};
+
+// Conditions of CMP, signedness comes from the type of the operands
+enum class IRCond : uint8_t { EQ, NE, LT, LE, GT, GE };
+
+struct IRBlock;
+
+struct IRInst {
+    IROp op;
+    IRCond cond = IRCond::EQ;
+    Type *type = nullptr;
+    std::vector<IRInst *> operands;
+
+    // Successors of a terminator, incoming blocks of a phi
+    std::vector<IRBlock *> targets;
+
+    long long value = 0;
+    Symbol symbol;
+    Variable *variable = nullptr;
+    FunctionPrototype *function = nullptr;
+
+    // Block holding the instruction
+    IRBlock *block = nullptr;
+
+    // Number of the instruction in its function
+    int id = -1;
+
+    bool is_terminator() const { return op >= IROp::JUMP; }
+    bool has_value() const { return !type->is_void(); }
+};
+
+struct IRBlock {
+    // Phi nodes first, a terminator last
+    std::vector<IRInst *> insts;
+    std::vector<IRBlock *> predecessors;
+
+    // Number of the block in its function
+    int id = -1;
+
+    IRInst *terminator() const {
+        return insts.empty() || !insts.back()->is_terminator() ? nullptr
+                                                               : insts.back();
+    }
+    const std::vector<IRBlock *> &successors() const {
+        return terminator()->targets;
+    }
+};
+
+class IRFunction {
+  public:
+    explicit IRFunction(FunctionPrototype *prototype) : prototype_(prototype) {}
+    IRFunction(const IRFunction &) = delete;
+    IRFunction &operator=(const IRFunction &) = delete;
+
+    FunctionPrototype *prototype() const { return prototype_; }
+
+    // Locals of the function, parameters excluded
+    std::vector<Variable *> &locals() { return locals_; }
+    const std::vector<Variable *> &locals() const { return locals_; }
+
+    // Blocks in layout order
+    std::vector<IRBlock *> &blocks() { return blocks_; }
+    const std::vector<IRBlock *> &blocks() const { return blocks_; }
+
+    // Create a block, it is laid out once appended to blocks()
+    IRBlock *new_block();
+
+    // Create an instruction, it belongs to no block yet
+    IRInst *new_inst(IROp op, Type *type);
+
+    // Number of instructions created, an upper bound of the ids
+    size_t num_insts() const { return insts_.size(); }
+
+    // Remove the blocks the entry cannot reach, recompute the predecessors
+    // and renumber the blocks
+    void clean();
+
+    // Put a block on every edge from a block with several successors to a
+    // block with phi nodes, so that the copies of the phi nodes have a place
+    void split_critical_edges();
+
+    void print(std::ostream &os) const;
+
+  private:
+    FunctionPrototype *prototype_;
+    std::vector<Variable *> locals_;
+    std::vector<IRBlock *> blocks_;
+
+    // Storage, addresses are stable
+    std::deque<IRBlock> block_pool_;
+    std::deque<IRInst> insts_;
+};
+} // namespace myComp
+
+#endif // MYCOMP_IR_H
@@ -0,0 +1,59 @@
+#ifndef MYCOMP_IRBUILDER_H
+#define MYCOMP_IRBUILDER_H
+
+#include <initializer_list>
+#include <memory>
+
+#include "ASTNode.h"
+#include "IR.h"
+
+namespace myComp {
+// Lower the tree of a function definition to the IR
+// - Operands are converted to the type of the operation with explicit casts,
+//   pointer arithmetic is scaled by the size of the pointee
+// - && and || become control flow, a condition jumps straight to the blocks
+//   of its statement, a value is a phi node of 1 and 0
+// - Code after a return goes to a block no one reaches, clean() drops it
+class IRBuilder {
+  public:
+    std::unique_ptr<IRFunction> build(const FunctionDefinitionNode *node);
+
+  private:
+    void block(const CodeBlockNode *node);
+    void statement(const StatementNode *node);
+
+    // Return the value of an expression, nullptr for a call returning void
+    IRInst *expression(const ExpressionNode *node);
+
+    // End the current block with the test of a condition
+    void condition(const ExpressionNode *node, IRBlock *if_true,
+                   IRBlock *if_false);
+
+    IRInst *binary(const BinaryExpressionNode *node, IROp op);
+    IRInst *compare(const BinaryExpressionNode *node, IRCond cond);
+    IRInst *pointer_offset(const BinaryExpressionNode *node, IROp op);
+    IRInst *step(const UnaryExpressionNode *node, int direction, bool post);
+    IRInst *logical(const BinaryExpressionNode *node);
+    IRInst *call(const FunctionCallNode *node);
+
+    // Append an instruction to the current block
+    IRInst *emit(IROp op, Type *type, std::initializer_list<IRInst *> operands);
+
+    IRInst *constant(Type *type, long long value);
+
+    // Convert a value, nothing is emitted if the types are the same
+    IRInst *cast(IRInst *value, Type *type);
+
+    // End the current block with a jump or a branch
+    void jump(IRBlock *target);
+    void branch(IRInst *condition, IRBlock *if_true, IRBlock *if_false);
+
+    // Lay out a block and make it current
+    void start(IRBlock *block);
+
+    IRFunction *function_ = nullptr;
+    IRBlock *current_ = nullptr;
+};
+} // namespace myComp
+
+#endif // MYCOMP_IRBUILDER_H
@@ -0,0 +1,70 @@
+#ifndef MYCOMP_IRLOWERING_H
+#define MYCOMP_IRLOWERING_H
+
+#include <string>
+#include <vector>
+
+#include "CodeGenerator.h"
+#include "IR.h"
+
+namespace myComp {
+// Lower the IR of a function through the CodeGenerator interface
+// - Values get a register when they are defined, constants are loaded again
+//   at each use
+// - The operations of the code generator overwrite their first operand, it is
+//   duplicated unless this is the last use of a value of the same block
+// - A phi node has one register, written by copies at the end of each
+//   predecessor, through temporaries when the phi nodes read each other
+// - Blocks are laid out in order, jumps to the next block are left out
+// - A comparison only used by the branch ending its block is not computed,
+//   the branch compares and jumps on the relation or its inverse
+// - A multiplication by 2, 4 or 8 only used by the addition after it is the
+//   scale of an lea
+// - An address computed right before the load or store using it, a variable
+//   plus an index times a scale or a displacement, is its memory operand
+class IRLowering {
+  public:
+    explicit IRLowering(CodeGenerator *code_generator)
+        : code_generator_(code_generator) {}
+
+    void run(const IRFunction &function);
+
+  private:
+    void lower(const IRInst *inst, const IRBlock *next);
+
+    void branch(const IRInst *inst, const IRBlock *next);
+
+    // Jump to `target` if the condition of a branch is `sense`
+    void jump_if(const IRInst *condition, bool sense, const IRBlock *target);
+
+    // Register holding a value
+    int use(const IRInst *value);
+
+    // Register holding a value, that the operation may overwrite
+    int take(const IRInst *value);
+
+    // Memory operand of a load or store from the address it uses
+    MemoryAddress address(const IRInst *pointer);
+
+    // Write the phi nodes of `to` with the values coming from `from`
+    void copy_phis(const IRBlock *from, const IRBlock *to);
+
+    const std::string &label(const IRBlock *block);
+
+    CodeGenerator *code_generator_;
+
+    // By instruction id: register, uses left, whether it is used by a phi or
+    // another block
+    std::vector<int> registers_;
+    std::vector<int> uses_;
+    std::vector<bool> shared_;
+
+    // By instruction id, whether an instruction is done by its user
+    std::vector<bool> fused_;
+
+    // By block id, empty until the block is the target of a jump
+    std::vector<std::string> labels_;
+};
+} // namespace myComp
+
+#endif // MYCOMP_IRLOWERING_H
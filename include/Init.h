@@ -2,6 +2,10 @@
 #define MYCOMP_INIT_H
 
 namespace myComp {
+// Start and end the compilation of a translation unit on this thread
+// - The tables of what a translation unit declares are thread-local, so
+//   compilations on different threads never meet
+// - end() empties them for the next compilation on the same thread
 class Init {
   public:
     static void init();
@@ -0,0 +1,68 @@
+#ifndef MYCOMP_MEM2REG_H
+#define MYCOMP_MEM2REG_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "IR.h"
+
+namespace myComp {
+// Promote the scalar variables of a function to SSA values, disabled by
+// -no-mem2reg
+// - A local or parameter is promoted unless it is an array or its address is
+//   taken, its GET and SET are removed and phi nodes merge its values where
+//   paths join
+// - A parameter is read once from its slot on entry, a local read before any
+//   assignment is 0
+// - Promoted locals get no stack slot, their values live in registers unless
+//   the register allocator spills them
+// Phi nodes are placed by the value of each variable at the end of the
+// predecessors, then the ones that merge a single value are removed
+class Mem2Reg {
+  public:
+    void run(IRFunction &function);
+
+    // Variables promoted and scalar variables seen, over all the functions
+    size_t promoted() const { return promoted_; }
+    size_t candidates() const { return candidates_; }
+    // Phi nodes left after the trivial ones are removed
+    size_t phis() const { return phis_; }
+
+  private:
+    // Value of a promoted variable on entering and on leaving a block
+    IRInst *read_entry(IRBlock *block, int var);
+    IRInst *read_exit(IRBlock *block, int var);
+
+    // Value of a promoted variable on entering the function
+    IRInst *initial(int var);
+
+    // The value an instruction was replaced with
+    IRInst *find(IRInst *value) const;
+
+    IRFunction *function_ = nullptr;
+
+    // Promoted variables and their index
+    std::vector<Variable *> variables_;
+    std::unordered_map<Variable *, int> indices_;
+
+    // By block id and variable index, the value on entering the block, and
+    // the last value assigned in the block if any
+    std::vector<IRInst *> entry_;
+    std::vector<IRInst *> exit_;
+
+    // By variable index, the value on entering the function
+    std::vector<IRInst *> initial_;
+
+    // By instruction id, the value replacing a GET or a trivial phi node
+    std::vector<IRInst *> replacements_;
+
+    // Phi nodes created, by block id
+    std::vector<std::vector<IRInst *>> created_;
+
+    size_t promoted_ = 0;
+    size_t candidates_ = 0;
+    size_t phis_ = 0;
+};
+} // namespace myComp
+
+#endif // MYCOMP_MEM2REG_H
@@ -13,17 +13,20 @@ class Parser {
   private:
     TokenProcessor *token_processor_ = nullptr;
 
+    // Where the nodes are allocated
+    Arena *arena_ = nullptr;
+
     Expression expression_;
 
     // Global variables
     VariableDeclarationNode *variable_declaration(Type *data_type,
-                                                  std::string &name);
+                                                  Symbol name);
 
     // Local variables
     VariableDeclarationNode *variable_declaration();
 
     FunctionDefinitionNode *function_declaration(Type *return_type,
-                                                 const std::string &name);
+                                                 Symbol name);
 
     CodeBlockNode *code_block();
 
@@ -43,6 +46,11 @@ class Parser {
         this->expression_.set_processor(token_processor);
     }
 
+    void set_arena(Arena *arena) {
+        this->arena_ = arena;
+        this->expression_.set_arena(arena);
+    }
+
     // void set_expression(Expression *expression) { this->expression_ =
     // expression; }
 
@@ -0,0 +1,90 @@
+#ifndef MYCOMP_PEEPHOLE_H
+#define MYCOMP_PEEPHOLE_H
+
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "X86_Instruction.h"
+
+namespace myComp {
+// Local rewrites of the code of one function, once registers are allocated
+// - self-move: drop a move of a register into itself, a 32-bit one only when
+//   the upper half is already clear or the value is returned
+// - mov-chain: drop a move undoing the previous one, merge a move into a
+//   register with the next move or extension when nothing else reads it
+// - jump-next: drop a jump to a label that follows it
+// - jump-thread: retarget a jump to a label followed by a jump, replace a jump
+//   to the epilogue by the epilogue
+// - compare-zero: test a register against itself instead of comparing it
+//   with $0
+// - identity: drop an arithmetic operation with $0 whose flags are not read
+// The rules run until none applies
+class Peephole {
+  public:
+    enum Rule : unsigned {
+        SELF_MOVE,
+        MOV_CHAIN,
+        JUMP_NEXT,
+        JUMP_THREAD,
+        COMPARE_ZERO,
+        IDENTITY,
+        NUM_RULES,
+    };
+
+    // Enable the rules of a comma-separated list of names, "all" or "none"
+    void set_rules(std::string_view rules);
+
+    void run(std::vector<X86Instruction> &code);
+
+    // Rewrites of a rule over all the runs
+    size_t count(Rule rule) const { return counts_[rule]; }
+
+    // Print the number of rewrites of each rule on one line
+    void print(std::ostream &os) const;
+
+  private:
+    bool enabled(Rule rule) const { return rules_ >> rule & 1; }
+
+    // Try the rules on the instruction at `i`, return whether one applied
+    bool rewrite(size_t i);
+
+    bool self_move(size_t i);
+    bool mov_chain(size_t i);
+    bool jump_next(size_t i);
+    bool jump_thread(size_t i);
+    bool compare_zero(size_t i);
+    bool identity(size_t i);
+
+    // Index of the next or previous instruction not removed, code_->size() if
+    // there is none
+    size_t next(size_t i) const;
+    size_t previous(size_t i) const;
+
+    // Whether `reg` may be read after the instruction at `i`
+    bool live_after(size_t i, int reg) const;
+
+    // Whether the flags may be read after the instruction at `i`
+    bool flags_live_after(size_t i) const;
+
+    // Whether the instruction at `i` clears the upper half of `reg`
+    bool clears_upper(size_t i, int reg) const;
+
+    // Index of the first instruction after a label that is not a label
+    size_t destination(Symbol label) const;
+
+    void remove(size_t i, Rule rule);
+
+    unsigned rules_ = (1u << NUM_RULES) - 1;
+    size_t counts_[NUM_RULES] = {};
+
+    // State of a run
+    std::vector<X86Instruction> *code_ = nullptr;
+    std::vector<bool> removed_;
+    std::unordered_map<Symbol, size_t> labels_;
+};
+} // namespace myComp
+
+#endif // MYCOMP_PEEPHOLE_H
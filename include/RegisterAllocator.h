@@ -0,0 +1,79 @@
+#ifndef MYCOMP_REGISTERALLOCATOR_H
+#define MYCOMP_REGISTERALLOCATOR_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "X86_Instruction.h"
+
+namespace myComp {
+// Linear-scan register allocation over the code of one function
+// - Every virtual register gets one live interval, the hull of the positions
+//   where it is live, computed by liveness over the control flow graph
+// - Physical registers named by the code (arguments, %rax and %rdx of a
+//   division, %cl of a shift, registers clobbered by a call) are fixed ranges,
+//   an interval never gets a register whose fixed ranges it overlaps
+// - When no register is left, the interval ending last is spilled to a stack
+//   slot, its uses and definitions are rewritten to go through short-lived
+//   registers and the allocation starts over
+class RegisterAllocator {
+  public:
+    // Rewrite `code` with physical registers only
+    // Spill slots are 8 bytes below `frame_size` bytes of locals, which grows
+    void run(std::vector<X86Instruction> &code, int &frame_size);
+
+    // Physical registers assigned by the last run, one bit per register
+    uint32_t used() const { return used_; }
+
+    // Virtual registers spilled by the last run
+    size_t spilled() const { return spilled_; }
+
+  private:
+    struct Interval {
+        int reg;
+        int start;
+        int end;
+
+        // Physical register or interval the value is copied from or to
+        int hint = -1;
+        int hint_interval = -1;
+
+        // Registers that reload a spilled value cannot spill again
+        bool spillable = true;
+
+        // Assigned register, SPILLED or -1
+        int assigned = -1;
+    };
+
+    static constexpr int SPILLED = -2;
+
+    // Compute the intervals and the fixed ranges of `code`
+    void build(const std::vector<X86Instruction> &code);
+
+    // Assign registers, return whether something was spilled
+    bool scan();
+
+    // Whether a fixed range of `reg` overlaps [start, end]
+    bool conflicts(int reg, int start, int end) const;
+
+    // Route the spilled registers through stack slots
+    void spill(std::vector<X86Instruction> &code, int &frame_size);
+
+    // Index of a register in the liveness sets and intervals
+    int index(int reg) const;
+
+    std::vector<Interval> intervals_;
+
+    // Sorted, disjoint ranges where a physical register is busy
+    std::vector<std::pair<int, int>> fixed_[X86Reg::NUM_PHYSICAL];
+
+    // Virtual registers created to reload spilled values
+    std::vector<bool> reload_;
+
+    uint32_t used_ = 0;
+    size_t spilled_ = 0;
+};
+} // namespace myComp
+
+#endif // MYCOMP_REGISTERALLOCATOR_H
@@ -0,0 +1,58 @@
+#ifndef MYCOMP_SCANKERNEL_H
+#define MYCOMP_SCANKERNEL_H
+
+namespace myComp {
+// Bulk character classification used by the scanner
+// Each kernel has a scalar, an SSE2 and an AVX2 implementation, the best one
+// supported by the CPU is selected at runtime
+class ScanKernel {
+  public:
+    enum class Level { SCALAR, SSE2, AVX2 };
+
+    // Skip whitespace starting at `p`
+    // Return the first non-whitespace position or `end`
+    static const char *skip_whitespace(const char *p, const char *end) {
+        // Most runs are a single space, do not pay for the dispatch
+        if (p == end || !is_space(*p))
+            return p;
+        return get().skip_whitespace(p, end);
+    }
+
+    // Return the first position that cannot continue an identifier
+    static const char *identifier_end(const char *p, const char *end) {
+        return get().identifier_end(p, end);
+    }
+
+    // Return the first position that is not a decimal digit
+    static const char *digit_end(const char *p, const char *end) {
+        return get().digit_end(p, end);
+    }
+
+    // The best level supported by the CPU
+    static Level detect();
+
+    // Current level and its name
+    static Level level() { return get().level; }
+    static const char *name(Level level);
+
+    // Force a level, used by benchmarks
+    // Throw if the CPU does not support it
+    static void select(Level level);
+
+  private:
+    struct Kernels {
+        Level level;
+        const char *(*skip_whitespace)(const char *, const char *);
+        const char *(*identifier_end)(const char *, const char *);
+        const char *(*digit_end)(const char *, const char *);
+    };
+
+    static bool is_space(char c) {
+        return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+    }
+
+    static Kernels &get();
+};
+} // namespace myComp
+
+#endif // MYCOMP_SCANKERNEL_H
@@ -1,57 +1,98 @@
 #ifndef MYCOMP_SCANNER_H
 #define MYCOMP_SCANNER_H
 
-#include <fstream>
+#include <cstdint>
 #include <map>
+#include <string_view>
 
+#include "SourceBuffer.h"
 #include "Token.h"
 
 namespace myComp {
 class Scanner {
   private:
-    // The next type
-    Token *_token = nullptr;
-
-    // The input file
-    std::ifstream _input;
-
-    // The current line number
-    int _line = 1;
+    // Symbol id of the current identifier or string literal, value of the
+    // current integer literal
+    uint32_t _payload = 0;
+    long long _integer = 0;
+
+    // The input file, mapped into memory
+    SourceBuffer _source;
+
+    // Current position and end of the input
+    const char *_cur = nullptr;
+    const char *_end = nullptr;
+
+    // First character of the current token
+    const char *_token_start = nullptr;
+
+    // Decoded string literal, used when the literal has escape sequences
+    std::string _string_buffer;
+
+    // Read a character from the input, return EOF at the end
+    int get() {
+        return _cur < _end ? static_cast<unsigned char>(*_cur++)
+                           : std::char_traits<char>::eof();
+    }
+
+    // Peek a character from the input, return EOF at the end
+    int peek() const {
+        return _cur < _end ? static_cast<unsigned char>(*_cur)
+                           : std::char_traits<char>::eof();
+    }
+
+    // Consume the next character if it is `c`
+    bool accept(int c) {
+        if (peek() != c)
+            return false;
+        _cur++;
+        return true;
+    }
 
     // Get the next character from the input
-    // Ignore whitespace and increment line number
+    // Ignore whitespace and mark the start of the token
     int next_char();
 
+    // Location of the current token, used in error messages
+    SourceLocation location() const { return _source.location(get_offset()); }
+
+    // Scan a token, set _payload or _integer for the literals and identifiers
+    TokenType scan_token();
+
     // Scan an integer literal
-    int scan_int(int c);
+    long long scan_int(int c);
 
     // Scan a character literal
     int scan_char();
 
     // Scan a string literal
-    std::string scan_string();
+    // The result is a slice of the input or of _string_buffer
+    std::string_view scan_string();
 
-    // Scan an identifier
-    std::string scan_identifier(int c);
+    // Scan an identifier, the result is a slice of the input
+    std::string_view scan_identifier();
 
     // Scan an escape sequence
     int scan_escape_sequence();
 
   public:
-    // Set the input file
+    // Set the input file, "-" reads from the standard input
     void set_input(const std::string &filename);
 
-    // Scan the next token from the input
-    void next();
+    // Scan the next token from the input into the slots of its kind and
+    // payload, the symbol id of identifiers and string literals, 0 otherwise
+    void next(uint8_t &kind, uint32_t &payload);
 
-    // Get the current token
-    [[nodiscard]] Token *get_token() { return _token; }
+    // Value of the integer literal just scanned
+    [[nodiscard]] long long integer() const { return _integer; }
 
-    // Get line number
-    [[nodiscard]] int get_line() const { return _line; }
+    // Byte offset of the current token in the input
+    [[nodiscard]] uint32_t get_offset() const {
+        return static_cast<uint32_t>(_token_start - _source.begin());
+    }
 
-    // Destructor: close the input file
-    ~Scanner() { _input.close(); }
+    // The input being scanned
+    [[nodiscard]] const SourceBuffer &source() const { return _source; }
 };
 } // namespace myComp
 
@@ -0,0 +1,65 @@
+#ifndef MYCOMP_SOURCEBUFFER_H
+#define MYCOMP_SOURCEBUFFER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace myComp {
+// Line and column of a position in the source, both start from 1
+struct SourceLocation {
+    int line = 0;
+    int column = 0;
+
+    // "line L, column C"
+    std::string str() const;
+};
+
+// Read-only view of a whole translation unit
+// Regular files are memory-mapped, everything else (stdin, pipes) is read into
+// an owned buffer
+class SourceBuffer {
+  public:
+    SourceBuffer() = default;
+    SourceBuffer(const SourceBuffer &) = delete;
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    // Unmap the file if it was mapped
+    ~SourceBuffer() { close(); }
+
+    // Open a file, "-" stands for the standard input
+    void open(const std::string &filename);
+
+    // Release the mapping or the owned buffer
+    void close();
+
+    const char *begin() const { return data_; }
+    const char *end() const { return data_ + size_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return {data_, size_}; }
+
+    // Tell if the content is memory-mapped
+    bool is_mapped() const { return mapped_; }
+
+    // Resolve a byte offset into a line and a column
+    // The line-start table is built on the first call
+    SourceLocation location(uint32_t offset) const;
+
+  private:
+    // Read the whole file descriptor into the fallback buffer
+    void read_all(int fd, const std::string &filename);
+
+    const char *data_ = "";
+    size_t size_ = 0;
+    bool mapped_ = false;
+
+    // Storage used when the input cannot be mapped
+    std::string fallback_;
+
+    // Offset of the first byte of every line
+    mutable std::vector<uint32_t> line_starts_;
+};
+} // namespace myComp
+
+#endif // MYCOMP_SOURCEBUFFER_H
@@ -0,0 +1,105 @@
+#ifndef MYCOMP_SYMBOL_H
+#define MYCOMP_SYMBOL_H
+
+#include <compare>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace myComp {
+// Handle of an interned string
+// Symbols are compared and hashed by their 32-bit id, id 0 is the empty string
+class Symbol {
+  public:
+    constexpr Symbol() = default;
+
+    // Intern a string
+    explicit Symbol(std::string_view str);
+
+    uint32_t id() const { return id_; }
+    bool empty() const { return id_ == 0; }
+
+    // Rebuild a symbol from the id of an existing one
+    static constexpr Symbol from_id(uint32_t id) { return Symbol(id); }
+
+    // The interned text, valid until the end of the program
+    std::string_view view() const;
+    std::string str() const { return std::string(view()); }
+
+    friend bool operator==(Symbol, Symbol) = default;
+    friend auto operator<=>(Symbol, Symbol) = default;
+
+  private:
+    friend class Interner;
+    explicit constexpr Symbol(uint32_t id) : id_(id) {}
+
+    uint32_t id_ = 0;
+};
+
+inline std::ostream &operator<<(std::ostream &os, Symbol symbol) {
+    return os << symbol.view();
+}
+
+// Global string interner, shared by the threads of the compiler
+// - The text of every symbol lives in append-only blocks, so views are stable
+// - The views are kept in segments that never move, so that a symbol is read
+//   without a lock while other threads intern new ones
+class Interner {
+  public:
+    static Symbol intern(std::string_view str);
+
+    static std::string_view view(Symbol symbol) {
+        return get().segments_[symbol.id_ >> SEGMENT_BITS]
+                              [symbol.id_ & (SEGMENT_SIZE - 1)];
+    }
+
+    // Number of distinct symbols
+    static size_t size();
+
+  private:
+    Interner();
+
+    static Interner &get() {
+        static Interner interner;
+        return interner;
+    }
+
+    // Copy the text into the current block
+    std::string_view store(std::string_view str);
+
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+    static constexpr size_t SEGMENT_BITS = 14;
+    static constexpr size_t SEGMENT_SIZE = size_t(1) << SEGMENT_BITS;
+    static constexpr size_t MAX_SEGMENTS = 4096;
+
+    // Guards everything below, except the views already published
+    std::mutex mutex_;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_used_ = BLOCK_SIZE;
+
+    // Text of each symbol, indexed by id
+    std::unique_ptr<std::unique_ptr<std::string_view[]>[]> segments_;
+    uint32_t count_ = 0;
+
+    // Text to id, the keys point into the blocks
+    std::unordered_map<std::string_view, uint32_t> ids_;
+};
+
+inline Symbol::Symbol(std::string_view str) : id_(Interner::intern(str).id_) {}
+
+inline std::string_view Symbol::view() const { return Interner::view(*this); }
+} // namespace myComp
+
+template <> struct std::hash<myComp::Symbol> {
+    size_t operator()(myComp::Symbol symbol) const noexcept {
+        return symbol.id();
+    }
+};
+
+#endif // MYCOMP_SYMBOL_H
@@ -0,0 +1,46 @@
+#ifndef MYCOMP_THREADPOOL_H
+#define MYCOMP_THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace myComp {
+// A fixed set of threads running tasks in the order they were submitted
+// - A task must not throw, it reports its own failures
+// - The destructor waits for the tasks left, then joins the threads
+class ThreadPool {
+  public:
+    explicit ThreadPool(size_t threads);
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+
+    // Wait until every task submitted has run
+    void wait();
+
+  private:
+    // Run tasks until the pool is destroyed
+    void work();
+
+    std::vector<std::thread> threads_;
+    std::queue<std::function<void()>> tasks_;
+
+    std::mutex mutex_;
+    // Signaled when a task is submitted or the pool stops
+    std::condition_variable ready_;
+    // Signaled when the last task running finishes
+    std::condition_variable idle_;
+
+    // Tasks taken from the queue and not finished yet
+    size_t running_ = 0;
+    bool stopping_ = false;
+};
+} // namespace myComp
+
+#endif // MYCOMP_THREADPOOL_H
@@ -0,0 +1,113 @@
+#ifndef MYCOMP_TIMEREPORT_H
+#define MYCOMP_TIMEREPORT_H
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Symbol.h"
+
+namespace myComp {
+// Where the time and memory of a compilation go, for -ftime-report
+// - A phase is timed between start() and stop(), starting a phase again adds
+//   to its totals
+// - Memory is the allocations through operator new, which this module counts
+//   per thread once count_allocations() is called, and the growth of the peak
+//   resident set, which is only the phase's own when files are compiled one
+//   at a time, otherwise the peak of the whole process is shown
+// - Every interval and the code generation of every function is kept for the
+//   trace, in the Chrome trace event format
+// - Work interleaved with a phase, such as scanning on demand while parsing,
+//   is measured on its own and split out of the phase, its time stays in
+//   the intervals of the phase in the trace
+class TimeReport {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // Time and allocations of some work
+    struct Usage {
+        double milliseconds = 0;
+        size_t allocations = 0;
+        size_t bytes = 0;
+    };
+
+    TimeReport() : origin_(Clock::now()) {}
+
+    // Start timing a phase, stopping the current one
+    void start(std::string_view phase);
+
+    // Stop timing the current phase
+    void stop();
+
+    // Move the usage of work interleaved with a phase out of it into a phase
+    // of its own, listed before it, the growth of the resident set stays
+    void split(std::string_view from, std::string_view phase,
+               const Usage &usage);
+
+    // The totals of a phase, nothing if it never ran
+    Usage usage(std::string_view phase) const;
+
+    // Record the code generation of a function
+    void function(Symbol name, Clock::time_point start, Clock::time_point end);
+
+    // Add the phases and functions of the report of a file, its functions are
+    // prefixed with the file and its intervals shown on the given thread of
+    // the trace
+    void merge(const TimeReport &other, std::string_view file, int thread);
+
+    // Print the phases and the `slowest` slowest functions, `concurrent` if
+    // files were compiled at once
+    void print(std::ostream &os, size_t slowest, bool concurrent) const;
+
+    // Write the intervals as a Chrome trace
+    void write_trace(std::ostream &os) const;
+
+    // Count the allocations through operator new from now on, before any
+    // worker thread starts, every allocation pays for it
+    static void count_allocations();
+
+    // Allocations through operator new on the calling thread
+    static size_t allocations();
+    static size_t allocated_bytes();
+
+  private:
+    struct Phase {
+        std::string name;
+        double milliseconds = 0;
+        long peak_rss_kb = 0;
+        size_t allocations = 0;
+        size_t bytes = 0;
+    };
+
+    // A timed interval, in microseconds from the creation of the report
+    struct Event {
+        std::string name;
+        std::string category;
+        double start;
+        double duration;
+        int thread = 1;
+    };
+
+    double microseconds(Clock::time_point time) const;
+
+    Clock::time_point origin_;
+    std::vector<Phase> phases_;
+    std::vector<Event> events_;
+
+    // The phase being timed, -1 if none, and its state when it started
+    int current_ = -1;
+    Clock::time_point started_;
+    long start_rss_kb_ = 0;
+    size_t start_allocations_ = 0;
+    size_t start_bytes_ = 0;
+
+    // Code generation time of each function in milliseconds
+    std::vector<std::pair<std::string, double>> functions_;
+};
+} // namespace myComp
+
+#endif // MYCOMP_TIMEREPORT_H
@@ -2,8 +2,11 @@
 #define TOKEN_H
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
+#include "Symbol.h"
+
 namespace myComp {
 // Token types
 enum class TokenType {
@@ -66,8 +69,8 @@ extern const std::unordered_map<TokenType, std::string> token_str;
 // Token class
 class Token {
   public:
-    Token(TokenType type, long long int_val, std::string str_val)
-        : type_(type), int_val_(int_val), str_val_(std::move(str_val)) {}
+    Token(TokenType type, long long int_val, Symbol symbol)
+        : type_(type), int_val_(int_val), symbol_(symbol) {}
 
     TokenType type() const { return type_; }
 
@@ -75,36 +78,15 @@ class Token {
 
     long long integer_val() const { return int_val_; }
 
-    std::string string_val() const { return str_val_; }
+    // Interned text of identifiers and string literals
+    Symbol symbol() const { return symbol_; }
+
+    std::string_view string_val() const { return symbol_.view(); }
 
   private:
     TokenType type_;
     long long int_val_;
-    std::string str_val_;
-};
-
-// Token factory
-class TokenFactory {
-  public:
-    static Token *getToken(TokenType type) { return getOrCreate(type, 0, ""); }
-
-    static Token *getStringLiteral(const std::string &str) {
-        return getOrCreate(TokenType::STRING_LITERAL, 0, str);
-    }
-
-    static Token *getIntegerLiteral(long long val) {
-        return getOrCreate(TokenType::INT_LITERAL, val, "");
-    }
-
-    static Token *getIdentifier(const std::string &str) {
-        return getOrCreate(TokenType::IDENTIFIER, 0, str);
-    }
-
-  private:
-    static std::unordered_map<std::string, Token> &getCache();
-
-    static Token *getOrCreate(TokenType type, long long int_val,
-                              const std::string &str_val);
+    Symbol symbol_;
 };
 } // namespace myComp
 #endif // TOKEN_H
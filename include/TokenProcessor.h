@@ -1,7 +1,10 @@
 #ifndef TOKENPROCESSOR_H
 #define TOKENPROCESSOR_H
 
+#include <cstdint>
+
 #include "Scanner.h"
+#include "TimeReport.h"
 #include "Type.h"
 
 namespace myComp {
@@ -10,16 +13,29 @@ class TokenProcessor {
     void print(std::ostream &output);
     void set_input(const std::string &filename) { scanner.set_input(filename); }
     void process(); // Read all tokens from the input file
-    bool eof() { return current_token >= tokens.size(); }
-    std::pair<Token *, int> next_token(); // Get the next token
-    std::pair<Token *, int> peek_token(); // Peek the next token
-    int current_line() { return line_numbers[current_token]; }
+    void stream();  // Read tokens on demand while parsing
+    void measure() { measured = true; } // Measure the scanning on demand
+    // Time and allocations of the scanning on demand so far
+    const TimeReport::Usage &scan_usage() const { return usage; }
+    bool eof() { return peek_type() == TokenType::T_EOF; }
+    size_t size() const { return scanned; } // Tokens scanned, T_EOF included
+    Token next_token(); // Get the next token
+    Token peek_token(); // Peek the next token
+
+    // Location of the next token
+    SourceLocation current_location() {
+        fill();
+        return location(current_token);
+    }
 
     // Utils
-    TokenType peek_type() { return peek_token().first->type(); }
+    TokenType peek_type() {
+        fill();
+        return static_cast<TokenType>(kinds[current_token & mask]);
+    }
     Type *next_data_type();
-    std::string next_identifier();
-    std::string next_string();
+    Symbol next_identifier();
+    Symbol next_string();
     long long next_integer();
     void match(TokenType type);
     void semi() { this->match(TokenType::SEMI); }
@@ -33,10 +49,58 @@ class TokenProcessor {
     void ellipsis() { this->match(TokenType::ELLIPSIS); }
 
   private:
+    // Tokens buffered ahead of the parser in streaming mode
+    static constexpr size_t LOOKAHEAD = 64;
+
+    // Make sure the next token is buffered
+    void fill() {
+        if (current_token == scanned)
+            scan();
+    }
+
+    // Scan tokens until the buffer is full or the input ends
+    void scan();
+
+    // Scan a token into the next slot of the arrays
+    void push();
+
+    // Rebuild the token at an index
+    Token token_at(size_t index) const;
+
+    // Consume the next token, throw if it is not of the given type
+    size_t expect(TokenType type);
+
+    SourceLocation location(size_t index) const {
+        return scanner.source().location(offsets[index & mask]);
+    }
+
     Scanner scanner;
-    std::vector<Token *> tokens;
-    std::vector<int> line_numbers;
-    int current_token = 0;
+
+    // Tokens are stored as parallel arrays, the last one is always T_EOF
+    // The payload is the symbol id of identifiers and string literals and the
+    // index into `integers` of integer literals
+    // In streaming mode the arrays are a ring of LOOKAHEAD slots, and the
+    // value of an integer literal lives in the slot of its token
+    std::vector<uint8_t> kinds;
+    std::vector<uint32_t> payloads;
+    std::vector<uint32_t> offsets;
+
+    // Values of the integer literals
+    std::vector<long long> integers;
+
+    // Token index to array index, all ones in eager mode
+    size_t mask = SIZE_MAX;
+
+    // Index of the next token and number of tokens scanned so far
+    size_t current_token = 0;
+    size_t scanned = 0;
+
+    // Whether T_EOF has been scanned
+    bool done = false;
+
+    // Whether scan() measures itself into `usage`
+    bool measured = false;
+    TimeReport::Usage usage;
 };
 } // namespace myComp
 
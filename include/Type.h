@@ -7,6 +7,8 @@
 #include <unordered_map>
 #include <stdexcept>
 
+#include "Symbol.h"
+
 namespace myComp {
 // Base class for all types
 class Type {
@@ -389,89 +391,59 @@ class UnionType : public DerivedType {
 };
 
 // Factory to create types
+// Types are keyed by their kind and their components (size, element or
+// pointee type, interned name), so lookups never build type names
+// Each thread has its own types, compilations running at once share none
 class TypeFactory {
   public:
-    static VoidType *get_void() { return getOrCreate<VoidType>("void"); }
-    static CharType *get_char() { return getOrCreate<CharType>("char"); }
+    static VoidType *get_void() {
+        return getOrCreate<VoidType>({Kind::VOID});
+    }
+    static CharType *get_char() {
+        return getOrCreate<CharType>({Kind::CHAR});
+    }
     static SignedIntegerType *get_signed(size_t size) {
-        std::string type_name;
-        switch (size) {
-        case 1:
-            type_name = "signed char";
-            break;
-        case 2:
-            type_name = "short";
-            break;
-        case 4:
-            type_name = "int";
-            break;
-        case 8:
-            type_name = "long";
-            break;
-        default:
-            throw std::runtime_error("Invalid integer size");
-        }
-        return getOrCreate<SignedIntegerType>(type_name, size);
+        check_integer_size(size);
+        return getOrCreate<SignedIntegerType>({Kind::SIGNED, nullptr, size},
+                                              size);
     }
     static UnsignedIntegerType *get_unsigned(size_t size) {
-        std::string type_name;
-        switch (size) {
-        case 1:
-            type_name = "unsigned char";
-            break;
-        case 2:
-            type_name = "unsigned short";
-            break;
-        case 4:
-            type_name = "unsigned int";
-            break;
-        case 8:
-            type_name = "unsigned long";
-            break;
-        default:
-            throw std::runtime_error("Invalid integer size");
-        }
-        return getOrCreate<UnsignedIntegerType>(type_name, size);
+        check_integer_size(size);
+        return getOrCreate<UnsignedIntegerType>(
+            {Kind::UNSIGNED, nullptr, size}, size);
     }
     static FloatType *get_float(size_t size) {
-        std::string type_name;
-        switch (size) {
-        case 4:
-            type_name = "float";
-            break;
-        case 8:
-            type_name = "double";
-            break;
-        default:
+        if (size != 4 && size != 8)
             throw std::runtime_error("Invalid floating point size");
-        }
-        return getOrCreate<FloatType>(type_name, size);
+        return getOrCreate<FloatType>({Kind::FLOAT, nullptr, size}, size);
     }
     static ArrayType *get_array(Type *element_type, size_t size) {
-        return getOrCreate<ArrayType>(element_type->str() + "[" +
-                                          std::to_string(size) + "]",
+        return getOrCreate<ArrayType>({Kind::ARRAY, element_type, size},
                                       element_type, size);
     }
 
     static StructType *
     get_struct(const std::string &name,
                const std::vector<std::pair<Type *, std::string>> &fields) {
-        return getOrCreate<StructType>("struct " + name, name, fields);
+        return getOrCreate<StructType>(
+            {Kind::STRUCT, nullptr, Symbol(name).id()}, name, fields);
     }
 
     static UnionType *
     get_union(const std::string &name,
               const std::vector<std::pair<Type *, std::string>> &fields) {
-        return getOrCreate<UnionType>("union " + name, name, fields);
+        return getOrCreate<UnionType>(
+            {Kind::UNION, nullptr, Symbol(name).id()}, name, fields);
     }
 
     static EnumType *get_enum(const std::string &name,
                               const std::vector<std::string> &fields) {
-        return getOrCreate<EnumType>("enum " + name, name, fields);
+        return getOrCreate<EnumType>({Kind::ENUM, nullptr, Symbol(name).id()},
+                                     name, fields);
     }
 
     static PointerType *get_pointer(Type *pointee) {
-        return getOrCreate<PointerType>(pointee->str() + " *", pointee);
+        return getOrCreate<PointerType>({Kind::POINTER, pointee}, pointee);
     }
 
     static PointerType *array_to_pointer(Type *array) {
@@ -480,17 +452,56 @@ class TypeFactory {
     }
 
   private:
-    static std::unordered_map<std::string, std::unique_ptr<Type>> &getCache() {
-        static std::unordered_map<std::string, std::unique_ptr<Type>> typeCache;
+    enum class Kind {
+        VOID,
+        CHAR,
+        SIGNED,
+        UNSIGNED,
+        FLOAT,
+        ARRAY,
+        POINTER,
+        STRUCT,
+        UNION,
+        ENUM,
+    };
+
+    struct Key {
+        Kind kind;
+        // Element type of arrays, pointee of pointers
+        const Type *base = nullptr;
+        // Size of integers and arrays, symbol id of named types
+        size_t extra = 0;
+
+        bool operator==(const Key &) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const noexcept {
+            size_t h = std::hash<const Type *>()(key.base);
+            h = h * 31 + key.extra;
+            return h * 31 + static_cast<size_t>(key.kind);
+        }
+    };
+
+    static void check_integer_size(size_t size) {
+        if (size != 1 && size != 2 && size != 4 && size != 8)
+            throw std::runtime_error("Invalid integer size");
+    }
+
+    static std::unordered_map<Key, std::unique_ptr<Type>, KeyHash> &getCache() {
+        static thread_local std::unordered_map<Key, std::unique_ptr<Type>,
+                                               KeyHash>
+            typeCache;
         return typeCache;
     }
 
     template <typename T, typename... Args>
-    static T *getOrCreate(const std::string &typeName, Args &&...args) {
-        if (const auto it = getCache().find(typeName); it != getCache().end())
+    static T *getOrCreate(const Key &key, Args &&...args) {
+        auto &cache = getCache();
+        if (const auto it = cache.find(key); it != cache.end())
             return static_cast<T *>(it->second.get());
         T *ptr = new T(std::forward<Args>(args)...);
-        getCache()[typeName] = std::unique_ptr<Type>(ptr);
+        cache[key] = std::unique_ptr<Type>(ptr);
         return ptr;
     }
 };
@@ -505,6 +516,9 @@ Type *integer_promotion(Type *type);
 Type *usual_arithmetic_conversion(Type *a, Type *b);
 
 Type *int_literal_type(long long val);
+
+// Reduce a value modulo 2^bits of the type, sign-extend signed types
+long long normalize(long long value, const Type *type);
 } // namespace myComp
 
 #endif // TYPE_H
@@ -1,32 +1,44 @@
 #ifndef MYCOMP_VARIABLE_H
 #define MYCOMP_VARIABLE_H
 
+#include "Symbol.h"
 #include "Type.h"
 
 namespace myComp {
 struct Variable {
     Type *type = nullptr;
-    std::string name;
-    std::string scope;
+    Symbol name;
+    Symbol scope;
 
-    std::string str() const { return type->str() + " " + name; }
-    std::string id() const { return scope + "_" + name; }
+    std::string str() const { return type->str() + " " + name.str(); }
+    std::string id() const { return scope.str() + "_" + name.str(); }
 };
 
 class VariableManager {
   public:
-    static Variable *find(const std::string &name);
+    static Variable *find(Symbol name);
 
-    static void insert(Type *type, const std::string &name,
-                       const std::string &scope);
+    static void insert(Type *type, Symbol name, Symbol scope);
 
-    static std::vector<Variable *>
-    get_variables_in_scope(const std::string &scope);
+    // Variables of a scope, in declaration order
+    static std::vector<Variable *> get_variables_in_scope(Symbol scope);
+
+    // Forget every variable, at the end of a translation unit
+    static void clear();
 
   private:
-    static std::unordered_map<std::string, std::unique_ptr<Variable>> &
-    getCache() {
-        static std::unordered_map<std::string, std::unique_ptr<Variable>> cache;
+    // Variables keyed by the ids of their scope and name
+    struct Cache {
+        std::vector<std::unique_ptr<Variable>> variables;
+        std::unordered_map<uint64_t, Variable *> index;
+    };
+
+    static uint64_t key(Symbol scope, Symbol name) {
+        return static_cast<uint64_t>(scope.id()) << 32 | name.id();
+    }
+
+    static Cache &getCache() {
+        static thread_local Cache cache;
         return cache;
     }
 };
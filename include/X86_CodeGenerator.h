@@ -1,24 +1,38 @@
 #ifndef MYCOMP_X86_CODEGENERATOR_H
 #define MYCOMP_X86_CODEGENERATOR_H
 
-#include <array>
-#include <fstream>
+#include <memory>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "CodeGenerator.h"
+#include "Peephole.h"
+#include "RegisterAllocator.h"
+#include "X86_Instruction.h"
+#include "X86_Output.h"
 
 namespace myComp {
 class X86_CodeGenerator final : public CodeGenerator {
   public:
     // Set the output file
     void set_output(std::string_view filename) override;
+    void set_jit() override;
+    int run_main() override;
+
+    void set_peephole(std::string_view rules) override {
+        peephole_.set_rules(rules);
+    }
+    void print_statistics(std::ostream &os) const override {
+        peephole_.print(os);
+        os << "Frames: " << frames_omitted_ << " of " << functions_
+           << " functions without a frame" << std::endl;
+    }
 
     // Override the virtual functions
     void prelude() override;
     void postlude() override;
-    void free_register(int reg) override;
-    void free_all_registers() override;
-    void function_prelude(std::string_view name) override;
+    void function_prelude(FunctionPrototype *function) override;
     void function_postlude() override;
     void load_parameters(const std::vector<Variable *> &params) override;
     void allocate_string_literal(std::string_view str,
@@ -28,10 +42,17 @@ class X86_CodeGenerator final : public CodeGenerator {
     allocate_local_variables(const std::vector<Variable *> &variables) override;
     std::string allocate_label() override;
     void add_label(std::string_view label) override;
-    void jump_on_zero(int reg, std::string_view label) override;
-    void jump_on_non_zero(int reg, std::string_view label) override;
+    void jump_on_zero(int reg, Type *type, std::string_view label) override;
+    void jump_on_non_zero(int reg, Type *type,
+                          std::string_view label) override;
     void jump(std::string_view label) override;
+    void jump_on_compare(int reg1, int reg2, Type *type, Comparison relation,
+                         std::string_view label) override;
+    void jump_on_compare_immediate(int reg, long long val, Type *type,
+                                   Comparison relation,
+                                   std::string_view label) override;
     void return_from_function(int reg) override;
+    void return_from_function() override;
     void type_cast(int reg, Type *src, Type *dest) override;
     int negate(int reg, Type *type) override;
     int add(int reg1, int reg2, Type *type) override;
@@ -52,55 +73,64 @@ class X86_CodeGenerator final : public CodeGenerator {
     int compare_greater(int reg1, int reg2, Type *type) override;
     int compare_greater_equal(int reg1, int reg2, Type *type) override;
     int logical_not(int reg, Type *type) override;
-    void immediate_multiply(int reg, int val) override;
-    void immediate_divide(int reg, int val) override;
-    void immediate_add(int reg, int val) override;
-    int post_increment(Variable *var) override;
-    int post_decrement(Variable *var) override;
-    int pre_increment(Variable *var) override;
-    int pre_decrement(Variable *var) override;
-    int load_immediate(int val) override;
-    int load_string_literal(std::string_view str) override;
+    void immediate_multiply(int reg, long long val, Type *type) override;
+    int add_scaled(int reg1, int reg2, int scale, Type *type) override;
+    int immediate_divide(int reg, long long val, Type *type) override;
+    int immediate_modulo(int reg, long long val, Type *type) override;
+    int load_immediate(long long val) override;
+    int load_string_literal(Symbol str) override;
     int load_variable(Variable *var) override;
     int load_variable_address(Variable *var) override;
-    void move_immediate(int reg, int val) override;
+    void move_immediate(int reg, long long val) override;
     void move_register(int reg, Variable *var) override;
-    void move_register(int reg, int address_reg, Type *data_type) override;
-    int load_from_memory(int address_reg, Type *data_type) override;
+    void move_register(int reg, const MemoryAddress &address,
+                       Type *data_type) override;
+    int load_from_memory(const MemoryAddress &address,
+                         Type *data_type) override;
     int duplicate_register(int reg) override;
+    int allocate_register() override;
+    void copy_register(int dest, int src) override;
     void move_to_argument(int reg, int n) override;
-    int call_function(std::string_view name) override;
+    int call_function(FunctionPrototype *function, int num_args) override;
 
   private:
-    static constexpr int NUM_REGISTERS = 10;
-    static constexpr int RDX_INDEX = 7;
-    static constexpr int RCX_INDEX = 6;
-    static constexpr std::array<const char *, NUM_REGISTERS> registers{
-        "%r10", "%r11", "%r12", "%r13", "%r9",
-        "%r8",  "%rcx", "%rdx", "%rsi", "%rdi"};
-    static constexpr std::array<const char *, NUM_REGISTERS> b_registers{
-        "%r10b", "%r11b", "%r12b", "%r13b", "%r9b",
-        "%r8b",  "%cl",   "%dl",   "%sil",  "%dil"};
-    static constexpr std::array<const char *, NUM_REGISTERS> d_registers{
-        "%r10d", "%r11d", "%r12d", "%r13d", "%r9d",
-        "%r8d",  "%ecx",  "%edx",  "%esi",  "%edi"};
-
-    // Output file
-    std::ofstream output_file_;
-
-    // Register allocation
-    std::array<bool, NUM_REGISTERS> free_registers_{
-        true, true, true, true, true, true, true, true, true, true};
+    // Assembly file, object file or code in memory
+    std::unique_ptr<X86_Output> output_;
+
+    // Prototype of main, once its code is written
+    FunctionPrototype *main_ = nullptr;
+
+    // Code of the current function, over virtual registers until the end of
+    // the function
+    std::vector<X86Instruction> code_;
+
+    // Next virtual register
+    int next_register_ = X86Reg::FIRST_VIRTUAL;
+
+    // Registers recorded by move_to_argument and their argument number, the
+    // arguments of nested calls are above those of the enclosing call
+    std::vector<std::pair<int, int>> arguments_;
+
+    RegisterAllocator allocator_;
+
+    Peephole peephole_;
 
     // Tell if we are in a function
     bool in_function_ = false;
 
-    // Function name of current function
-    std::string function_name_;
+    // Prototype of current function
+    FunctionPrototype *function_ = nullptr;
 
     // Stack size of current function
     int stack_size_ = 0;
 
+    // Bytes below %rsp a leaf function may use without moving %rsp
+    static constexpr int RED_ZONE = 128;
+
+    // Functions written, and those of them without a frame
+    int functions_ = 0;
+    int frames_omitted_ = 0;
+
     // End label of current function
     std::string end_label_;
 
@@ -110,20 +140,53 @@ class X86_CodeGenerator final : public CodeGenerator {
     // Label counter for generating unique labels
     int label_count_ = 0;
 
-    // Get reg by size
-    std::string get_reg_by_size(int reg, int size);
+    // Append an instruction to the current function
+    void emit(X86Op op, int size, X86Operand src = {}, X86Operand dst = {});
+
+    // Append a setcc or a jcc
+    void emit_condition(X86Op op, X86Cond cond, X86Operand operand);
 
-    // Allocate a register
-    int allocate_register();
+    // Operand of a virtual or physical register
+    static X86Operand register_operand(int reg, int size) {
+        return X86Operand::make_reg(reg, size);
+    }
 
-    // Get suffix by size
-    char get_suffix_by_size(int size);
+    // Size of an arithmetic operation on `type`
+    static int operation_size(Type *type) { return type->size() <= 4 ? 4 : 8; }
+
+    // Base of the two-operand instructions, the result is in `reg1`
+    int binary(X86Op op, int reg1, int reg2, Type *type);
+
+    // Base of the division, the result is in %rax or %rdx
+    int divide_base(int reg1, int reg2, Type *type, int result);
+
+    // Quotient of a register by an immediate value other than 0, in a new
+    // register unless the value is 1
+    int immediate_quotient(int reg, long long val, Type *type);
+
+    // Apply an operation with an immediate value, through a register if the
+    // value does not fit in 32 bits
+    void emit_immediate(X86Op op, int size, long long val, int reg);
+
+    // Multiply a register by a positive value with lea, shifts and an
+    // addition, return whether the value has such a sequence
+    bool multiply_sequence(int reg, uint64_t val, int size);
+
+    // Base of the shifts, the count goes through %cl
+    int shift_base(X86Op op, int reg1, int reg2, Type *type);
 
     // Base of the comparison
-    int compare_base(int reg1, int reg2, Type *type, std::string_view inst);
+    int compare_base(int reg1, int reg2, Type *type, Comparison relation);
 
     // Get the location of a variable
-    std::string variable_location(Variable *var);
+    X86Operand variable_location(Variable *var, int size);
+
+    // Get the operand of a memory address, the address of a global variable
+    // goes through a register when there is an index
+    X86Operand memory_operand(const MemoryAddress &address, int size);
+
+    // Allocate registers and write the current function
+    void write_function();
 };
 } // namespace myComp
 
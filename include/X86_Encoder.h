@@ -0,0 +1,52 @@
+#ifndef MYCOMP_X86_ENCODER_H
+#define MYCOMP_X86_ENCODER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Symbol.h"
+#include "X86_Instruction.h"
+
+namespace myComp {
+// A 32-bit field of the machine code that the linker fills in
+struct X86_Relocation {
+    // Offset of the field in the code
+    uint64_t offset;
+
+    // Symbol whose address goes in the field
+    Symbol symbol;
+
+    // ELF relocation type
+    uint32_t type;
+
+    int64_t addend;
+};
+
+// Machine code of x86-64 instructions
+// - Jumps to labels are resolved in the function, a jump takes the short
+//   form when its target is close enough, which is found by growing the
+//   jumps that do not fit until none does
+// - Calls and RIP-relative operands leave relocations against their symbol
+class X86_Encoder {
+  public:
+    // Append the code of a function, whose registers are all physical, to
+    // `text` and its relocations to `relocations`
+    void encode(const std::vector<X86Instruction> &code,
+                std::vector<uint8_t> &text,
+                std::vector<X86_Relocation> &relocations);
+
+  private:
+    // Encoding of an instruction that is not a jump, its relocations are
+    // relative to its first byte
+    struct Piece {
+        std::vector<uint8_t> bytes;
+        std::vector<X86_Relocation> relocations;
+    };
+
+    std::vector<Piece> pieces_;
+    std::vector<uint64_t> offsets_;
+    std::vector<bool> short_;
+};
+} // namespace myComp
+
+#endif // MYCOMP_X86_ENCODER_H
@@ -0,0 +1,237 @@
+#ifndef MYCOMP_X86_INSTRUCTION_H
+#define MYCOMP_X86_INSTRUCTION_H
+
+#include <cstdint>
+#include <ostream>
+
+#include "Symbol.h"
+
+namespace myComp {
+// Physical registers, numbered as in the instruction encoding
+namespace X86Reg {
+enum : int {
+    RAX,
+    RCX,
+    RDX,
+    RBX,
+    RSP,
+    RBP,
+    RSI,
+    RDI,
+    R8,
+    R9,
+    R10,
+    R11,
+    R12,
+    R13,
+    R14,
+    R15,
+    NUM_PHYSICAL,
+};
+
+// Base of a RIP-relative memory operand
+constexpr int RIP = -2;
+
+// Registers from this number on are virtual
+constexpr int FIRST_VIRTUAL = 32;
+
+constexpr bool is_virtual(int reg) { return reg >= FIRST_VIRTUAL; }
+constexpr bool is_physical(int reg) { return reg >= 0 && reg < NUM_PHYSICAL; }
+
+// Registers a call may overwrite
+constexpr uint32_t CALLER_SAVED = 1u << RAX | 1u << RCX | 1u << RDX |
+                                  1u << RSI | 1u << RDI | 1u << R8 | 1u << R9 |
+                                  1u << R10 | 1u << R11;
+
+// Registers a function must preserve, %rbp is handled by the frame
+constexpr uint32_t CALLEE_SAVED =
+    1u << RBX | 1u << R12 | 1u << R13 | 1u << R14 | 1u << R15;
+
+// Registers of the first six integer arguments
+constexpr int ARGUMENTS[] = {RDI, RSI, RDX, RCX, R8, R9};
+} // namespace X86Reg
+
+// Condition codes of setcc and jcc
+enum class X86Cond : uint8_t { E, NE, L, LE, G, GE, B, BE, A, AE };
+
+enum class X86Op : uint8_t {
+    LABEL, // src is the label
+    MOV,
+    MOVZX, // sizes come from the operands
+    MOVSX,
+    LEA,
+    ADD,
+    SUB,
+    IMUL, // dst *= src, or %rdx:%rax = %rax * src without dst
+    AND,
+    OR,
+    XOR,
+    SAL,
+    SAR,
+    SHR,
+    NEG,
+    NOT,
+    INC,
+    DEC,
+    CMP,
+    TEST,
+    SETCC,
+    JMP,
+    JCC,
+    PUSH,
+    POP,  // only in the prologue and epilogue
+    CALL, // src is the function, dst.value the number of register arguments
+    CQTO, // cltd or cqto: sign-extend %rax into %rdx
+    IDIV,
+    DIV,
+    MUL, // %rdx:%rax = %rax * src, unsigned
+    RET, // function epilogue, a plain ret once the function is written
+};
+
+struct X86Operand {
+    enum class Kind : uint8_t { NONE, REG, IMM, MEM, SYMBOL };
+
+    Kind kind = Kind::NONE;
+
+    // Size in bytes of a register or memory operand
+    uint8_t size = 0;
+
+    // REG: the register, MEM: the base register or X86Reg::RIP
+    int reg = -1;
+
+    // IMM: the value, MEM: the displacement
+    long long value = 0;
+
+    // SYMBOL: a label or function, MEM: the symbol a RIP base refers to
+    Symbol symbol{};
+
+    // MEM: a register added to the base times 1, 2, 4 or 8, -1 if none
+    int index = -1;
+    uint8_t scale = 1;
+
+    bool is_reg() const { return kind == Kind::REG; }
+    bool is_mem() const { return kind == Kind::MEM; }
+    bool is_imm() const { return kind == Kind::IMM; }
+
+    static X86Operand make_reg(int reg, int size) {
+        return {Kind::REG, static_cast<uint8_t>(size), reg};
+    }
+    static X86Operand make_imm(long long value) {
+        return {Kind::IMM, 0, -1, value};
+    }
+    static X86Operand make_mem(int base, long long disp, int size) {
+        return {Kind::MEM, static_cast<uint8_t>(size), base, disp};
+    }
+    static X86Operand make_indexed(int base, int index, int scale,
+                                   long long disp, int size) {
+        return {Kind::MEM, static_cast<uint8_t>(size), base, disp, {}, index,
+                static_cast<uint8_t>(scale)};
+    }
+    static X86Operand make_rip(Symbol symbol, int size) {
+        return {Kind::MEM, static_cast<uint8_t>(size), X86Reg::RIP, 0, symbol};
+    }
+    static X86Operand make_symbol(Symbol symbol) {
+        return {Kind::SYMBOL, 0, -1, 0, symbol};
+    }
+};
+
+// One instruction in AT&T operand order
+struct X86Instruction {
+    X86Op op;
+
+    // Operation size in bytes, gives the mnemonic suffix
+    uint8_t size = 8;
+
+    X86Cond cond = X86Cond::E;
+
+    X86Operand src{};
+    X86Operand dst{};
+};
+
+// Whether liveness follows a register, %rsp and %rbp belong to the frame
+constexpr bool tracked(int reg) {
+    return X86Reg::is_virtual(reg) ||
+           (X86Reg::is_physical(reg) && reg != X86Reg::RSP &&
+            reg != X86Reg::RBP);
+}
+
+// Call `use` on every register an instruction reads and `def` on every
+// register it writes
+template <typename Use, typename Def>
+void for_each_access(const X86Instruction &inst, Use &&use, Def &&def) {
+    auto read = [&](const X86Operand &operand) {
+        if ((operand.is_reg() || operand.is_mem()) && tracked(operand.reg))
+            use(operand.reg);
+        if (operand.is_mem() && operand.index != -1)
+            use(operand.index);
+    };
+
+    read(inst.src);
+    if (inst.dst.is_mem())
+        read(inst.dst);
+
+    switch (inst.op) {
+    case X86Op::CALL:
+        for (int i = 0; i < inst.dst.value; i++)
+            use(X86Reg::ARGUMENTS[i]);
+        for (int reg = 0; reg < X86Reg::NUM_PHYSICAL; reg++) {
+            if (X86Reg::CALLER_SAVED >> reg & 1)
+                def(reg);
+        }
+        return;
+    case X86Op::CQTO:
+        use(X86Reg::RAX);
+        def(X86Reg::RDX);
+        return;
+    case X86Op::IDIV:
+    case X86Op::DIV:
+        use(X86Reg::RAX);
+        use(X86Reg::RDX);
+        def(X86Reg::RAX);
+        def(X86Reg::RDX);
+        return;
+    case X86Op::IMUL:
+        if (inst.dst.kind != X86Operand::Kind::NONE)
+            break;
+        [[fallthrough]];
+    case X86Op::MUL:
+        use(X86Reg::RAX);
+        def(X86Reg::RAX);
+        def(X86Reg::RDX);
+        return;
+    default:
+        break;
+    }
+
+    if (!inst.dst.is_reg() || !tracked(inst.dst.reg))
+        return;
+    switch (inst.op) {
+    case X86Op::MOV:
+    case X86Op::MOVZX:
+    case X86Op::MOVSX:
+    case X86Op::LEA:
+    case X86Op::SETCC:
+        def(inst.dst.reg);
+        break;
+    case X86Op::CMP:
+    case X86Op::TEST:
+        use(inst.dst.reg);
+        break;
+    default:
+        use(inst.dst.reg);
+        def(inst.dst.reg);
+        break;
+    }
+}
+
+// Name of a physical register of the given size
+const char *register_name(int reg, int size);
+
+// Print an operand whose register is physical
+std::ostream &operator<<(std::ostream &os, const X86Operand &operand);
+
+// Print an instruction whose registers are all physical
+std::ostream &operator<<(std::ostream &os, const X86Instruction &inst);
+} // namespace myComp
+
+#endif // MYCOMP_X86_INSTRUCTION_H
@@ -0,0 +1,125 @@
+#ifndef MYCOMP_X86_OUTPUT_H
+#define MYCOMP_X86_OUTPUT_H
+
+#include <cstdint>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "X86_Encoder.h"
+#include "X86_Instruction.h"
+
+namespace myComp {
+// Where the x86-64 backend writes a translation unit
+class X86_Output {
+  public:
+    virtual ~X86_Output() = default;
+
+    // A global function, the code has its prologue and epilogue
+    virtual void function(Symbol name,
+                          const std::vector<X86Instruction> &code) = 0;
+
+    // A string literal in read-only data, `str` holds the bytes
+    virtual void string_literal(Symbol label, std::string_view str) = 0;
+
+    // A zero-initialized global variable of `count` elements
+    virtual void global_variable(Symbol name, int element_size,
+                                 int count) = 0;
+
+    // Write what is left and close the file
+    virtual void finish() = 0;
+};
+
+// GNU assembler source
+class X86_AsmOutput final : public X86_Output {
+  public:
+    explicit X86_AsmOutput(std::string_view filename);
+
+    void function(Symbol name,
+                  const std::vector<X86Instruction> &code) override;
+    void string_literal(Symbol label, std::string_view str) override;
+    void global_variable(Symbol name, int element_size, int count) override;
+    void finish() override;
+
+  private:
+    std::ofstream file_;
+};
+
+// Machine code and data kept in memory until finish()
+// - String literals are in .rodata, functions in .text and global variables
+//   in .data
+// - Relocations name the symbol they refer to, a string literal or a global
+//   one, defined or not
+class X86_MemoryOutput : public X86_Output {
+  public:
+    void function(Symbol name,
+                  const std::vector<X86Instruction> &code) override;
+    void string_literal(Symbol label, std::string_view str) override;
+    void global_variable(Symbol name, int element_size, int count) override;
+
+  protected:
+    // A function in .text or a variable in .data
+    struct Definition {
+        Symbol name;
+        uint64_t offset;
+        uint64_t size;
+        bool is_function;
+    };
+
+    std::vector<uint8_t> text_;
+    std::vector<uint8_t> data_;
+    std::vector<uint8_t> rodata_;
+    std::vector<X86_Relocation> relocations_;
+
+    std::vector<Definition> definitions_;
+
+    // Offsets of the string literals in .rodata
+    std::unordered_map<Symbol, uint64_t> literals_;
+
+  private:
+    X86_Encoder encoder_;
+};
+
+// Relocatable ELF64 object
+// - .text, .data and .rodata, then the relocations of .text and the symbols
+// - String literals are reached through the symbol of .rodata, the symbols
+//   used but not defined are left undefined for the linker
+class X86_ElfOutput final : public X86_MemoryOutput {
+  public:
+    explicit X86_ElfOutput(std::string_view filename);
+
+    void finish() override;
+
+  private:
+    std::ofstream file_;
+};
+
+// Code mapped in this process to be run at once
+// - .text, then a stub per function called but not defined, .data and
+//   .rodata, each on its own pages
+// - printint and printchar come from the compiler itself, other symbols from
+//   the libraries loaded in the process, the stubs reach them wherever they are
+class X86_JitOutput final : public X86_MemoryOutput {
+  public:
+    X86_JitOutput() = default;
+    X86_JitOutput(const X86_JitOutput &) = delete;
+    X86_JitOutput &operator=(const X86_JitOutput &) = delete;
+    ~X86_JitOutput() override;
+
+    // Map the code and data, resolve the relocations
+    void finish() override;
+
+    // Address of a function or variable of the translation unit, nullptr if
+    // there is none
+    void *address(Symbol name) const;
+
+  private:
+    uint8_t *memory_ = nullptr;
+    size_t size_ = 0;
+
+    std::unordered_map<Symbol, uint8_t *> addresses_;
+};
+} // namespace myComp
+
+#endif // MYCOMP_X86_OUTPUT_H
@@ -5,6 +5,7 @@
 #include <set>
 
 #include "ASTNode.h"
+#include "CodeGenerator.h"
 #include "Token.h"
 
 namespace myComp {
@@ -17,11 +18,13 @@ extern const std::set<TokenType> data_types;
 // Convert an AST node type to a string
 extern const std::map<ASTNodeType, const char *> ASTNode_str;
 
-// String literals
-extern std::map<std::string, std::string> string_literals;
+// The state of a compilation is per thread, a thread runs one at a time
+
+// String literals and their labels
+extern thread_local std::map<Symbol, std::string> string_literals;
 
 // Assembly code generator
-extern CodeGenerator *code_generator;
+extern thread_local CodeGenerator *code_generator;
 } // namespace myComp
 
 #endif // MYCOMP_DATA_H
@@ -1,71 +1,132 @@
 #define F_DEBUG
 
+#include <fstream>
 #include <iostream>
+#include <sstream>
 
+#include "Compiler.h"
 #include "Init.h"
-#include "Parser.h"
-#include "TokenProcessor.h"
-#include "data.h"
+#include "ThreadPool.h"
+#include "TimeReport.h"
 #include "ArgParser.h"
 
 using namespace myComp;
 
+namespace {
+// What became of the compilation of a file
+struct Outcome {
+    int exit_code = 0;
+    bool failed = false;
+    std::string error;
+
+    // The statistics of -D and the times of -jit, printed in the order of
+    // the files
+    std::string log;
+};
+} // namespace
+
 int main(int argc, char **argv) {
+    int exit_code = 0;
     try {
+        TimeReport report;
+
         // Parse the arguments
         ArgParser arg_parser;
         arg_parser.parse(argc, argv);
+        if (arg_parser.time_report()) {
+            TimeReport::count_allocations();
+        }
+        const auto &file_names = arg_parser.file_names();
+        bool several = file_names.size() > 1;
 
         // If debug mode, create log dir
-        if (arg_parser.debug()) {
+        if (arg_parser.debug() || arg_parser.time_trace()) {
             std::filesystem::create_directories("logs");
         }
 
-        // Initialize
-        Init::init();
+        // Each file has its own report and outcome, so that several can be
+        // compiled at once, nothing of a translation unit is kept for the
+        // next one
+        std::vector<TimeReport> reports(file_names.size());
+        std::vector<Outcome> outcomes(file_names.size());
+        auto run = [&](size_t i) {
+            const std::string &file_name = file_names[i];
 
-        TokenProcessor token_processor;
-        token_processor.set_input(arg_parser.file_name());
-        token_processor.process();
-        if (arg_parser.debug()) {
-            std::ofstream out("logs/tokens.txt");
-            token_processor.print(out);
-        }
+            // The dumps of each file go to a directory of their own
+            CompileOptions options = arg_parser.options(file_name);
+            if (several) {
+                options.logs /= std::filesystem::path(options.output).stem();
+            }
+            if (options.debug) {
+                std::filesystem::create_directories(options.logs);
+            }
 
-        Parser parser;
-        parser.set_processor(&token_processor);
+            std::ostringstream log;
+            try {
+                outcomes[i].exit_code =
+                    compile(file_name, options, reports[i], log).exit_code;
+            } catch (const std::exception &e) {
+                outcomes[i].exit_code = 1;
+                outcomes[i].failed = true;
+                outcomes[i].error = e.what();
+                Init::end();
 
-        code_generator->set_output("out.s");
+                // No half-written output is left behind
+                if (!arg_parser.jit()) {
+                    std::filesystem::remove(arg_parser.output_name(file_name));
+                }
+            }
+            outcomes[i].log = log.str();
+        };
 
-        // Build trees
-        std::vector<ASTNode_ *> nodes;
-        while (!token_processor.eof()) {
-            ASTNode_ *tree = parser.build_tree();
-            if (tree != nullptr) {
-                nodes.push_back(tree);
+        size_t jobs = std::min(arg_parser.jobs(), file_names.size());
+        if (jobs > 1) {
+            ThreadPool pool(jobs);
+            for (size_t i = 0; i < file_names.size(); i++) {
+                pool.submit([&run, i] { run(i); });
+            }
+            pool.wait();
+        } else {
+            for (size_t i = 0; i < file_names.size(); i++) {
+                run(i);
             }
         }
 
-        if (arg_parser.debug()) {
-            std::ofstream out("logs/tree.txt");
-            for (auto node : nodes) {
-                node->print(out, 0);
+        // Report in the order of the files
+        for (size_t i = 0; i < file_names.size(); i++) {
+            report.merge(reports[i], file_names[i], static_cast<int>(i) + 1);
+            const Outcome &outcome = outcomes[i];
+            std::istringstream lines(outcome.log);
+            for (std::string line; std::getline(lines, line);) {
+                if (several) {
+                    std::clog << file_names[i] << ": ";
+                }
+                std::clog << line << std::endl;
+            }
+            if (outcome.failed) {
+                if (several) {
+                    std::cerr << file_names[i] << ": ";
+                }
+                std::cerr << outcome.error << std::endl;
+            }
+            if (exit_code == 0) {
+                exit_code = outcome.exit_code;
             }
         }
-
-        // Generate the assembly code
-        code_generator->prelude();
-        for (auto &node : nodes) {
-            node->generate_code(code_generator);
-            delete node;
+        if (!several && outcomes[0].failed) {
+            return exit_code;
         }
-        code_generator->postlude();
 
-        // End
-        Init::end();
+        if (arg_parser.time_report()) {
+            report.print(std::clog, arg_parser.slowest_functions(), jobs > 1);
+        }
+        if (arg_parser.time_trace()) {
+            std::ofstream out("logs/time_trace.json");
+            report.write_trace(out);
+        }
     } catch (const std::exception &e) {
         std::cerr << e.what() << std::endl;
         return 1;
     }
-    return 0;
+    return exit_code;
 }
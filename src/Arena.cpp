@@ -0,0 +1,39 @@
+#include <cstdint>
+
+#include "Arena.h"
+
+namespace myComp {
+void *Arena::allocate(size_t size, size_t align) {
+    bytes_used_ += size;
+
+    // Large requests get a block of their own, the current block stays in use
+    if (size > block_size_ / 4)
+        return new_block(size);
+
+    size_t padding = -reinterpret_cast<uintptr_t>(cur_) & (align - 1);
+    if (padding + size > static_cast<size_t>(end_ - cur_)) {
+        cur_ = new_block(block_size_);
+        end_ = cur_ + block_size_;
+        padding = 0;
+    }
+
+    std::byte *ptr = cur_ + padding;
+    cur_ = ptr + size;
+    return ptr;
+}
+
+std::byte *Arena::new_block(size_t size) {
+    // operator new[] aligns the block for any fundamental type
+    blocks_.push_back(std::make_unique_for_overwrite<std::byte[]>(size));
+    bytes_reserved_ += size;
+    return blocks_.back().get();
+}
+
+void Arena::reset() {
+    blocks_.clear();
+    cur_ = end_ = nullptr;
+    nodes_ = 0;
+    bytes_used_ = 0;
+    bytes_reserved_ = 0;
+}
+} // namespace myComp
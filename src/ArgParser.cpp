@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <set>
+#include <thread>
+
 #include "ArgParser.h"
 
 using namespace std;
@@ -8,33 +12,92 @@ void ArgParser::parse(int argc, char **argv) {
     _stringfy(argc, argv);
     _program_name = _args.front();
 
-    // If not enough args, throw error
-    if (_args.size() < 2) {
-        throw invalid_argument("Usage: " + _program_name +
-                               " [opts] <filename>");
-    }
-
-    _file_name = _args.back();
-
-    // Check if file exists
-    if (!filesystem::exists(_file_name)) {
-        throw invalid_argument("File " + _file_name + " does not exist");
-    }
-
-    // Delete the program name and the file name
+    // Delete the program name
     _args.erase(_args.begin());
-    _args.pop_back();
 
     // Start parsing the arguments
     for (auto it = _args.begin(); it != _args.end(); it++) {
         if (*it == "-D") {
             _debug = true;
+        } else if (*it == "-S") {
+            _assembly = true;
+        } else if (*it == "-jit") {
+            _jit = true;
+        } else if (*it == "-j") {
+            // As many files at once as there are cores
+            _jobs = max(1u, thread::hardware_concurrency());
+        } else if (it->starts_with("-j") &&
+                   it->find_first_not_of("0123456789", 2) == string::npos) {
+            _jobs = max(1ul, stoul(it->substr(2)));
+        } else if (*it == "-ftime-report") {
+            _time_report = true;
+        } else if (it->starts_with("-ftime-report=")) {
+            // The number of slowest functions to list
+            _time_report = true;
+            _slowest_functions = stoul(it->substr(14));
+        } else if (*it == "-ftime-trace") {
+            _time_trace = true;
         } else if (*it == "-const-propagation") {
             _const_propagation = true;
+        } else if (*it == "-no-mem2reg") {
+            _mem2reg = false;
+        } else if (it->starts_with("-peephole=")) {
+            _peephole = it->substr(10);
+        } else if (*it == "-no-peephole") {
+            _peephole = "none";
+        } else if (*it == "-" || !it->starts_with("-")) {
+            // An input file, "-" stands for the standard input
+            if (*it != "-" && !filesystem::exists(*it)) {
+                throw invalid_argument("File " + *it + " does not exist");
+            }
+            _file_names.push_back(*it);
         } else {
             cerr << "Unknown option: " << *it << endl;
         }
     }
+
+    // If no input file, throw error
+    if (_file_names.empty()) {
+        throw invalid_argument("Usage: " + _program_name +
+                               " [opts] <filename>...");
+    }
+
+    // Several files are compiled one after the other, each to its own output
+    if (_file_names.size() > 1) {
+        if (_jit) {
+            throw invalid_argument("-jit runs a single file");
+        }
+        set<string> outputs;
+        for (const auto &file_name : _file_names) {
+            if (!outputs.insert(output_name(file_name)).second) {
+                throw invalid_argument("Several files would be written to " +
+                                       output_name(file_name));
+            }
+        }
+    }
+}
+
+string ArgParser::output_name(const string &file_name) const {
+    const char *extension = _assembly ? ".s" : ".o";
+    if (_file_names.size() == 1) {
+        return string("out") + extension;
+    }
+    // The standard input has no name of its own
+    string stem =
+        file_name == "-" ? "stdin" : filesystem::path(file_name).stem().string();
+    return stem + extension;
+}
+
+CompileOptions ArgParser::options(const string &file_name) const {
+    CompileOptions options;
+    options.debug = _debug;
+    options.const_propagation = _const_propagation;
+    options.mem2reg = _mem2reg;
+    options.peephole = _peephole;
+    options.timing = _time_report || _time_trace;
+    options.jit = _jit;
+    options.output = output_name(file_name);
+    return options;
 }
 
 void ArgParser::_stringfy(int argc, char **argv) {
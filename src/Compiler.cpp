@@ -0,0 +1,162 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "Arena.h"
+#include "Compiler.h"
+#include "ConstantFolding.h"
+#include "IRBuilder.h"
+#include "IRLowering.h"
+#include "Init.h"
+#include "Mem2Reg.h"
+#include "Parser.h"
+#include "TokenProcessor.h"
+#include "data.h"
+
+namespace myComp {
+CompileResult compile(const std::string &file_name,
+                      const CompileOptions &options, TimeReport &report,
+                      std::ostream &log) {
+    CompileResult result;
+    auto start = std::chrono::steady_clock::now();
+
+    // Initialize
+    Init::init();
+
+    TokenProcessor token_processor;
+    token_processor.set_input(file_name);
+    // Dumping the tokens needs all of them up front, otherwise scan them
+    // while parsing, the time of which is split out of the parse
+    if (options.debug) {
+        report.start("scan");
+        token_processor.process();
+        report.stop();
+        std::ofstream out(options.logs / "tokens.txt");
+        token_processor.print(out);
+    } else {
+        token_processor.stream();
+        if (options.timing) {
+            token_processor.measure();
+        }
+    }
+
+    // All the nodes of the translation unit
+    Arena arena;
+
+    Parser parser;
+    parser.set_processor(&token_processor);
+    parser.set_arena(&arena);
+
+    // Write an object file, or assembly code to read, or keep the code in
+    // memory to run it
+    if (options.jit) {
+        code_generator->set_jit();
+    } else {
+        code_generator->set_output(options.output);
+    }
+    code_generator->set_peephole(options.peephole);
+
+    // Build trees
+    report.start("parse");
+    std::vector<ASTNode_ *> nodes;
+    while (!token_processor.eof()) {
+        ASTNode_ *tree = parser.build_tree();
+        if (tree != nullptr) {
+            nodes.push_back(tree);
+        }
+    }
+
+    // Fold constants before the trees are dumped, so the dump shows what
+    // is compiled
+    ConstantFolding folding(&arena);
+    if (options.const_propagation) {
+        report.start("fold");
+        for (auto node : nodes) {
+            folding.run(node);
+        }
+    }
+    report.stop();
+    report.split("parse", "scan", token_processor.scan_usage());
+    result.tokens = token_processor.size() - 1;
+    result.nodes = arena.nodes();
+
+    if (options.debug) {
+        std::ofstream out(options.logs / "tree.txt");
+        for (auto node : nodes) {
+            node->print(out, 0);
+        }
+    }
+
+    // Lower the functions to the IR, then to assembly code
+    std::ofstream ir_out;
+    if (options.debug) {
+        ir_out.open(options.logs / "ir.txt");
+    }
+    IRBuilder ir_builder;
+    Mem2Reg mem2reg;
+    IRLowering ir_lowering(code_generator);
+    report.start("codegen");
+    code_generator->prelude();
+    for (auto node : nodes) {
+        if (!node->is_function_definition()) {
+            continue;
+        }
+        auto function_start = TimeReport::Clock::now();
+        auto function =
+            ir_builder.build(static_cast<FunctionDefinitionNode *>(node));
+        if (options.mem2reg) {
+            mem2reg.run(*function);
+        }
+        if (options.debug) {
+            function->print(ir_out);
+        }
+        ir_lowering.run(*function);
+        report.function(function->prototype()->name_, function_start,
+                        TimeReport::Clock::now());
+    }
+    report.start("write");
+    code_generator->postlude();
+    report.stop();
+
+    if (options.jit) {
+        auto compiled = std::chrono::steady_clock::now();
+        report.start("run");
+        result.exit_code = code_generator->run_main();
+        std::fflush(stdout);
+        report.stop();
+        auto ran = std::chrono::steady_clock::now();
+
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        log << "JIT: compile " << Milliseconds(compiled - start).count()
+            << " ms, run " << Milliseconds(ran - compiled).count() << " ms"
+            << std::endl;
+    }
+
+    if (options.debug) {
+        log << "AST: " << arena.nodes() << " nodes, " << arena.bytes_used()
+            << " bytes used, " << arena.bytes_reserved() << " bytes reserved"
+            << std::endl;
+        if (options.const_propagation) {
+            log << "Constant propagation: " << folding.folded()
+                << " nodes folded, " << folding.propagated()
+                << " reads propagated, " << folding.pruned()
+                << " branches pruned" << std::endl;
+        }
+        if (options.mem2reg) {
+            log << "Mem2Reg: " << mem2reg.promoted() << " of "
+                << mem2reg.candidates() << " scalar variables promoted, "
+                << mem2reg.phis() << " phi nodes" << std::endl;
+        }
+        code_generator->print_statistics(log);
+    }
+
+    // Free all the nodes at once
+    nodes.clear();
+    arena.reset();
+
+    // End
+    Init::end();
+    return result;
+}
+} // namespace myComp
@@ -0,0 +1,483 @@
+#include <cstdint>
+
+#include "ConstantFolding.h"
+#include "Errors.h"
+
+namespace {
+using namespace myComp;
+using namespace std;
+
+// Value of an integer literal
+optional<long long> constant(const ExpressionNode *node) {
+    if (node == nullptr || node->node_type() != ASTNodeType::INT_LITERAL)
+        return nullopt;
+    return static_cast<const LiteralNode *>(node)->get_int_value();
+}
+
+// Variable read or written by a node, if it is a plain variable
+Variable *variable_of(const ExpressionNode *node) {
+    if (node->node_type() != ASTNodeType::VARIABLE)
+        return nullptr;
+    return static_cast<const VariableNode *>(node)->get_variable();
+}
+
+// Call `f` on every child of a node
+template <typename F> void for_each_child(const ASTNode_ *node, F &&f) {
+    auto visit = [&](const ASTNode_ *child) {
+        if (child != nullptr)
+            f(child);
+    };
+
+    switch (node->node_type()) {
+    case ASTNodeType::COMPOUND:
+        for (auto *statement :
+             static_cast<const CodeBlockNode *>(node)->get_statements())
+            visit(statement);
+        return;
+    case ASTNodeType::FUNCTION_DECLARATION:
+        visit(static_cast<const FunctionDefinitionNode *>(node)
+                  ->get_code_block());
+        return;
+    case ASTNodeType::IF: {
+        auto *if_node = static_cast<const IfNode *>(node);
+        visit(if_node->get_condition());
+        visit(if_node->get_if_block());
+        visit(if_node->get_else_block());
+        return;
+    }
+    case ASTNodeType::WHILE: {
+        auto *while_node = static_cast<const WhileNode *>(node);
+        visit(while_node->get_condition());
+        visit(while_node->get_code_block());
+        return;
+    }
+    case ASTNodeType::FOR: {
+        auto *for_node = static_cast<const ForNode *>(node);
+        visit(for_node->get_initializer());
+        visit(for_node->get_condition());
+        visit(for_node->get_increment());
+        visit(for_node->get_code_block());
+        return;
+    }
+    case ASTNodeType::RETURN:
+        visit(static_cast<const ReturnNode *>(node)->get_expression());
+        return;
+    case ASTNodeType::FUNCTION_CALL:
+        for (auto *argument :
+             static_cast<const FunctionCallNode *>(node)->get_arguments())
+            visit(argument);
+        return;
+    case ASTNodeType::VARIABLE:
+    case ASTNodeType::VARIABLE_DECLARATION:
+    case ASTNodeType::INT_LITERAL:
+    case ASTNodeType::STRING_LITERAL:
+        return;
+    default:
+        break;
+    }
+
+    auto *expression = static_cast<const ExpressionNode *>(node);
+    if (expression->is_binary()) {
+        auto *binary = static_cast<const BinaryExpressionNode *>(node);
+        visit(binary->get_left());
+        visit(binary->get_right());
+    } else if (expression->is_unary()) {
+        visit(static_cast<const UnaryExpressionNode *>(node)->get_operand());
+    }
+}
+
+// Variable modified by a node, if any
+Variable *assigned_variable(const ASTNode_ *node) {
+    switch (node->node_type()) {
+    case ASTNodeType::ASSIGN:
+        return variable_of(
+            static_cast<const BinaryExpressionNode *>(node)->get_left());
+    case ASTNodeType::PRE_INC:
+    case ASTNodeType::PRE_DEC:
+    case ASTNodeType::POST_INC:
+    case ASTNodeType::POST_DEC:
+        return variable_of(
+            static_cast<const UnaryExpressionNode *>(node)->get_operand());
+    default:
+        return nullptr;
+    }
+}
+
+void collect_address_taken(const ASTNode_ *node,
+                           unordered_set<const Variable *> &out) {
+    if (node->node_type() == ASTNodeType::ADDRESS) {
+        auto *operand = static_cast<const UnaryExpressionNode *>(node);
+        if (Variable *var = variable_of(operand->get_operand()))
+            out.insert(var);
+    }
+    for_each_child(node,
+                   [&](const ASTNode_ *child) { collect_address_taken(child, out); });
+}
+} // namespace
+
+namespace myComp {
+void ConstantFolding::run(ASTNode_ *node) {
+    if (node->node_type() != ASTNodeType::FUNCTION_DECLARATION)
+        return;
+
+    values_.clear();
+    address_taken_.clear();
+    collect_address_taken(node, address_taken_);
+
+    block(static_cast<FunctionDefinitionNode *>(node)->get_code_block());
+}
+
+void ConstantFolding::block(CodeBlockNode *node) {
+    std::vector<StatementNode *> out;
+    statements(node, out);
+    node->set_statements(arena_->copy(out));
+}
+
+void ConstantFolding::statements(CodeBlockNode *node,
+                                 std::vector<StatementNode *> &out) {
+    for (StatementNode *statement : node->get_statements()) {
+        switch (statement->node_type()) {
+        case ASTNodeType::IF: {
+            auto *if_node = static_cast<IfNode *>(statement);
+            if_node->set_condition(expression(if_node->get_condition()));
+
+            // The taken block replaces the statement
+            if (auto condition = constant(if_node->get_condition())) {
+                pruned_++;
+                CodeBlockNode *taken = *condition != 0
+                                           ? if_node->get_if_block()
+                                           : if_node->get_else_block();
+                if (taken != nullptr)
+                    statements(taken, out);
+                continue;
+            }
+
+            Values before = values_;
+            block(if_node->get_if_block());
+            Values after_if = std::move(values_);
+            values_ = std::move(before);
+            if (if_node->get_else_block() != nullptr)
+                block(if_node->get_else_block());
+            merge(after_if);
+            break;
+        }
+        case ASTNodeType::WHILE: {
+            auto *while_node = static_cast<WhileNode *>(statement);
+
+            // Values assigned in the loop are unknown from the second
+            // iteration on
+            kill_assigned(while_node);
+            while_node->set_condition(expression(while_node->get_condition()));
+            if (auto condition = constant(while_node->get_condition());
+                condition && *condition == 0) {
+                pruned_++;
+                continue;
+            }
+
+            Values before = values_;
+            block(while_node->get_code_block());
+            values_ = std::move(before);
+            break;
+        }
+        case ASTNodeType::FOR: {
+            auto *for_node = static_cast<ForNode *>(statement);
+            for_node->set_initializer(expression(for_node->get_initializer()));
+
+            kill_assigned(for_node->get_condition());
+            kill_assigned(for_node->get_increment());
+            kill_assigned(for_node->get_code_block());
+            for_node->set_condition(expression(for_node->get_condition()));
+
+            // The increment runs after the body on every iteration
+            Values before = values_;
+            block(for_node->get_code_block());
+            for_node->set_increment(expression(for_node->get_increment()));
+            values_ = std::move(before);
+            break;
+        }
+        case ASTNodeType::RETURN: {
+            auto *return_node = static_cast<ReturnNode *>(statement);
+            return_node->set_expression(
+                expression(return_node->get_expression()));
+            break;
+        }
+        case ASTNodeType::VARIABLE_DECLARATION: {
+            auto *declaration = static_cast<VariableDeclarationNode *>(statement);
+            if (declaration->get_variable() != nullptr)
+                values_.erase(declaration->get_variable());
+            break;
+        }
+        default:
+            statement = expression(static_cast<ExpressionNode *>(statement));
+            break;
+        }
+        out.push_back(statement);
+    }
+}
+
+ExpressionNode *ConstantFolding::expression(ExpressionNode *node) {
+    if (node == nullptr)
+        return nullptr;
+
+    switch (node->node_type()) {
+    case ASTNodeType::INT_LITERAL:
+    case ASTNodeType::STRING_LITERAL:
+        return node;
+    case ASTNodeType::VARIABLE: {
+        Variable *var = variable_of(node);
+        auto it = values_.find(var);
+        if (it == values_.end())
+            return node;
+        propagated_++;
+        return literal(var->type, it->second);
+    }
+    case ASTNodeType::ASSIGN: {
+        // The right side is evaluated first
+        auto *assign_node = static_cast<AssignNode *>(node);
+        assign_node->set_right(expression(assign_node->get_right()));
+        if (Variable *var = variable_of(assign_node->get_left())) {
+            std::optional<long long> value = constant(assign_node->get_right());
+            if (value)
+                value = normalize(*value, var->type);
+            assign(var, value);
+        } else {
+            assign_node->set_left(expression(assign_node->get_left()));
+        }
+        return node;
+    }
+    case ASTNodeType::PRE_INC:
+    case ASTNodeType::PRE_DEC:
+    case ASTNodeType::POST_INC:
+    case ASTNodeType::POST_DEC: {
+        // The operand is a variable, it keeps being written
+        Variable *var = assigned_variable(node);
+        auto it = values_.find(var);
+        if (it != values_.end()) {
+            bool inc = node->node_type() == ASTNodeType::PRE_INC ||
+                       node->node_type() == ASTNodeType::POST_INC;
+            it->second = normalize(
+                static_cast<long long>(static_cast<uint64_t>(it->second) +
+                                       (inc ? 1 : -1)),
+                var->type);
+        }
+        return node;
+    }
+    case ASTNodeType::ADDRESS: {
+        // &x keeps the variable, &*p and &a[i] only rewrite the address
+        auto *address = static_cast<AddressNode *>(node);
+        if (variable_of(address->get_operand()) == nullptr)
+            address->set_operand(expression(address->get_operand()));
+        return node;
+    }
+    case ASTNodeType::LOGICAL_AND:
+    case ASTNodeType::LOGICAL_OR: {
+        auto *logical = static_cast<BinaryExpressionNode *>(node);
+        bool is_and = node->node_type() == ASTNodeType::LOGICAL_AND;
+        logical->set_left(expression(logical->get_left()));
+
+        // The right side is not evaluated when the left side decides
+        if (auto left = constant(logical->get_left());
+            left && (*left != 0) != is_and) {
+            folded_++;
+            return literal(node->type(), is_and ? 0 : 1);
+        }
+
+        // Otherwise it is evaluated only sometimes
+        Values before = values_;
+        logical->set_right(expression(logical->get_right()));
+        if (!constant(logical->get_left()))
+            merge(before);
+        break;
+    }
+    case ASTNodeType::FUNCTION_CALL: {
+        // Arguments are evaluated from the last one
+        auto arguments = static_cast<FunctionCallNode *>(node)->get_arguments();
+        for (size_t i = arguments.size(); i-- > 0;)
+            arguments[i] = expression(arguments[i]);
+        return node;
+    }
+    default: {
+        if (node->is_binary()) {
+            auto *binary = static_cast<BinaryExpressionNode *>(node);
+            binary->set_left(expression(binary->get_left()));
+            binary->set_right(expression(binary->get_right()));
+        } else if (node->is_unary()) {
+            auto *unary = static_cast<UnaryExpressionNode *>(node);
+            unary->set_operand(expression(unary->get_operand()));
+        }
+        break;
+    }
+    }
+
+    if (auto value = evaluate(node)) {
+        folded_++;
+        return literal(node->type(), *value);
+    }
+    return node;
+}
+
+std::optional<long long>
+ConstantFolding::evaluate(const ExpressionNode *node) const {
+    Type *type = node->type();
+    if (type == nullptr || !type->is_integer())
+        return std::nullopt;
+
+    // Unary operators
+    if (node->is_unary()) {
+        const ExpressionNode *operand =
+            static_cast<const UnaryExpressionNode *>(node)->get_operand();
+        auto value = constant(operand);
+        if (!value || !operand->type()->is_integer())
+            return std::nullopt;
+        auto a = static_cast<uint64_t>(normalize(*value, type));
+
+        switch (node->node_type()) {
+        case ASTNodeType::NEGATIVE:
+            return normalize(static_cast<long long>(0 - a), type);
+        case ASTNodeType::POSITIVE:
+            return normalize(static_cast<long long>(a), type);
+        case ASTNodeType::INVERT:
+            return normalize(static_cast<long long>(~a), type);
+        case ASTNodeType::NOT:
+            return *value == 0 ? 1 : 0;
+        default:
+            return std::nullopt;
+        }
+    }
+
+    if (!node->is_binary())
+        return std::nullopt;
+
+    auto *binary = static_cast<const BinaryExpressionNode *>(node);
+    const ExpressionNode *left = binary->get_left();
+    const ExpressionNode *right = binary->get_right();
+    auto left_value = constant(left);
+    auto right_value = constant(right);
+    if (!left_value || !right_value || !left->type()->is_integer() ||
+        !right->type()->is_integer())
+        return std::nullopt;
+
+    ASTNodeType kind = node->node_type();
+
+    // Both sides are known here
+    if (kind == ASTNodeType::LOGICAL_AND)
+        return *left_value != 0 && *right_value != 0;
+    if (kind == ASTNodeType::LOGICAL_OR)
+        return *left_value != 0 || *right_value != 0;
+
+    // Shifts work in the promoted type of the left operand, the count must be
+    // in range
+    if (kind == ASTNodeType::L_SHIFT || kind == ASTNodeType::R_SHIFT) {
+        long long count = *right_value;
+        if (count < 0 || count >= static_cast<long long>(type->size() * 8))
+            return std::nullopt;
+        long long a = normalize(*left_value, type);
+        if (kind == ASTNodeType::L_SHIFT)
+            return normalize(
+                static_cast<long long>(static_cast<uint64_t>(a) << count),
+                type);
+        if (type->is_signed())
+            return normalize(a >> count, type);
+        return normalize(static_cast<long long>(static_cast<uint64_t>(a) >> count),
+                         type);
+    }
+
+    // Everything else works in the common type of the operands
+    Type *common = usual_arithmetic_conversion(left->type(), right->type());
+    bool is_signed = common->is_signed();
+    long long a = normalize(*left_value, common);
+    long long b = normalize(*right_value, common);
+    auto ua = static_cast<uint64_t>(a);
+    auto ub = static_cast<uint64_t>(b);
+
+    long long result;
+    switch (kind) {
+    case ASTNodeType::ADD:
+        result = static_cast<long long>(ua + ub);
+        break;
+    case ASTNodeType::SUBTRACT:
+        result = static_cast<long long>(ua - ub);
+        break;
+    case ASTNodeType::MULTIPLY:
+        result = static_cast<long long>(ua * ub);
+        break;
+    case ASTNodeType::DIVIDE:
+    case ASTNodeType::MODULO: {
+        // Leave the traps to the program
+        if (b == 0)
+            return std::nullopt;
+        long long min = normalize(
+            static_cast<long long>(uint64_t{1} << (common->size() * 8 - 1)),
+            common);
+        if (is_signed && a == min && b == -1)
+            return std::nullopt;
+        if (kind == ASTNodeType::DIVIDE)
+            result = is_signed ? a / b : static_cast<long long>(ua / ub);
+        else
+            result = is_signed ? a % b : static_cast<long long>(ua % ub);
+        break;
+    }
+    case ASTNodeType::AND:
+        result = a & b;
+        break;
+    case ASTNodeType::OR:
+        result = a | b;
+        break;
+    case ASTNodeType::XOR:
+        result = a ^ b;
+        break;
+    case ASTNodeType::EQUALS:
+        result = a == b;
+        break;
+    case ASTNodeType::NEQ:
+        result = a != b;
+        break;
+    case ASTNodeType::LESS:
+        result = is_signed ? a < b : ua < ub;
+        break;
+    case ASTNodeType::GREATER:
+        result = is_signed ? a > b : ua > ub;
+        break;
+    case ASTNodeType::LESS_EQ:
+        result = is_signed ? a <= b : ua <= ub;
+        break;
+    case ASTNodeType::GREATER_EQ:
+        result = is_signed ? a >= b : ua >= ub;
+        break;
+    default:
+        return std::nullopt;
+    }
+    return normalize(result, type);
+}
+
+void ConstantFolding::assign(Variable *var, std::optional<long long> value) {
+    if (value && trackable(var))
+        values_[var] = *value;
+    else
+        values_.erase(var);
+}
+
+bool ConstantFolding::trackable(const Variable *var) const {
+    return var->scope != Context::global() && var->type->is_integer() &&
+           !address_taken_.contains(var);
+}
+
+void ConstantFolding::merge(const Values &other) {
+    std::erase_if(values_, [&](const auto &entry) {
+        auto it = other.find(entry.first);
+        return it == other.end() || it->second != entry.second;
+    });
+}
+
+void ConstantFolding::kill_assigned(const ASTNode_ *node) {
+    if (node == nullptr)
+        return;
+    if (Variable *var = assigned_variable(node))
+        values_.erase(var);
+    for_each_child(node, [&](const ASTNode_ *child) { kill_assigned(child); });
+}
+
+LiteralNode *ConstantFolding::literal(Type *type, long long value) {
+    return new (*arena_) LiteralNode(type, value);
+}
+} // namespace myComp
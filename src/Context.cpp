@@ -4,7 +4,7 @@
 namespace myComp {
 std::string FunctionPrototype::str() const {
     std::string ret = return_type_->str();
-    ret += " " + name_ + "(";
+    ret += " " + name_.str() + "(";
     for (auto &param : parameters_) {
         ret += param->str() + ", ";
     }
@@ -16,18 +16,18 @@ std::string FunctionPrototype::str() const {
     return ret;
 }
 
-bool FunctionManager::exists(const std::string &name) {
+bool FunctionManager::exists(Symbol name) {
     auto &cache = getCache();
     return cache.find(name) != cache.end();
 }
 
-void FunctionManager::ensure_exists(const std::string &name) {
+void FunctionManager::ensure_exists(Symbol name) {
     if (!exists(name)) {
-        throw SyntaxException("function " + name + " not defined");
+        throw SyntaxException("function " + name.str() + " not defined");
     }
 }
 
-FunctionPrototype *FunctionManager::find(const std::string &name) {
+FunctionPrototype *FunctionManager::find(Symbol name) {
     auto &cache = getCache();
     auto it = cache.find(name);
     if (it == cache.end()) {
@@ -36,12 +36,12 @@ FunctionPrototype *FunctionManager::find(const std::string &name) {
     return it->second.get();
 }
 
-void FunctionManager::insert(Type *return_type, const std::string &name,
+void FunctionManager::insert(Type *return_type, Symbol name,
                              std::vector<Variable *> parameters, bool is_variadic) {
     auto &cache = getCache();
     auto it = cache.find(name);
     if (it != cache.end()) {
-        throw SyntaxException("function " + name + " already defined");
+        throw SyntaxException("function " + name.str() + " already defined");
     }
     auto func = std::make_unique<FunctionPrototype>();
     func->return_type_ = return_type;
@@ -82,83 +82,85 @@ bool is_postfix_operator(TokenType type) {
     return postfix_operators.contains(type);
 }
 
-DereferenceNode *subscript_builder(const string &identifier,
+DereferenceNode *subscript_builder(Arena &arena, Symbol identifier,
                                    ExpressionNode *index) {
     Variable *var = VariableManager::find(identifier);
 
-    VariableNode *var_node = new VariableNode(var);
-    AddNode *add = new AddNode(var_node, index);
-    return new DereferenceNode(add);
+    VariableNode *var_node = new (arena) VariableNode(var);
+    AddNode *add = new (arena) AddNode(var_node, index);
+    return new (arena) DereferenceNode(add);
 }
 
-BinaryExpressionNode *binary_builder(ASTNodeType type, ExpressionNode *left,
+BinaryExpressionNode *binary_builder(Arena &arena, ASTNodeType type,
+                                     ExpressionNode *left,
                                      ExpressionNode *right) {
     switch (type) {
     case ASTNodeType::ADD:
-        return new AddNode(left, right);
+        return new (arena) AddNode(left, right);
     case ASTNodeType::SUBTRACT:
-        return new SubtractNode(left, right);
+        return new (arena) SubtractNode(left, right);
     case ASTNodeType::MULTIPLY:
-        return new MultiplyNode(left, right);
+        return new (arena) MultiplyNode(left, right);
     case ASTNodeType::DIVIDE:
-        return new DivideNode(left, right);
+        return new (arena) DivideNode(left, right);
     case ASTNodeType::MODULO:
-        return new ModuloNode(left, right);
+        return new (arena) ModuloNode(left, right);
     case ASTNodeType::OR:
-        return new OrNode(left, right);
+        return new (arena) OrNode(left, right);
     case ASTNodeType::AND:
-        return new AndNode(left, right);
+        return new (arena) AndNode(left, right);
     case ASTNodeType::XOR:
-        return new XorNode(left, right);
+        return new (arena) XorNode(left, right);
     case ASTNodeType::L_SHIFT:
-        return new LeftShiftNode(left, right);
+        return new (arena) LeftShiftNode(left, right);
     case ASTNodeType::R_SHIFT:
-        return new RightShiftNode(left, right);
+        return new (arena) RightShiftNode(left, right);
     case ASTNodeType::LESS:
-        return new LessNode(left, right);
+        return new (arena) LessNode(left, right);
     case ASTNodeType::GREATER:
-        return new GreaterNode(left, right);
+        return new (arena) GreaterNode(left, right);
     case ASTNodeType::LESS_EQ:
-        return new LessEqualsNode(left, right);
+        return new (arena) LessEqualsNode(left, right);
     case ASTNodeType::GREATER_EQ:
-        return new GreaterEqualsNode(left, right);
+        return new (arena) GreaterEqualsNode(left, right);
     case ASTNodeType::EQUALS:
-        return new EqualsNode(left, right);
+        return new (arena) EqualsNode(left, right);
     case ASTNodeType::NEQ:
-        return new NotEqualsNode(left, right);
+        return new (arena) NotEqualsNode(left, right);
     case ASTNodeType::LOGICAL_OR:
-        return new LogicalOrNode(left, right);
+        return new (arena) LogicalOrNode(left, right);
     case ASTNodeType::LOGICAL_AND:
-        return new LogicalAndNode(left, right);
+        return new (arena) LogicalAndNode(left, right);
     case ASTNodeType::ASSIGN:
-        return new AssignNode(left, right);
+        return new (arena) AssignNode(left, right);
     default:
         throw InvalidException("binary operator");
     }
 }
 
-UnaryExpressionNode *unary_builder(ASTNodeType type, ExpressionNode *oprand) {
+UnaryExpressionNode *unary_builder(Arena &arena, ASTNodeType type,
+                                   ExpressionNode *oprand) {
     switch (type) {
     case ASTNodeType::INVERT:
-        return new InvertNode(oprand);
+        return new (arena) InvertNode(oprand);
     case ASTNodeType::NOT:
-        return new NotNode(oprand);
+        return new (arena) NotNode(oprand);
     case ASTNodeType::ADDRESS:
-        return new AddressNode(oprand);
+        return new (arena) AddressNode(oprand);
     case ASTNodeType::DEREFERENCE:
-        return new DereferenceNode(oprand);
+        return new (arena) DereferenceNode(oprand);
     case ASTNodeType::POST_INC:
-        return new PostIncrementNode(oprand);
+        return new (arena) PostIncrementNode(oprand);
     case ASTNodeType::POST_DEC:
-        return new PostDecrementNode(oprand);
+        return new (arena) PostDecrementNode(oprand);
     case ASTNodeType::PRE_INC:
-        return new PreIncrementNode(oprand);
+        return new (arena) PreIncrementNode(oprand);
     case ASTNodeType::PRE_DEC:
-        return new PreDecrementNode(oprand);
+        return new (arena) PreDecrementNode(oprand);
     case ASTNodeType::NEGATIVE:
-        return new NegativeNode(oprand);
+        return new (arena) NegativeNode(oprand);
     case ASTNodeType::POSITIVE:
-        return new PositiveNode(oprand);
+        return new (arena) PositiveNode(oprand);
     default:
         throw InvalidException("unary operator");
     }
@@ -184,13 +186,13 @@ ExpressionNode *Expression::build_tree(int pre_precedence) {
             break;
 
         // Fetch the next token
-        auto [token, line] = token_processor_->next_token();
+        token_processor_->next_token();
 
         // Build the right node
         ExpressionNode *right = build_tree(get_rbp(operator_type));
 
         // Join the tree
-        left = binary_builder(operator_type, left, right);
+        left = binary_builder(*arena_, operator_type, left, right);
     }
 
     return left;
@@ -204,12 +206,12 @@ ExpressionNode *Expression::primary() {
     switch (token_processor_->peek_type()) {
     case TokenType::INT_LITERAL: {
         long long val = token_processor_->next_integer();
-        return new LiteralNode(int_literal_type(val), val);
+        return new (*arena_) LiteralNode(int_literal_type(val), val);
     }
     case TokenType::STRING_LITERAL: {
-        string str = token_processor_->next_string();
+        Symbol str = token_processor_->next_string();
         string_literals.insert({str, {}});
-        return new LiteralNode(
+        return new (*arena_) LiteralNode(
             TypeFactory::get_pointer(TypeFactory::get_char()), str);
     }
     case TokenType::IDENTIFIER: {
@@ -222,8 +224,8 @@ ExpressionNode *Expression::primary() {
         return node;
     }
     default: {
-        auto [type, line] = token_processor_->peek_token();
-        throw UnexpectedTokenException(type->type(), line,
+        throw UnexpectedTokenException(token_processor_->peek_type(),
+                                       token_processor_->current_location(),
                                        "primary expression");
     }
     }
@@ -235,26 +237,26 @@ ExpressionNode *Expression::prefix() {
     if (!is_prefix_operator(token_processor_->peek_type()))
         return nullptr;
 
-    auto [token, line] = token_processor_->next_token();
+    Token token = token_processor_->next_token();
     ExpressionNode *node = primary();
 
-    switch (token->type()) {
+    switch (token.type()) {
     case TokenType::STAR:
-        return unary_builder(ASTNodeType::DEREFERENCE, node);
+        return unary_builder(*arena_, ASTNodeType::DEREFERENCE, node);
     case TokenType::AND:
-        return unary_builder(ASTNodeType::ADDRESS, node);
+        return unary_builder(*arena_, ASTNodeType::ADDRESS, node);
     case TokenType::MINUS:
-        return unary_builder(ASTNodeType::NEGATIVE, node);
+        return unary_builder(*arena_, ASTNodeType::NEGATIVE, node);
     case TokenType::PLUS:
-        return unary_builder(ASTNodeType::POSITIVE, node);
+        return unary_builder(*arena_, ASTNodeType::POSITIVE, node);
     case TokenType::NOT:
-        return unary_builder(ASTNodeType::NOT, node);
+        return unary_builder(*arena_, ASTNodeType::NOT, node);
     case TokenType::INVERT:
-        return unary_builder(ASTNodeType::INVERT, node);
+        return unary_builder(*arena_, ASTNodeType::INVERT, node);
     case TokenType::INC:
-        return unary_builder(ASTNodeType::PRE_INC, node);
+        return unary_builder(*arena_, ASTNodeType::PRE_INC, node);
     case TokenType::DEC:
-        return unary_builder(ASTNodeType::PRE_DEC, node);
+        return unary_builder(*arena_, ASTNodeType::PRE_DEC, node);
     default:
         throw InvalidException("prefix operator");
     }
@@ -263,7 +265,7 @@ ExpressionNode *Expression::prefix() {
 }
 
 ExpressionNode *Expression::identifier() {
-    string str = token_processor_->next_identifier();
+    Symbol str = token_processor_->next_identifier();
 
     switch (token_processor_->peek_type()) {
     case TokenType::LPAREN: {
@@ -274,20 +276,20 @@ ExpressionNode *Expression::identifier() {
         vector<ExpressionNode *> arguments = parse_arguments();
         token_processor_->rparen();
 
-        return new FunctionCallNode(str, arguments);
+        return new (*arena_) FunctionCallNode(str, arena_->copy(arguments));
     }
     case TokenType::LBRACKET: {
         token_processor_->lbracket();
         ExpressionNode *node = build_tree(Expression::MAX_PRECEDENCE);
         token_processor_->rbracket();
-        return subscript_builder(str, node);
+        return subscript_builder(*arena_, str, node);
     }
     default: {
         if (ExpressionNode *postf = postfix(str); postf != nullptr)
             return postf;
         Variable *var = VariableManager::find(str);
 
-        return new VariableNode(var);
+        return new (*arena_) VariableNode(var);
     }
     }
 }
@@ -304,18 +306,19 @@ vector<ExpressionNode *> Expression::parse_arguments() {
     return arguments;
 }
 
-ExpressionNode *Expression::postfix(const string &identifier) {
+ExpressionNode *Expression::postfix(Symbol identifier) {
     if (!is_postfix_operator(token_processor_->peek_type()))
         return nullptr;
 
     Variable *var = VariableManager::find(identifier);
+    VariableNode *operand = new (*arena_) VariableNode(var);
 
-    auto [token, line] = token_processor_->next_token();
-    switch (token->type()) {
+    Token token = token_processor_->next_token();
+    switch (token.type()) {
     case TokenType::INC:
-        return new PostIncrementNode(new VariableNode(var));
+        return new (*arena_) PostIncrementNode(operand);
     case TokenType::DEC:
-        return new PostDecrementNode(new VariableNode(var));
+        return new (*arena_) PostDecrementNode(operand);
     default:
         throw InvalidException("postfix operator");
     }
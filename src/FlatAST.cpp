@@ -0,0 +1,235 @@
+#include "FlatAST.h"
+#include "Errors.h"
+
+namespace {
+using namespace myComp;
+
+bool is_binary(ASTNodeType kind) {
+    switch (kind) {
+    case ASTNodeType::ADD:
+    case ASTNodeType::SUBTRACT:
+    case ASTNodeType::MULTIPLY:
+    case ASTNodeType::DIVIDE:
+    case ASTNodeType::MODULO:
+    case ASTNodeType::EQUALS:
+    case ASTNodeType::NEQ:
+    case ASTNodeType::LESS:
+    case ASTNodeType::GREATER:
+    case ASTNodeType::LESS_EQ:
+    case ASTNodeType::GREATER_EQ:
+    case ASTNodeType::OR:
+    case ASTNodeType::LOGICAL_OR:
+    case ASTNodeType::AND:
+    case ASTNodeType::LOGICAL_AND:
+    case ASTNodeType::XOR:
+    case ASTNodeType::L_SHIFT:
+    case ASTNodeType::R_SHIFT:
+    case ASTNodeType::ASSIGN:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool is_unary(ASTNodeType kind) {
+    switch (kind) {
+    case ASTNodeType::ADDRESS:
+    case ASTNodeType::DEREFERENCE:
+    case ASTNodeType::INVERT:
+    case ASTNodeType::NOT:
+    case ASTNodeType::POST_INC:
+    case ASTNodeType::POST_DEC:
+    case ASTNodeType::PRE_INC:
+    case ASTNodeType::PRE_DEC:
+    case ASTNodeType::NEGATIVE:
+    case ASTNodeType::POSITIVE:
+        return true;
+    default:
+        return false;
+    }
+}
+} // namespace
+
+namespace myComp {
+FlatAST::Index FlatAST::add(ASTNodeType kind, const ASTNode_ *node) {
+    Node &n = nodes_.emplace_back();
+    n.kind = kind;
+
+    // Only expressions have a meaningful type
+    if (node->is_statement() &&
+        static_cast<const StatementNode *>(node)->is_expression()) {
+        auto *expression = static_cast<const ExpressionNode *>(node);
+        n.type = expression->type();
+        n.lvalue = expression->is_lvalue();
+    }
+    return static_cast<Index>(nodes_.size() - 1);
+}
+
+template <typename Range>
+void FlatAST::add_children(Index index, Range &&children) {
+    // Reserve the slots first, the children append their own
+    auto first = static_cast<Index>(children_.size());
+    auto count = static_cast<Index>(std::size(children));
+    children_.resize(first + count);
+    nodes_[index].first = first;
+    nodes_[index].count = count;
+
+    for (const ASTNode_ *child : children)
+        children_[first++] = convert(child);
+}
+
+void FlatAST::add_children(Index index,
+                           std::initializer_list<const ASTNode_ *> children) {
+    add_children<std::initializer_list<const ASTNode_ *> &>(index, children);
+}
+
+FlatAST::Index FlatAST::convert(const ASTNode_ *node) {
+    if (node == nullptr)
+        return NONE;
+
+    ASTNodeType kind = node->node_type();
+    Index index = add(kind, node);
+
+    switch (kind) {
+    case ASTNodeType::COMPOUND:
+        add_children(index,
+                     static_cast<const CodeBlockNode *>(node)->get_statements());
+        break;
+    case ASTNodeType::FUNCTION_DECLARATION: {
+        auto *function = static_cast<const FunctionDefinitionNode *>(node);
+        nodes_[index].function = function->get_prototype();
+        add_children(index, {function->get_code_block()});
+        break;
+    }
+    case ASTNodeType::VARIABLE_DECLARATION: {
+        auto *declaration = static_cast<const VariableDeclarationNode *>(node);
+        nodes_[index].variable = declaration->get_variable();
+        add_children(index, {declaration->get_initializer()});
+        break;
+    }
+    case ASTNodeType::IF: {
+        auto *if_node = static_cast<const IfNode *>(node);
+        add_children(index, {if_node->get_condition(), if_node->get_if_block(),
+                             if_node->get_else_block()});
+        break;
+    }
+    case ASTNodeType::WHILE: {
+        auto *while_node = static_cast<const WhileNode *>(node);
+        add_children(index,
+                     {while_node->get_condition(), while_node->get_code_block()});
+        break;
+    }
+    case ASTNodeType::FOR: {
+        auto *for_node = static_cast<const ForNode *>(node);
+        add_children(index,
+                     {for_node->get_initializer(), for_node->get_condition(),
+                      for_node->get_increment(), for_node->get_code_block()});
+        break;
+    }
+    case ASTNodeType::RETURN:
+        add_children(index,
+                     {static_cast<const ReturnNode *>(node)->get_expression()});
+        break;
+    case ASTNodeType::VARIABLE:
+        nodes_[index].variable =
+            static_cast<const VariableNode *>(node)->get_variable();
+        break;
+    case ASTNodeType::INT_LITERAL:
+        nodes_[index].value =
+            static_cast<const LiteralNode *>(node)->get_int_value();
+        break;
+    case ASTNodeType::STRING_LITERAL:
+        nodes_[index].symbol =
+            static_cast<const LiteralNode *>(node)->get_string_value().id();
+        break;
+    case ASTNodeType::FUNCTION_CALL: {
+        auto *call = static_cast<const FunctionCallNode *>(node);
+        nodes_[index].symbol = call->get_name().id();
+        add_children(index, call->get_arguments());
+        break;
+    }
+    default:
+        if (is_binary(kind)) {
+            auto *binary = static_cast<const BinaryExpressionNode *>(node);
+            nodes_[index].op = binary->get_op();
+            add_children(index, {binary->get_left(), binary->get_right()});
+        } else if (is_unary(kind)) {
+            auto *unary = static_cast<const UnaryExpressionNode *>(node);
+            nodes_[index].op = unary->get_op();
+            add_children(index, {unary->get_operand()});
+        } else {
+            throw UnreachableException(__func__);
+        }
+    }
+
+    return index;
+}
+
+void FlatAST::print(std::ostream &os, Index index, int indent) const {
+    const Node &n = nodes_[index];
+    std::span<const Index> kids = children(index);
+    std::string pad(indent, ' ');
+
+    switch (n.kind) {
+    case ASTNodeType::COMPOUND:
+        os << pad << "CodeBlock:\n";
+        for (Index child : kids)
+            print(os, child, indent + 2);
+        return;
+    case ASTNodeType::FUNCTION_DECLARATION:
+        os << pad << "FunctionDefinition: " << n.function->str() << "\n";
+        print(os, kids[0], indent);
+        return;
+    case ASTNodeType::VARIABLE_DECLARATION:
+        os << pad << "VariableDeclaration\n";
+        return;
+    case ASTNodeType::IF:
+        os << pad << "If:\n";
+        print(os, kids[0], indent + 2);
+        print(os, kids[1], indent + 2);
+        if (kids[2] != NONE) {
+            os << pad << "Else:\n";
+            print(os, kids[2], indent + 2);
+        }
+        return;
+    case ASTNodeType::WHILE:
+        os << pad << "While:\n";
+        for (Index child : kids)
+            print(os, child, indent + 2);
+        return;
+    case ASTNodeType::FOR:
+        os << pad << "For:\n";
+        for (Index child : kids)
+            print(os, child, indent + 2);
+        return;
+    case ASTNodeType::RETURN:
+        os << pad << "Return:\n";
+        print(os, kids[0], indent + 2);
+        return;
+    case ASTNodeType::VARIABLE:
+        os << pad << "Variable: " << n.variable->str() << "\n";
+        return;
+    case ASTNodeType::INT_LITERAL:
+        os << pad << "Literal: " << n.value << "\n";
+        return;
+    case ASTNodeType::STRING_LITERAL:
+        os << pad << "Literal: " << Symbol::from_id(n.symbol) << "\n";
+        return;
+    case ASTNodeType::FUNCTION_CALL:
+        os << pad << "FunctionCall: " << Symbol::from_id(n.symbol) << "\n";
+        for (Index child : kids)
+            print(os, child, indent + 2);
+        return;
+    default:
+        if (is_binary(n.kind)) {
+            os << pad << "BinaryExpression: " << n.op << "\n";
+        } else if (is_unary(n.kind)) {
+            os << pad << "UnaryExpression: " << n.op << "\n";
+        } else {
+            throw UnreachableException(__func__);
+        }
+        for (Index child : kids)
+            print(os, child, indent + 2);
+    }
+}
+} // namespace myComp
@@ -0,0 +1,165 @@
+#include <algorithm>
+
+#include "Errors.h"
+#include "IR.h"
+
+namespace {
+using namespace myComp;
+
+constexpr const char *op_names[] = {
+    "const", "string", "get", "set", "addr", "load", "store", "add",
+    "sub",   "mul",    "div", "mod", "and",  "or",   "xor",   "shl",
+    "shr",   "neg",    "not", "cast", "cmp", "call", "phi",   "jump",
+    "branch", "ret"};
+
+constexpr const char *cond_names[] = {"eq", "ne", "lt", "le", "gt", "ge"};
+
+void print_inst(std::ostream &os, const IRInst *inst) {
+    os << "  ";
+    if (inst->has_value())
+        os << '%' << inst->id << ": " << inst->type->str() << " = ";
+    os << op_names[static_cast<int>(inst->op)];
+
+    switch (inst->op) {
+    case IROp::CONST:
+        os << ' ' << inst->value;
+        break;
+    case IROp::STRING:
+        os << ' ' << inst->symbol;
+        break;
+    case IROp::GET:
+    case IROp::SET:
+    case IROp::ADDR:
+        os << ' ' << inst->variable->name;
+        break;
+    case IROp::CMP:
+        os << ' ' << cond_names[static_cast<int>(inst->cond)];
+        break;
+    case IROp::CALL:
+        os << ' ' << inst->function->name_;
+        break;
+    default:
+        break;
+    }
+
+    for (size_t i = 0; i < inst->operands.size(); i++) {
+        os << (i == 0 && inst->op != IROp::SET ? " " : ", ") << '%'
+           << inst->operands[i]->id;
+        if (inst->op == IROp::PHI)
+            os << " from bb" << inst->targets[i]->id;
+    }
+    if (inst->op != IROp::PHI) {
+        for (size_t i = 0; i < inst->targets.size(); i++) {
+            os << (i == 0 && inst->operands.empty() ? " " : ", ") << "bb"
+               << inst->targets[i]->id;
+        }
+    }
+    os << '\n';
+}
+} // namespace
+
+namespace myComp {
+IRBlock *IRFunction::new_block() { return &block_pool_.emplace_back(); }
+
+IRInst *IRFunction::new_inst(IROp op, Type *type) {
+    IRInst &inst = insts_.emplace_back();
+    inst.op = op;
+    inst.type = type;
+    inst.id = static_cast<int>(insts_.size()) - 1;
+    return &inst;
+}
+
+void IRFunction::clean() {
+    // Mark the blocks reachable from the entry
+    for (auto *block : blocks_)
+        block->id = -1;
+    std::vector<IRBlock *> worklist = {blocks_.front()};
+    blocks_.front()->id = 0;
+    while (!worklist.empty()) {
+        IRBlock *block = worklist.back();
+        worklist.pop_back();
+        for (auto *succ : block->successors()) {
+            if (succ->id == -1) {
+                succ->id = 0;
+                worklist.push_back(succ);
+            }
+        }
+    }
+    std::erase_if(blocks_, [](IRBlock *block) { return block->id == -1; });
+
+    // Number the blocks in layout order and recompute the predecessors
+    for (size_t i = 0; i < blocks_.size(); i++) {
+        blocks_[i]->id = static_cast<int>(i);
+        blocks_[i]->predecessors.clear();
+    }
+    for (auto *block : blocks_) {
+        for (auto *succ : block->successors())
+            succ->predecessors.push_back(block);
+    }
+
+    // Drop the phi inputs coming from removed blocks
+    for (auto *block : blocks_) {
+        for (auto *inst : block->insts) {
+            if (inst->op != IROp::PHI)
+                break;
+            for (size_t i = inst->targets.size(); i-- > 0;) {
+                if (inst->targets[i]->id == -1) {
+                    inst->targets.erase(inst->targets.begin() + i);
+                    inst->operands.erase(inst->operands.begin() + i);
+                }
+            }
+        }
+    }
+}
+
+void IRFunction::split_critical_edges() {
+    std::vector<IRBlock *> layout;
+    for (auto *block : blocks_) {
+        layout.push_back(block);
+        if (block->successors().size() < 2)
+            continue;
+        for (auto &succ : block->terminator()->targets) {
+            if (succ->insts.front()->op != IROp::PHI)
+                continue;
+
+            // The new block jumps to the successor and replaces `block` as
+            // its predecessor
+            IRBlock *edge = new_block();
+            IRInst *jump = new_inst(IROp::JUMP, TypeFactory::get_void());
+            jump->block = edge;
+            jump->targets.push_back(succ);
+            edge->insts.push_back(jump);
+            edge->predecessors.push_back(block);
+            std::replace(succ->predecessors.begin(), succ->predecessors.end(),
+                         block, edge);
+            for (auto *inst : succ->insts) {
+                if (inst->op != IROp::PHI)
+                    break;
+                std::replace(inst->targets.begin(), inst->targets.end(), block,
+                             edge);
+            }
+            succ = edge;
+            layout.push_back(edge);
+        }
+    }
+    blocks_ = std::move(layout);
+    for (size_t i = 0; i < blocks_.size(); i++)
+        blocks_[i]->id = static_cast<int>(i);
+}
+
+void IRFunction::print(std::ostream &os) const {
+    os << "function " << prototype_->str() << "\n";
+    for (auto *block : blocks_) {
+        os << "bb" << block->id << ":";
+        if (!block->predecessors.empty()) {
+            os << "  ; preds";
+            for (auto *pred : block->predecessors)
+                os << " bb" << pred->id;
+        }
+        os << "\n";
+        for (auto *inst : block->insts)
+            print_inst(os, inst);
+    }
+    os << "\n";
+}
+} // namespace myComp
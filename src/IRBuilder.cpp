@@ -0,0 +1,464 @@
+#include <algorithm>
+#include <bit>
+#include <source_location>
+
+#include "Errors.h"
+#include "IRBuilder.h"
+
+namespace {
+using namespace myComp;
+
+// Type of the index added to a pointer
+Type *index_type() { return TypeFactory::get_signed(8); }
+
+int pointee_size(Type *pointer) {
+    return static_cast<int>(
+        static_cast<PointerType *>(pointer)->pointee()->size());
+}
+} // namespace
+
+namespace myComp {
+std::unique_ptr<IRFunction>
+IRBuilder::build(const FunctionDefinitionNode *node) {
+    FunctionPrototype *prototype = node->get_prototype();
+    auto function = std::make_unique<IRFunction>(prototype);
+    function_ = function.get();
+
+    // Locals are the variables in scope minus the parameters
+    function->locals() =
+        VariableManager::get_variables_in_scope(prototype->name_);
+    for (auto *param : prototype->parameters_)
+        std::erase(function->locals(), param);
+
+    start(function->new_block());
+    block(node->get_code_block());
+
+    // Falling off the end returns nothing
+    if (current_->terminator() == nullptr)
+        emit(IROp::RET, TypeFactory::get_void(), {});
+
+    function->clean();
+    function->split_critical_edges();
+
+    function_ = nullptr;
+    current_ = nullptr;
+    return function;
+}
+
+void IRBuilder::block(const CodeBlockNode *node) {
+    for (auto *statement : node->get_statements())
+        this->statement(statement);
+}
+
+void IRBuilder::statement(const StatementNode *node) {
+    switch (node->node_type()) {
+    case ASTNodeType::VARIABLE_DECLARATION:
+        // Initialization on declaration is not supported yet
+        return;
+    case ASTNodeType::IF: {
+        auto *if_node = static_cast<const IfNode *>(node);
+        IRBlock *then_block = function_->new_block();
+        IRBlock *else_block = if_node->get_else_block() == nullptr
+                                  ? nullptr
+                                  : function_->new_block();
+        IRBlock *end_block = function_->new_block();
+
+        condition(if_node->get_condition(), then_block,
+                  else_block == nullptr ? end_block : else_block);
+        start(then_block);
+        block(if_node->get_if_block());
+        jump(end_block);
+        if (else_block != nullptr) {
+            start(else_block);
+            block(if_node->get_else_block());
+            jump(end_block);
+        }
+        start(end_block);
+        return;
+    }
+    case ASTNodeType::WHILE: {
+        auto *while_node = static_cast<const WhileNode *>(node);
+        IRBlock *condition_block = function_->new_block();
+        IRBlock *body_block = function_->new_block();
+        IRBlock *end_block = function_->new_block();
+
+        jump(condition_block);
+        start(condition_block);
+        condition(while_node->get_condition(), body_block, end_block);
+        start(body_block);
+        block(while_node->get_code_block());
+        jump(condition_block);
+        start(end_block);
+        return;
+    }
+    case ASTNodeType::FOR: {
+        auto *for_node = static_cast<const ForNode *>(node);
+        IRBlock *condition_block = function_->new_block();
+        IRBlock *body_block = function_->new_block();
+        IRBlock *end_block = function_->new_block();
+
+        expression(for_node->get_initializer());
+        jump(condition_block);
+        start(condition_block);
+        condition(for_node->get_condition(), body_block, end_block);
+        start(body_block);
+        block(for_node->get_code_block());
+        expression(for_node->get_increment());
+        jump(condition_block);
+        start(end_block);
+        return;
+    }
+    case ASTNodeType::RETURN: {
+        auto *return_node = static_cast<const ReturnNode *>(node);
+        IRInst *value = expression(return_node->get_expression());
+        emit(IROp::RET, TypeFactory::get_void(),
+             {cast(value, function_->prototype()->return_type_)});
+
+        // The statements after a return are unreachable
+        start(function_->new_block());
+        return;
+    }
+    default:
+        expression(static_cast<const ExpressionNode *>(node));
+        return;
+    }
+}
+
+IRInst *IRBuilder::expression(const ExpressionNode *node) {
+    switch (node->node_type()) {
+    case ASTNodeType::ADD:
+    case ASTNodeType::SUBTRACT: {
+        auto *binary_node = static_cast<const BinaryExpressionNode *>(node);
+        IROp op =
+            node->node_type() == ASTNodeType::ADD ? IROp::ADD : IROp::SUB;
+        if (binary_node->get_left()->type()->is_pointer())
+            return pointer_offset(binary_node, op);
+        return binary(binary_node, op);
+    }
+    case ASTNodeType::MULTIPLY:
+        return binary(static_cast<const BinaryExpressionNode *>(node),
+                      IROp::MUL);
+    case ASTNodeType::DIVIDE:
+        return binary(static_cast<const BinaryExpressionNode *>(node),
+                      IROp::DIV);
+    case ASTNodeType::MODULO:
+        return binary(static_cast<const BinaryExpressionNode *>(node),
+                      IROp::MOD);
+    case ASTNodeType::AND:
+        return binary(static_cast<const BinaryExpressionNode *>(node),
+                      IROp::AND);
+    case ASTNodeType::OR:
+        return binary(static_cast<const BinaryExpressionNode *>(node),
+                      IROp::OR);
+    case ASTNodeType::XOR:
+        return binary(static_cast<const BinaryExpressionNode *>(node),
+                      IROp::XOR);
+    case ASTNodeType::L_SHIFT:
+    case ASTNodeType::R_SHIFT: {
+        // The count keeps its own promoted type
+        auto *shift = static_cast<const BinaryExpressionNode *>(node);
+        IRInst *left = cast(expression(shift->get_left()), node->type());
+        IRInst *right = expression(shift->get_right());
+        right = cast(right, integer_promotion(right->type));
+        return emit(node->node_type() == ASTNodeType::L_SHIFT ? IROp::SHL
+                                                              : IROp::SHR,
+                    node->type(), {left, right});
+    }
+    case ASTNodeType::EQUALS:
+        return compare(static_cast<const BinaryExpressionNode *>(node),
+                       IRCond::EQ);
+    case ASTNodeType::NEQ:
+        return compare(static_cast<const BinaryExpressionNode *>(node),
+                       IRCond::NE);
+    case ASTNodeType::LESS:
+        return compare(static_cast<const BinaryExpressionNode *>(node),
+                       IRCond::LT);
+    case ASTNodeType::LESS_EQ:
+        return compare(static_cast<const BinaryExpressionNode *>(node),
+                       IRCond::LE);
+    case ASTNodeType::GREATER:
+        return compare(static_cast<const BinaryExpressionNode *>(node),
+                       IRCond::GT);
+    case ASTNodeType::GREATER_EQ:
+        return compare(static_cast<const BinaryExpressionNode *>(node),
+                       IRCond::GE);
+    case ASTNodeType::LOGICAL_AND:
+    case ASTNodeType::LOGICAL_OR:
+        return logical(static_cast<const BinaryExpressionNode *>(node));
+    case ASTNodeType::NOT: {
+        IRInst *operand = expression(
+            static_cast<const UnaryExpressionNode *>(node)->get_operand());
+        IRInst *result = emit(IROp::CMP, node->type(),
+                              {operand, constant(operand->type, 0)});
+        result->cond = IRCond::EQ;
+        return result;
+    }
+    case ASTNodeType::NEGATIVE:
+    case ASTNodeType::INVERT: {
+        IRInst *operand = expression(
+            static_cast<const UnaryExpressionNode *>(node)->get_operand());
+        return emit(node->node_type() == ASTNodeType::NEGATIVE ? IROp::NEG
+                                                               : IROp::NOT,
+                    node->type(), {cast(operand, node->type())});
+    }
+    case ASTNodeType::POSITIVE:
+        return cast(expression(static_cast<const UnaryExpressionNode *>(node)
+                                   ->get_operand()),
+                    node->type());
+    case ASTNodeType::POST_INC:
+        return step(static_cast<const UnaryExpressionNode *>(node), 1, true);
+    case ASTNodeType::POST_DEC:
+        return step(static_cast<const UnaryExpressionNode *>(node), -1, true);
+    case ASTNodeType::PRE_INC:
+        return step(static_cast<const UnaryExpressionNode *>(node), 1, false);
+    case ASTNodeType::PRE_DEC:
+        return step(static_cast<const UnaryExpressionNode *>(node), -1, false);
+    case ASTNodeType::ADDRESS: {
+        auto *operand =
+            static_cast<const UnaryExpressionNode *>(node)->get_operand();
+        if (operand->node_type() == ASTNodeType::VARIABLE) {
+            IRInst *address = emit(IROp::ADDR, node->type(), {});
+            address->variable =
+                static_cast<const VariableNode *>(operand)->get_variable();
+            return address;
+        }
+        // The address of *p is p
+        return expression(
+            static_cast<const UnaryExpressionNode *>(operand)->get_operand());
+    }
+    case ASTNodeType::DEREFERENCE: {
+        IRInst *address = expression(
+            static_cast<const UnaryExpressionNode *>(node)->get_operand());
+        return emit(IROp::LOAD, node->type(), {address});
+    }
+    case ASTNodeType::ASSIGN: {
+        auto *assign = static_cast<const BinaryExpressionNode *>(node);
+        IRInst *value = cast(expression(assign->get_right()), node->type());
+        auto *target = assign->get_left();
+        if (target->node_type() == ASTNodeType::DEREFERENCE) {
+            IRInst *address = expression(
+                static_cast<const UnaryExpressionNode *>(target)
+                    ->get_operand());
+            emit(IROp::STORE, TypeFactory::get_void(), {address, value});
+        } else {
+            IRInst *set = emit(IROp::SET, TypeFactory::get_void(), {value});
+            set->variable =
+                static_cast<const VariableNode *>(target)->get_variable();
+        }
+        return value;
+    }
+    case ASTNodeType::VARIABLE: {
+        // An array is converted to the address of its first element
+        Variable *variable =
+            static_cast<const VariableNode *>(node)->get_variable();
+        IRInst *inst =
+            emit(variable->type->is_array() ? IROp::ADDR : IROp::GET,
+                 node->type(), {});
+        inst->variable = variable;
+        return inst;
+    }
+    case ASTNodeType::INT_LITERAL:
+        return constant(
+            node->type(),
+            static_cast<const LiteralNode *>(node)->get_int_value());
+    case ASTNodeType::STRING_LITERAL: {
+        IRInst *inst = emit(IROp::STRING, node->type(), {});
+        inst->symbol =
+            static_cast<const LiteralNode *>(node)->get_string_value();
+        return inst;
+    }
+    case ASTNodeType::FUNCTION_CALL:
+        return call(static_cast<const FunctionCallNode *>(node));
+    default:
+        throw UnreachableException(
+            std::source_location::current().function_name());
+    }
+}
+
+void IRBuilder::condition(const ExpressionNode *node, IRBlock *if_true,
+                          IRBlock *if_false) {
+    switch (node->node_type()) {
+    case ASTNodeType::LOGICAL_AND:
+    case ASTNodeType::LOGICAL_OR: {
+        // The right side is only tested when the left one does not decide
+        auto *logical_node = static_cast<const BinaryExpressionNode *>(node);
+        IRBlock *right_block = function_->new_block();
+        if (node->node_type() == ASTNodeType::LOGICAL_AND)
+            condition(logical_node->get_left(), right_block, if_false);
+        else
+            condition(logical_node->get_left(), if_true, right_block);
+        start(right_block);
+        condition(logical_node->get_right(), if_true, if_false);
+        return;
+    }
+    case ASTNodeType::NOT:
+        condition(static_cast<const UnaryExpressionNode *>(node)->get_operand(),
+                  if_false, if_true);
+        return;
+    default:
+        branch(expression(node), if_true, if_false);
+        return;
+    }
+}
+
+IRInst *IRBuilder::binary(const BinaryExpressionNode *node, IROp op) {
+    IRInst *left = cast(expression(node->get_left()), node->type());
+    IRInst *right = cast(expression(node->get_right()), node->type());
+    return emit(op, node->type(), {left, right});
+}
+
+IRInst *IRBuilder::compare(const BinaryExpressionNode *node, IRCond cond) {
+    IRInst *left = expression(node->get_left());
+    IRInst *right = expression(node->get_right());
+
+    // Pointers are compared as they are, a null constant takes the type of
+    // the other side
+    Type *common = left->type;
+    if (left->type->is_arithmetic() && right->type->is_arithmetic())
+        common = usual_arithmetic_conversion(left->type, right->type);
+    IRInst *result = emit(IROp::CMP, node->type(),
+                          {cast(left, common), cast(right, common)});
+    result->cond = cond;
+    return result;
+}
+
+IRInst *IRBuilder::pointer_offset(const BinaryExpressionNode *node, IROp op) {
+    IRInst *left = expression(node->get_left());
+    IRInst *right = expression(node->get_right());
+    int size = pointee_size(left->type);
+
+    // Pointer difference, in elements, the division is exact so a power of
+    // two is a shift
+    if (right->type->is_pointer()) {
+        IRInst *difference = emit(IROp::SUB, node->type(), {left, right});
+        if (size == 1)
+            return difference;
+        auto bytes = static_cast<unsigned>(size);
+        if (std::has_single_bit(bytes)) {
+            return emit(IROp::SHR, node->type(),
+                        {difference,
+                         constant(node->type(), std::countr_zero(bytes))});
+        }
+        return emit(IROp::DIV, node->type(),
+                    {difference, constant(node->type(), size)});
+    }
+
+    // Pointer plus or minus an integer, scaled by the pointee size, a constant
+    // index is a constant offset
+    IRInst *offset = cast(right, index_type());
+    if (offset->op == IROp::CONST) {
+        offset = constant(index_type(),
+                          static_cast<long long>(
+                              static_cast<unsigned long long>(offset->value) *
+                              static_cast<unsigned long long>(size)));
+    } else if (size != 1) {
+        offset = emit(IROp::MUL, index_type(),
+                      {offset, constant(index_type(), size)});
+    }
+    return emit(op, node->type(), {left, offset});
+}
+
+IRInst *IRBuilder::step(const UnaryExpressionNode *node, int direction,
+                        bool post) {
+    Variable *variable =
+        static_cast<const VariableNode *>(node->get_operand())->get_variable();
+    Type *type = node->type();
+
+    // A pointer moves by one element
+    Type *amount_type = type->is_pointer() ? index_type() : type;
+    long long amount = type->is_pointer() ? pointee_size(type) : 1;
+
+    IRInst *old_value = emit(IROp::GET, type, {});
+    old_value->variable = variable;
+    IRInst *new_value = emit(direction > 0 ? IROp::ADD : IROp::SUB, type,
+                             {old_value, constant(amount_type, amount)});
+    IRInst *set = emit(IROp::SET, TypeFactory::get_void(), {new_value});
+    set->variable = variable;
+    return post ? old_value : new_value;
+}
+
+IRInst *IRBuilder::logical(const BinaryExpressionNode *node) {
+    // Test the expression as a condition, then merge 1 and 0
+    IRBlock *true_block = function_->new_block();
+    IRBlock *false_block = function_->new_block();
+    IRBlock *end_block = function_->new_block();
+    condition(node, true_block, false_block);
+
+    start(true_block);
+    IRInst *one = constant(node->type(), 1);
+    jump(end_block);
+    start(false_block);
+    IRInst *zero = constant(node->type(), 0);
+    jump(end_block);
+
+    start(end_block);
+    IRInst *phi = emit(IROp::PHI, node->type(), {one, zero});
+    phi->targets = {true_block, false_block};
+    return phi;
+}
+
+IRInst *IRBuilder::call(const FunctionCallNode *node) {
+    FunctionPrototype *prototype = FunctionManager::find(node->get_name());
+    auto arguments = node->get_arguments();
+    if (arguments.size() > prototype->parameters_.size() &&
+        !prototype->is_variadic_) {
+        throw SyntaxException("too many arguments to function call");
+    }
+
+    // Arguments are evaluated from the last one, and converted to the type of
+    // their parameter, the variadic ones are promoted
+    std::vector<IRInst *> values(arguments.size());
+    for (size_t i = arguments.size(); i-- > 0;) {
+        values[i] = expression(arguments[i]);
+        if (i < prototype->parameters_.size())
+            values[i] = cast(values[i], prototype->parameters_[i]->type);
+        else if (values[i]->type->is_arithmetic())
+            values[i] = cast(values[i], integer_promotion(values[i]->type));
+    }
+
+    IRInst *inst = emit(IROp::CALL, prototype->return_type_, {});
+    inst->operands = std::move(values);
+    inst->function = prototype;
+    return inst->has_value() ? inst : nullptr;
+}
+
+IRInst *IRBuilder::emit(IROp op, Type *type,
+                        std::initializer_list<IRInst *> operands) {
+    IRInst *inst = function_->new_inst(op, type);
+    inst->operands = operands;
+    inst->block = current_;
+    current_->insts.push_back(inst);
+    return inst;
+}
+
+IRInst *IRBuilder::constant(Type *type, long long value) {
+    IRInst *inst = emit(IROp::CONST, type, {});
+    inst->value = value;
+    return inst;
+}
+
+IRInst *IRBuilder::cast(IRInst *value, Type *type) {
+    if (value->type == type)
+        return value;
+    // A constant is converted now, so that its users see its value
+    if (value->op == IROp::CONST)
+        return constant(type, normalize(value->value, type));
+    return emit(IROp::CAST, type, {value});
+}
+
+void IRBuilder::jump(IRBlock *target) {
+    IRInst *inst = emit(IROp::JUMP, TypeFactory::get_void(), {});
+    inst->targets = {target};
+}
+
+void IRBuilder::branch(IRInst *condition, IRBlock *if_true,
+                       IRBlock *if_false) {
+    IRInst *inst = emit(IROp::BRANCH, TypeFactory::get_void(), {condition});
+    inst->targets = {if_true, if_false};
+}
+
+void IRBuilder::start(IRBlock *block) {
+    function_->blocks().push_back(block);
+    current_ = block;
+}
+} // namespace myComp
@@ -0,0 +1,501 @@
+#include <cstdint>
+#include <source_location>
+
+#include "Errors.h"
+#include "IRLowering.h"
+
+namespace {
+using namespace myComp;
+
+// Operations of the code generator for the binary instructions
+using BinaryMethod = int (CodeGenerator::*)(int, int, Type *);
+
+BinaryMethod binary_method(IROp op) {
+    switch (op) {
+    case IROp::ADD:
+        return &CodeGenerator::add;
+    case IROp::SUB:
+        return &CodeGenerator::subtract;
+    case IROp::MUL:
+        return &CodeGenerator::multiply;
+    case IROp::DIV:
+        return &CodeGenerator::divide;
+    case IROp::MOD:
+        return &CodeGenerator::modulo;
+    case IROp::AND:
+        return &CodeGenerator::bitwise_and;
+    case IROp::OR:
+        return &CodeGenerator::bitwise_or;
+    case IROp::XOR:
+        return &CodeGenerator::bitwise_xor;
+    case IROp::SHL:
+        return &CodeGenerator::left_shift;
+    case IROp::SHR:
+        return &CodeGenerator::right_shift;
+    default:
+        throw UnreachableException(
+            std::source_location::current().function_name());
+    }
+}
+
+BinaryMethod compare_method(IRCond cond) {
+    switch (cond) {
+    case IRCond::EQ:
+        return &CodeGenerator::compare_equal;
+    case IRCond::NE:
+        return &CodeGenerator::compare_not_equal;
+    case IRCond::LT:
+        return &CodeGenerator::compare_less;
+    case IRCond::LE:
+        return &CodeGenerator::compare_less_equal;
+    case IRCond::GT:
+        return &CodeGenerator::compare_greater;
+    case IRCond::GE:
+        return &CodeGenerator::compare_greater_equal;
+    default:
+        throw UnreachableException(
+            std::source_location::current().function_name());
+    }
+}
+
+Comparison relation(IRCond cond) {
+    switch (cond) {
+    case IRCond::EQ:
+        return Comparison::EQUAL;
+    case IRCond::NE:
+        return Comparison::NOT_EQUAL;
+    case IRCond::LT:
+        return Comparison::LESS;
+    case IRCond::LE:
+        return Comparison::LESS_EQUAL;
+    case IRCond::GT:
+        return Comparison::GREATER;
+    case IRCond::GE:
+        return Comparison::GREATER_EQUAL;
+    default:
+        throw UnreachableException(
+            std::source_location::current().function_name());
+    }
+}
+
+// The relation that holds when `relation` does not
+Comparison inverse(Comparison relation) {
+    switch (relation) {
+    case Comparison::EQUAL:
+        return Comparison::NOT_EQUAL;
+    case Comparison::NOT_EQUAL:
+        return Comparison::EQUAL;
+    case Comparison::LESS:
+        return Comparison::GREATER_EQUAL;
+    case Comparison::LESS_EQUAL:
+        return Comparison::GREATER;
+    case Comparison::GREATER:
+        return Comparison::LESS_EQUAL;
+    case Comparison::GREATER_EQUAL:
+        return Comparison::LESS;
+    default:
+        throw UnreachableException(
+            std::source_location::current().function_name());
+    }
+}
+
+// The relation of the operands swapped
+Comparison swapped(Comparison relation) {
+    switch (relation) {
+    case Comparison::LESS:
+        return Comparison::GREATER;
+    case Comparison::LESS_EQUAL:
+        return Comparison::GREATER_EQUAL;
+    case Comparison::GREATER:
+        return Comparison::LESS;
+    case Comparison::GREATER_EQUAL:
+        return Comparison::LESS_EQUAL;
+    default:
+        return relation;
+    }
+}
+
+bool is_constant(const IRInst *inst, long long value) {
+    return inst->op == IROp::CONST && inst->value == value;
+}
+
+// Whether a multiplication is by a scale of an address
+bool is_scaling(const IRInst *inst) {
+    if (inst->op != IROp::MUL || inst->operands[0]->op == IROp::CONST)
+        return false;
+    const IRInst *scale = inst->operands[1];
+    return scale->op == IROp::CONST &&
+           (scale->value == 2 || scale->value == 4 || scale->value == 8);
+}
+} // namespace
+
+namespace myComp {
+void IRLowering::run(const IRFunction &function) {
+    const auto &blocks = function.blocks();
+
+    registers_.assign(function.num_insts(), -1);
+    uses_.assign(function.num_insts(), 0);
+    shared_.assign(function.num_insts(), false);
+    fused_.assign(function.num_insts(), false);
+    labels_.assign(blocks.size(), {});
+    for (auto *block : blocks) {
+        for (auto *inst : block->insts) {
+            for (auto *operand : inst->operands) {
+                uses_[operand->id]++;
+                if (inst->op == IROp::PHI || operand->block != block)
+                    shared_[operand->id] = true;
+            }
+        }
+    }
+    for (auto *block : blocks) {
+        const IRInst *terminator = block->terminator();
+        if (terminator->op != IROp::BRANCH)
+            continue;
+        const IRInst *condition = terminator->operands[0];
+        if (condition->op == IROp::CMP && uses_[condition->id] == 1 &&
+            block->insts.end()[-2] == condition)
+            fused_[condition->id] = true;
+    }
+    for (auto *block : blocks) {
+        for (size_t i = 1; i < block->insts.size(); i++) {
+            const IRInst *inst = block->insts[i];
+            const IRInst *scaled = block->insts[i - 1];
+            if (inst->op == IROp::ADD && is_scaling(scaled) &&
+                uses_[scaled->id] == 1 &&
+                (inst->operands[0] == scaled || inst->operands[1] == scaled))
+                fused_[scaled->id] = true;
+        }
+    }
+    for (auto *block : blocks) {
+        const auto &insts = block->insts;
+        for (size_t i = 0; i < insts.size(); i++) {
+            if (insts[i]->op != IROp::LOAD && insts[i]->op != IROp::STORE)
+                continue;
+            const IRInst *pointer = insts[i]->operands[0];
+            if (uses_[pointer->id] != 1)
+                continue;
+            if (pointer->op == IROp::ADDR) {
+                fused_[pointer->id] = true;
+                continue;
+            }
+            if (pointer->op != IROp::ADD || i == 0 || insts[i - 1] != pointer)
+                continue;
+            fused_[pointer->id] = true;
+            const IRInst *base = pointer->operands[0];
+            if (base->op == IROp::ADDR && uses_[base->id] == 1)
+                fused_[base->id] = true;
+        }
+    }
+
+    FunctionPrototype *prototype = function.prototype();
+    code_generator_->function_prelude(prototype);
+    code_generator_->load_parameters(prototype->parameters_);
+    code_generator_->allocate_local_variables(function.locals());
+
+    // Phi nodes are written before they are lowered when a loop jumps back
+    for (auto *block : blocks) {
+        for (auto *inst : block->insts) {
+            if (inst->op != IROp::PHI)
+                break;
+            registers_[inst->id] = code_generator_->allocate_register();
+        }
+    }
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        // Only a block entered by a jump needs a label
+        for (auto *pred : blocks[i]->predecessors) {
+            if (i == 0 || pred != blocks[i - 1]) {
+                code_generator_->add_label(label(blocks[i]));
+                break;
+            }
+        }
+
+        const IRBlock *next = i + 1 < blocks.size() ? blocks[i + 1] : nullptr;
+        for (auto *inst : blocks[i]->insts)
+            lower(inst, next);
+    }
+
+    code_generator_->function_postlude();
+}
+
+void IRLowering::lower(const IRInst *inst, const IRBlock *next) {
+    for (auto *operand : inst->operands)
+        uses_[operand->id]--;
+
+    int reg = -1;
+    switch (inst->op) {
+    case IROp::CONST:
+    case IROp::PHI:
+        // Constants are loaded by their users, phi nodes by the copies
+        return;
+    case IROp::STRING:
+        reg = code_generator_->load_string_literal(inst->symbol);
+        break;
+    case IROp::GET:
+        reg = code_generator_->load_variable(inst->variable);
+        break;
+    case IROp::SET:
+        code_generator_->move_register(use(inst->operands[0]),
+                                       inst->variable);
+        break;
+    case IROp::ADDR:
+        if (fused_[inst->id])
+            return;
+        reg = code_generator_->load_variable_address(inst->variable);
+        break;
+    case IROp::LOAD:
+        reg = code_generator_->load_from_memory(address(inst->operands[0]),
+                                                inst->type);
+        break;
+    case IROp::STORE:
+        code_generator_->move_register(use(inst->operands[1]),
+                                       address(inst->operands[0]),
+                                       inst->operands[1]->type);
+        break;
+    case IROp::MUL: {
+        // A multiplication by a constant is shifts, lea and additions, unless
+        // its addition scales it
+        if (fused_[inst->id])
+            return;
+        const IRInst *left = inst->operands[0];
+        const IRInst *right = inst->operands[1];
+        if (left->op == IROp::CONST && right->op != IROp::CONST)
+            std::swap(left, right);
+        if (right->op == IROp::CONST) {
+            reg = take(left);
+            code_generator_->immediate_multiply(reg, right->value, inst->type);
+            break;
+        }
+        reg = code_generator_->multiply(take(inst->operands[0]),
+                                        use(inst->operands[1]), inst->type);
+        break;
+    }
+    case IROp::ADD: {
+        // base + index * scale is a single lea
+        if (fused_[inst->id])
+            return;
+        const IRInst *left = inst->operands[0];
+        const IRInst *right = inst->operands[1];
+        if (fused_[left->id])
+            std::swap(left, right);
+        if (fused_[right->id]) {
+            reg = code_generator_->add_scaled(
+                use(left), use(right->operands[0]),
+                static_cast<int>(right->operands[1]->value), inst->type);
+            break;
+        }
+        reg = code_generator_->add(take(left), use(right), inst->type);
+        break;
+    }
+    case IROp::SUB:
+    case IROp::DIV:
+    case IROp::MOD:
+    case IROp::AND:
+    case IROp::OR:
+    case IROp::XOR:
+    case IROp::SHL:
+    case IROp::SHR: {
+        // Dividing by a constant is multiplying by its reciprocal
+        const IRInst *right_value = inst->operands[1];
+        if ((inst->op == IROp::DIV || inst->op == IROp::MOD) &&
+            right_value->op == IROp::CONST && right_value->value != 0) {
+            int left = take(inst->operands[0]);
+            reg = inst->op == IROp::DIV
+                      ? code_generator_->immediate_divide(
+                            left, right_value->value, inst->type)
+                      : code_generator_->immediate_modulo(
+                            left, right_value->value, inst->type);
+            break;
+        }
+        int left = take(inst->operands[0]);
+        int right = use(inst->operands[1]);
+        reg = (code_generator_->*binary_method(inst->op))(left, right,
+                                                          inst->type);
+        break;
+    }
+    case IROp::NEG:
+        reg = code_generator_->negate(take(inst->operands[0]), inst->type);
+        break;
+    case IROp::NOT:
+        reg = code_generator_->bitwise_not(take(inst->operands[0]),
+                                           inst->type);
+        break;
+    case IROp::CAST:
+        reg = take(inst->operands[0]);
+        code_generator_->type_cast(reg, inst->operands[0]->type, inst->type);
+        break;
+    case IROp::CMP: {
+        if (fused_[inst->id])
+            return;
+        Type *type = inst->operands[0]->type;
+        if (inst->cond == IRCond::EQ && is_constant(inst->operands[1], 0)) {
+            reg = code_generator_->logical_not(take(inst->operands[0]), type);
+            break;
+        }
+        int left = take(inst->operands[0]);
+        int right = use(inst->operands[1]);
+        reg = (code_generator_->*compare_method(inst->cond))(left, right, type);
+        break;
+    }
+    case IROp::CALL: {
+        int num_args = static_cast<int>(inst->operands.size());
+        for (int i = 0; i < num_args; i++)
+            code_generator_->move_to_argument(use(inst->operands[i]), i + 1);
+        reg = code_generator_->call_function(inst->function, num_args);
+        break;
+    }
+    case IROp::JUMP:
+        copy_phis(inst->block, inst->targets[0]);
+        if (inst->targets[0] != next)
+            code_generator_->jump(label(inst->targets[0]));
+        break;
+    case IROp::BRANCH:
+        branch(inst, next);
+        break;
+    case IROp::RET:
+        if (!inst->operands.empty())
+            code_generator_->return_from_function(use(inst->operands[0]));
+        else if (next != nullptr)
+            code_generator_->return_from_function();
+        break;
+    }
+    registers_[inst->id] = reg;
+}
+
+void IRLowering::branch(const IRInst *inst, const IRBlock *next) {
+    const IRInst *condition = inst->operands[0];
+    const IRBlock *if_true = inst->targets[0];
+    const IRBlock *if_false = inst->targets[1];
+    if (if_true == next) {
+        jump_if(condition, false, if_false);
+    } else if (if_false == next) {
+        jump_if(condition, true, if_true);
+    } else {
+        jump_if(condition, false, if_false);
+        code_generator_->jump(label(if_true));
+    }
+}
+
+void IRLowering::jump_if(const IRInst *condition, bool sense,
+                         const IRBlock *target) {
+    if (!fused_[condition->id]) {
+        int reg = use(condition);
+        if (sense)
+            code_generator_->jump_on_non_zero(reg, condition->type,
+                                              label(target));
+        else
+            code_generator_->jump_on_zero(reg, condition->type, label(target));
+        return;
+    }
+
+    const IRInst *left = condition->operands[0];
+    const IRInst *right = condition->operands[1];
+    Type *type = left->type;
+    Comparison compare = relation(condition->cond);
+    if (!sense)
+        compare = inverse(compare);
+
+    // An immediate operand goes on the right
+    if (left->op == IROp::CONST && right->op != IROp::CONST) {
+        std::swap(left, right);
+        compare = swapped(compare);
+    }
+    if (right->op == IROp::CONST) {
+        code_generator_->jump_on_compare_immediate(
+            use(left), right->value, type, compare, label(target));
+    } else {
+        code_generator_->jump_on_compare(use(left), use(right), type, compare,
+                                         label(target));
+    }
+}
+
+int IRLowering::use(const IRInst *value) {
+    if (value->op == IROp::CONST)
+        return code_generator_->load_immediate(value->value);
+    if (registers_[value->id] == -1)
+        throw LogicException("IR value used before its definition");
+    return registers_[value->id];
+}
+
+int IRLowering::take(const IRInst *value) {
+    int reg = use(value);
+    if (value->op == IROp::CONST ||
+        (uses_[value->id] == 0 && !shared_[value->id]))
+        return reg;
+    return code_generator_->duplicate_register(reg);
+}
+
+MemoryAddress IRLowering::address(const IRInst *pointer) {
+    MemoryAddress address;
+    if (!fused_[pointer->id]) {
+        address.base = use(pointer);
+        return address;
+    }
+
+    // A variable or a register, plus a displacement or a scaled index
+    const IRInst *base = pointer;
+    if (pointer->op == IROp::ADD) {
+        base = pointer->operands[0];
+        const IRInst *offset = pointer->operands[1];
+        if (offset->op == IROp::CONST &&
+            offset->value == static_cast<int32_t>(offset->value)) {
+            address.disp = offset->value;
+        } else if (fused_[offset->id]) {
+            address.index = use(offset->operands[0]);
+            address.scale = static_cast<int>(offset->operands[1]->value);
+        } else {
+            address.index = use(offset);
+        }
+    }
+    if (fused_[base->id]) {
+        address.variable = base->variable;
+    } else {
+        address.base = use(base);
+    }
+    return address;
+}
+
+void IRLowering::copy_phis(const IRBlock *from, const IRBlock *to) {
+    // Whether a phi node reads another one that may be written first, only
+    // those reads go through temporaries
+    bool temporaries = false;
+    for (auto *inst : to->insts) {
+        if (inst->op != IROp::PHI)
+            break;
+        for (auto *operand : inst->operands)
+            temporaries |= operand->op == IROp::PHI && operand->block == to;
+    }
+
+    // Constants are written last, nothing reads them
+    std::vector<std::pair<int, int>> copies;
+    std::vector<std::pair<int, long long>> constants;
+    for (auto *inst : to->insts) {
+        if (inst->op != IROp::PHI)
+            break;
+        for (size_t i = 0; i < inst->targets.size(); i++) {
+            if (inst->targets[i] != from)
+                continue;
+            const IRInst *value = inst->operands[i];
+            if (value->op == IROp::CONST) {
+                constants.emplace_back(registers_[inst->id], value->value);
+                continue;
+            }
+            int reg = use(value);
+            if (temporaries && value->op == IROp::PHI && value->block == to)
+                reg = code_generator_->duplicate_register(reg);
+            copies.emplace_back(registers_[inst->id], reg);
+        }
+    }
+    for (auto [phi, reg] : copies)
+        code_generator_->copy_register(phi, reg);
+    for (auto [phi, value] : constants)
+        code_generator_->move_immediate(phi, value);
+}
+
+const std::string &IRLowering::label(const IRBlock *block) {
+    std::string &label = labels_[block->id];
+    if (label.empty())
+        label = code_generator_->allocate_label();
+    return label;
+}
+} // namespace myComp
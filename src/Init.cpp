@@ -4,10 +4,19 @@
 
 namespace myComp {
 void Init::init() {
-    Context::push("global");
+    Context::push(Context::global());
 
     code_generator = new X86_CodeGenerator();
 }
 
-void Init::end() { delete code_generator; }
+void Init::end() {
+    delete code_generator;
+    code_generator = nullptr;
+
+    // What a translation unit declared, so that the next one starts afresh
+    string_literals.clear();
+    FunctionManager::clear();
+    VariableManager::clear();
+    Context::clear();
+}
 } // namespace myComp
\ No newline at end of file
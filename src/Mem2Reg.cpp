@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <unordered_set>
+
+#include "Mem2Reg.h"
+
+namespace myComp {
+void Mem2Reg::run(IRFunction &function) {
+    function_ = &function;
+    const auto &blocks = function.blocks();
+
+    // Scalars whose address is never taken
+    std::unordered_set<Variable *> taken;
+    for (auto *block : blocks) {
+        for (auto *inst : block->insts) {
+            if (inst->op == IROp::ADDR)
+                taken.insert(inst->variable);
+        }
+    }
+    variables_.clear();
+    indices_.clear();
+    auto consider = [&](Variable *var) {
+        if (var->type->is_array())
+            return;
+        candidates_++;
+        if (taken.contains(var))
+            return;
+        indices_[var] = static_cast<int>(variables_.size());
+        variables_.push_back(var);
+    };
+    for (auto *param : function.prototype()->parameters_)
+        consider(param);
+    for (auto *local : function.locals())
+        consider(local);
+    if (variables_.empty()) {
+        function_ = nullptr;
+        return;
+    }
+    promoted_ += variables_.size();
+
+    // Promoted locals need no stack slot
+    std::erase_if(function.locals(),
+                  [this](Variable *var) { return indices_.contains(var); });
+
+    size_t count = variables_.size();
+    entry_.assign(blocks.size() * count, nullptr);
+    exit_.assign(blocks.size() * count, nullptr);
+    initial_.assign(count, nullptr);
+    replacements_.assign(function.num_insts(), nullptr);
+    created_.assign(blocks.size(), {});
+
+    // The last value assigned to each variable in each block, converted to
+    // the type of the variable as the store would have
+    for (auto *block : blocks) {
+        std::vector<IRInst *> insts;
+        for (auto *inst : block->insts) {
+            if (inst->op == IROp::SET && indices_.contains(inst->variable)) {
+                int var = indices_[inst->variable];
+                IRInst *value = inst->operands[0];
+                if (value->type != inst->variable->type) {
+                    IRInst *cast =
+                        function.new_inst(IROp::CAST, inst->variable->type);
+                    cast->operands = {value};
+                    cast->block = block;
+                    insts.push_back(cast);
+                    inst->operands[0] = cast;
+                }
+                exit_[block->id * count + var] = inst->operands[0];
+            }
+            insts.push_back(inst);
+        }
+        block->insts = std::move(insts);
+    }
+
+    // Replace every read with the value reaching it, drop the accesses
+    std::vector<IRInst *> current(count);
+    for (auto *block : blocks) {
+        std::fill(current.begin(), current.end(), nullptr);
+        std::vector<IRInst *> insts;
+        for (auto *inst : block->insts) {
+            if ((inst->op != IROp::GET && inst->op != IROp::SET) ||
+                !indices_.contains(inst->variable)) {
+                insts.push_back(inst);
+                continue;
+            }
+            int var = indices_[inst->variable];
+            if (inst->op == IROp::SET) {
+                current[var] = inst->operands[0];
+                continue;
+            }
+            IRInst *value =
+                current[var] != nullptr ? current[var] : read_entry(block, var);
+            if (inst->type != variables_[var]->type) {
+                IRInst *cast = function.new_inst(IROp::CAST, inst->type);
+                cast->operands = {value};
+                cast->block = block;
+                insts.push_back(cast);
+                value = cast;
+            }
+            replacements_[inst->id] = value;
+        }
+        block->insts = std::move(insts);
+    }
+
+    // A phi node whose inputs are itself and one other value is that value
+    replacements_.resize(function.num_insts(), nullptr);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto &phis : created_) {
+            for (auto *phi : phis) {
+                if (replacements_[phi->id] != nullptr)
+                    continue;
+                IRInst *same = nullptr;
+                bool trivial = true;
+                for (auto *operand : phi->operands) {
+                    operand = find(operand);
+                    if (operand == phi || operand == same)
+                        continue;
+                    if (same != nullptr) {
+                        trivial = false;
+                        break;
+                    }
+                    same = operand;
+                }
+                if (trivial && same != nullptr) {
+                    replacements_[phi->id] = same;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // Put the phi nodes left and the initial values in their blocks, and make
+    // the operands refer to the values that replaced them
+    for (auto *block : blocks) {
+        std::vector<IRInst *> insts;
+        for (auto *phi : created_[block->id]) {
+            if (replacements_[phi->id] == nullptr) {
+                insts.push_back(phi);
+                phis_++;
+            }
+        }
+        if (block == blocks.front()) {
+            for (auto *value : initial_) {
+                if (value != nullptr)
+                    insts.push_back(value);
+            }
+        }
+        insts.insert(insts.end(), block->insts.begin(), block->insts.end());
+        for (auto *inst : insts) {
+            for (auto &operand : inst->operands)
+                operand = find(operand);
+        }
+        block->insts = std::move(insts);
+    }
+
+    // The new phi nodes may sit behind a branch
+    function.split_critical_edges();
+    function_ = nullptr;
+}
+
+IRInst *Mem2Reg::read_entry(IRBlock *block, int var) {
+    IRInst *&value = entry_[block->id * variables_.size() + var];
+    if (value != nullptr)
+        return value;
+    if (block == function_->blocks().front())
+        return value = initial(var);
+    if (block->predecessors.size() == 1)
+        return value = read_exit(block->predecessors.front(), var);
+
+    // The phi node is the value before its inputs are read, a loop reaches it
+    // again
+    IRInst *phi = function_->new_inst(IROp::PHI, variables_[var]->type);
+    phi->block = block;
+    value = phi;
+    for (auto *pred : block->predecessors) {
+        phi->operands.push_back(read_exit(pred, var));
+        phi->targets.push_back(pred);
+    }
+    created_[block->id].push_back(phi);
+    return phi;
+}
+
+IRInst *Mem2Reg::read_exit(IRBlock *block, int var) {
+    IRInst *value = exit_[block->id * variables_.size() + var];
+    return value != nullptr ? value : read_entry(block, var);
+}
+
+IRInst *Mem2Reg::initial(int var) {
+    IRInst *&value = initial_[var];
+    if (value != nullptr)
+        return value;
+
+    // A parameter is in its slot, an uninitialized local reads as 0
+    Variable *variable = variables_[var];
+    const auto &params = function_->prototype()->parameters_;
+    if (std::find(params.begin(), params.end(), variable) != params.end()) {
+        value = function_->new_inst(IROp::GET, variable->type);
+        value->variable = variable;
+    } else {
+        value = function_->new_inst(IROp::CONST, variable->type);
+    }
+    value->block = function_->blocks().front();
+    return value;
+}
+
+IRInst *Mem2Reg::find(IRInst *value) const {
+    while (value->id < static_cast<int>(replacements_.size()) &&
+           replacements_[value->id] != nullptr)
+        value = replacements_[value->id];
+    return value;
+}
+} // namespace myComp
@@ -8,7 +8,7 @@ using namespace std;
 namespace myComp {
 ASTNode_ *Parser::build_tree() {
     Type *data_type = token_processor_->next_data_type();
-    string identifier = token_processor_->next_identifier();
+    Symbol identifier = token_processor_->next_identifier();
 
     if (token_processor_->peek_type() != TokenType::LPAREN) {
         return variable_declaration(data_type, identifier);
@@ -18,7 +18,7 @@ ASTNode_ *Parser::build_tree() {
 
 // todo: optimize this function
 VariableDeclarationNode *Parser::variable_declaration(Type *data_type,
-                                                      string &name) {
+                                                      Symbol name) {
     if (token_processor_->peek_type() == TokenType::LBRACKET) {
 
         token_processor_->lbracket();
@@ -51,7 +51,7 @@ VariableDeclarationNode *Parser::variable_declaration(Type *data_type,
 
     // Do not support initialization on declaration
 
-    return new VariableDeclarationNode(nullptr, nullptr);
+    return new (*arena_) VariableDeclarationNode(nullptr, nullptr);
 }
 
 VariableDeclarationNode *Parser::variable_declaration() {
@@ -59,7 +59,7 @@ VariableDeclarationNode *Parser::variable_declaration() {
 
     // Build the tree
     while (token_processor_->peek_type() != TokenType::SEMI) {
-        string name = token_processor_->next_identifier();
+        Symbol name = token_processor_->next_identifier();
         if (token_processor_->peek_type() == TokenType::LBRACKET) {
             token_processor_->lbracket();
             int size = static_cast<int>(token_processor_->next_integer());
@@ -76,11 +76,11 @@ VariableDeclarationNode *Parser::variable_declaration() {
 
     // Do not support initialization on declaration
 
-    return new VariableDeclarationNode(nullptr, nullptr);
+    return new (*arena_) VariableDeclarationNode(nullptr, nullptr);
 }
 
 FunctionDefinitionNode *Parser::function_declaration(Type *return_type,
-                                                     const string &name) {
+                                                     Symbol name) {
     // Set the context
     Context::push(name);
 
@@ -90,7 +90,8 @@ FunctionDefinitionNode *Parser::function_declaration(Type *return_type,
 
     // If the function is already declared, check if the return type matches
     if (declared && return_type != prototype->return_type_) {
-        throw SyntaxException("return type mismatch in function " + name);
+        throw SyntaxException("return type mismatch in function " +
+                              name.str());
     }
 
     // Fetch the parameter list
@@ -107,7 +108,7 @@ FunctionDefinitionNode *Parser::function_declaration(Type *return_type,
             // Check if the parameter type matches
             if (token_processor_->next_data_type() != type) {
                 throw SyntaxException("parameter type mismatch in function " +
-                                      name);
+                                      name.str());
             }
 
             // If the parameter has a name, fill it in
@@ -139,7 +140,7 @@ FunctionDefinitionNode *Parser::function_declaration(Type *return_type,
 
             // Get data type and identifier
             Type *data_type = token_processor_->next_data_type();
-            string identifier = token_processor_->next_identifier();
+            Symbol identifier = token_processor_->next_identifier();
 
             // Insert the parameter into the parameter list
             VariableManager::insert(data_type, identifier, Context::get_name());
@@ -169,7 +170,7 @@ FunctionDefinitionNode *Parser::function_declaration(Type *return_type,
     // Make sure the parameters have names
     for (auto param : prototype->parameters_) {
         if (param->name.empty())
-            throw SyntaxException("parameter " + param->name +
+            throw SyntaxException("parameter " + param->name.str() +
                                   " must have a name");
     }
 
@@ -178,13 +179,13 @@ FunctionDefinitionNode *Parser::function_declaration(Type *return_type,
 
     // Ensure non-void functions have a return statement
     if (!return_type->is_void() && !Context::has_return()) {
-        throw SyntaxException("non-void function " + name +
+        throw SyntaxException("non-void function " + name.str() +
                               " must have a return statement");
     }
 
     // Ensure void functions don't have a return statement
     if (return_type->is_void() && Context::has_return()) {
-        throw SyntaxException("void function " + name +
+        throw SyntaxException("void function " + name.str() +
                               " cannot have a return statement");
     }
 
@@ -192,7 +193,7 @@ FunctionDefinitionNode *Parser::function_declaration(Type *return_type,
     Context::pop();
 
     // Build the function definition node
-    return new FunctionDefinitionNode(prototype, block);
+    return new (*arena_) FunctionDefinitionNode(prototype, block);
 }
 
 CodeBlockNode *Parser::code_block() {
@@ -204,7 +205,7 @@ CodeBlockNode *Parser::code_block() {
     }
     token_processor_->rbrace();
 
-    return new CodeBlockNode(statements);
+    return new (*arena_) CodeBlockNode(arena_->copy(statements));
 }
 
 StatementNode *Parser::statement() {
@@ -247,7 +248,7 @@ IfNode *Parser::if_statement() {
         block_else = Parser::code_block();
     }
 
-    return new IfNode(condition, block_if, block_else);
+    return new (*arena_) IfNode(condition, block_if, block_else);
 }
 
 WhileNode *Parser::while_statement() {
@@ -262,7 +263,7 @@ WhileNode *Parser::while_statement() {
 
     CodeBlockNode *block = code_block();
 
-    return new WhileNode(condition, block);
+    return new (*arena_) WhileNode(condition, block);
 }
 
 ForNode *Parser::for_statement() {
@@ -282,7 +283,7 @@ ForNode *Parser::for_statement() {
 
     CodeBlockNode *block = code_block();
 
-    return new ForNode(init, condition, increment, block);
+    return new (*arena_) ForNode(init, condition, increment, block);
 }
 
 ReturnNode *Parser::return_statement() {
@@ -297,11 +298,11 @@ ReturnNode *Parser::return_statement() {
             node->type(),
             FunctionManager::find(Context::get_name())->return_type_))
         throw SyntaxException("return type mismatch in function " +
-                              Context::get_name());
+                              Context::get_name().str());
 
     // Set the return flag
     Context::set_return_flag();
 
-    return new ReturnNode(node);
+    return new (*arena_) ReturnNode(node);
 }
 } // namespace myComp
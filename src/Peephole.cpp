@@ -0,0 +1,372 @@
+#include <climits>
+#include <string>
+#include <unordered_set>
+
+#include "Errors.h"
+#include "Peephole.h"
+
+namespace {
+using namespace myComp;
+
+constexpr const char *rule_names[] = {"self-move",   "mov-chain",
+                                      "jump-next",   "jump-thread",
+                                      "compare-zero", "identity"};
+
+bool same(const X86Operand &a, const X86Operand &b) {
+    return a.kind == b.kind && a.size == b.size && a.reg == b.reg &&
+           a.value == b.value && a.symbol == b.symbol && a.index == b.index &&
+           a.scale == b.scale;
+}
+
+// Whether an operand reads `reg` to form an address
+bool addresses(const X86Operand &operand, int reg) {
+    return operand.is_mem() && (operand.reg == reg || operand.index == reg);
+}
+
+bool is_move(X86Op op) {
+    return op == X86Op::MOV || op == X86Op::MOVZX || op == X86Op::MOVSX;
+}
+} // namespace
+
+namespace myComp {
+void Peephole::set_rules(std::string_view rules) {
+    rules_ = 0;
+    while (!rules.empty()) {
+        size_t comma = rules.find(',');
+        std::string_view name = rules.substr(0, comma);
+        rules = comma == std::string_view::npos ? std::string_view()
+                                                 : rules.substr(comma + 1);
+
+        if (name == "all") {
+            rules_ = (1u << NUM_RULES) - 1;
+            continue;
+        }
+        if (name == "none")
+            continue;
+        unsigned rule = 0;
+        while (rule < NUM_RULES && name != rule_names[rule])
+            rule++;
+        if (rule == NUM_RULES)
+            throw InvalidException("peephole rule " + std::string(name));
+        rules_ |= 1u << rule;
+    }
+}
+
+void Peephole::run(std::vector<X86Instruction> &code) {
+    code_ = &code;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        removed_.assign(code.size(), false);
+        labels_.clear();
+        for (size_t i = 0; i < code.size(); i++) {
+            if (code[i].op == X86Op::LABEL)
+                labels_[code[i].src.symbol] = i;
+        }
+
+        for (size_t i = 0; i < code.size(); i++) {
+            if (!removed_[i])
+                changed |= rewrite(i);
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < code.size(); i++) {
+            if (!removed_[i])
+                code[kept++] = code[i];
+        }
+        code.resize(kept);
+    }
+    code_ = nullptr;
+}
+
+void Peephole::print(std::ostream &os) const {
+    size_t total = 0;
+    for (size_t count : counts_)
+        total += count;
+    os << "Peephole: " << total << " rewrites (";
+    for (unsigned rule = 0; rule < NUM_RULES; rule++) {
+        os << (rule == 0 ? "" : ", ") << rule_names[rule] << ' '
+           << counts_[rule];
+    }
+    os << ")\n";
+}
+
+bool Peephole::rewrite(size_t i) {
+    return (enabled(SELF_MOVE) && self_move(i)) ||
+           (enabled(MOV_CHAIN) && mov_chain(i)) ||
+           (enabled(JUMP_NEXT) && jump_next(i)) ||
+           (enabled(JUMP_THREAD) && jump_thread(i)) ||
+           (enabled(COMPARE_ZERO) && compare_zero(i)) ||
+           (enabled(IDENTITY) && identity(i));
+}
+
+bool Peephole::self_move(size_t i) {
+    const X86Instruction &inst = (*code_)[i];
+    if (inst.op != X86Op::MOV || !inst.src.is_reg() || !inst.dst.is_reg() ||
+        inst.src.reg != inst.dst.reg) {
+        return false;
+    }
+
+    // A 32-bit move clears the upper half, the ABI leaves the upper half of an
+    // int return value undefined
+    if (inst.size == 4 && !clears_upper(previous(i), inst.dst.reg)) {
+        size_t k = next(i);
+        if (inst.dst.reg != X86Reg::RAX || k == code_->size() ||
+            (*code_)[k].op != X86Op::RET) {
+            return false;
+        }
+    }
+    remove(i, SELF_MOVE);
+    return true;
+}
+
+bool Peephole::mov_chain(size_t i) {
+    const X86Instruction &first = (*code_)[i];
+    size_t j = next(i);
+    if (first.op != X86Op::MOV || j == code_->size())
+        return false;
+    X86Instruction &second = (*code_)[j];
+
+    // mov a, b; mov b, a
+    if (second.op == X86Op::MOV && second.size == first.size &&
+        same(second.src, first.dst) && same(second.dst, first.src) &&
+        !(first.dst.is_reg() && addresses(first.src, first.dst.reg))) {
+        if (second.dst.is_reg() && second.size == 4 &&
+            !clears_upper(previous(i), second.dst.reg)) {
+            return false;
+        }
+        remove(j, MOV_CHAIN);
+        return true;
+    }
+
+    // mov s, b; mov b, d where b dies becomes mov s, d
+    if (!first.dst.is_reg() || !is_move(second.op) ||
+        !second.src.is_reg() || second.src.reg != first.dst.reg ||
+        second.src.size != first.size) {
+        return false;
+    }
+    int reg = first.dst.reg;
+    if ((second.op == X86Op::MOV && second.size != first.size) ||
+        addresses(second.dst, reg) ||
+        (first.src.is_mem() && second.dst.is_mem())) {
+        return false;
+    }
+    // Only movq to a register takes a 64-bit immediate
+    if (first.src.is_imm() &&
+        (second.op != X86Op::MOV ||
+         (!second.dst.is_reg() &&
+          first.src.value != static_cast<int>(first.src.value)))) {
+        return false;
+    }
+    if (!(second.dst.is_reg() && second.dst.reg == reg) && live_after(j, reg))
+        return false;
+
+    second.src = first.src;
+    remove(i, MOV_CHAIN);
+    return true;
+}
+
+bool Peephole::jump_next(size_t i) {
+    const X86Instruction &inst = (*code_)[i];
+    if (inst.op != X86Op::JMP && inst.op != X86Op::JCC)
+        return false;
+    for (size_t k = next(i);
+         k < code_->size() && (*code_)[k].op == X86Op::LABEL; k = next(k)) {
+        if ((*code_)[k].src.symbol == inst.src.symbol) {
+            remove(i, JUMP_NEXT);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Peephole::jump_thread(size_t i) {
+    X86Instruction &inst = (*code_)[i];
+    if (inst.op != X86Op::JMP && inst.op != X86Op::JCC)
+        return false;
+
+    // Follow the jumps, leave an empty loop alone
+    Symbol target = inst.src.symbol;
+    std::unordered_set<Symbol> visited = {target};
+    size_t k = destination(target);
+    while (k < code_->size() && (*code_)[k].op == X86Op::JMP) {
+        target = (*code_)[k].src.symbol;
+        if (!visited.insert(target).second)
+            return false;
+        k = destination(target);
+    }
+
+    if (target != inst.src.symbol) {
+        inst.src.symbol = target;
+        counts_[JUMP_THREAD]++;
+        return true;
+    }
+    if (inst.op == X86Op::JMP && k < code_->size() &&
+        (*code_)[k].op == X86Op::RET) {
+        inst = (*code_)[k];
+        counts_[JUMP_THREAD]++;
+        return true;
+    }
+    return false;
+}
+
+bool Peephole::compare_zero(size_t i) {
+    X86Instruction &inst = (*code_)[i];
+    if (inst.op != X86Op::CMP || !inst.src.is_imm() || inst.src.value != 0 ||
+        !inst.dst.is_reg()) {
+        return false;
+    }
+    inst.op = X86Op::TEST;
+    inst.src = inst.dst;
+    counts_[COMPARE_ZERO]++;
+    return true;
+}
+
+bool Peephole::identity(size_t i) {
+    const X86Instruction &inst = (*code_)[i];
+    if (!inst.src.is_imm() || inst.src.value != 0)
+        return false;
+    switch (inst.op) {
+    case X86Op::ADD:
+    case X86Op::SUB:
+    case X86Op::OR:
+    case X86Op::XOR:
+        if (flags_live_after(i))
+            return false;
+        break;
+    case X86Op::SAL:
+    case X86Op::SAR:
+    case X86Op::SHR:
+        // A shift by 0 leaves the flags
+        break;
+    default:
+        return false;
+    }
+    if (inst.dst.is_reg() && inst.size == 4 &&
+        !clears_upper(previous(i), inst.dst.reg)) {
+        return false;
+    }
+    remove(i, IDENTITY);
+    return true;
+}
+
+size_t Peephole::next(size_t i) const {
+    do {
+        i++;
+    } while (i < code_->size() && removed_[i]);
+    return i;
+}
+
+size_t Peephole::previous(size_t i) const {
+    while (i-- > 0) {
+        if (!removed_[i])
+            return i;
+    }
+    return code_->size();
+}
+
+bool Peephole::live_after(size_t i, int reg) const {
+    for (size_t k = next(i); k < code_->size(); k = next(k)) {
+        const X86Instruction &inst = (*code_)[k];
+        if (inst.op == X86Op::JMP || inst.op == X86Op::JCC)
+            return true;
+
+        bool read = false;
+        bool written = false;
+        for_each_access(
+            inst, [&](int r) { read |= r == reg; },
+            [&](int r) { written |= r == reg; });
+        if (read)
+            return true;
+        // Writing the low bytes keeps the rest of the register
+        if (written)
+            return inst.dst.is_reg() && inst.dst.reg == reg &&
+                   inst.dst.size < 4;
+        if (inst.op == X86Op::RET)
+            return false;
+    }
+    return false;
+}
+
+bool Peephole::flags_live_after(size_t i) const {
+    for (size_t k = next(i); k < code_->size(); k = next(k)) {
+        switch ((*code_)[k].op) {
+        case X86Op::JMP:
+        case X86Op::JCC:
+        case X86Op::SETCC:
+            return true;
+        case X86Op::ADD:
+        case X86Op::SUB:
+        case X86Op::IMUL:
+        case X86Op::AND:
+        case X86Op::OR:
+        case X86Op::XOR:
+        case X86Op::NEG:
+        case X86Op::INC:
+        case X86Op::DEC:
+        case X86Op::CMP:
+        case X86Op::TEST:
+        case X86Op::CALL:
+        case X86Op::IDIV:
+        case X86Op::DIV:
+        case X86Op::MUL:
+        case X86Op::RET:
+            return false;
+        default:
+            // Shifts by %cl may leave the flags
+            break;
+        }
+    }
+    return false;
+}
+
+bool Peephole::clears_upper(size_t i, int reg) const {
+    if (i == code_->size())
+        return false;
+    const X86Instruction &inst = (*code_)[i];
+    if (!inst.dst.is_reg() || inst.dst.reg != reg)
+        return false;
+    switch (inst.op) {
+    case X86Op::MOV:
+        return inst.size == 4 ||
+               (inst.size == 8 && inst.src.is_imm() && inst.src.value >= 0 &&
+                inst.src.value <= INT_MAX);
+    case X86Op::MOVZX:
+        return true;
+    case X86Op::MOVSX:
+        return inst.dst.size == 4;
+    case X86Op::LEA:
+    case X86Op::ADD:
+    case X86Op::SUB:
+    case X86Op::IMUL:
+    case X86Op::AND:
+    case X86Op::OR:
+    case X86Op::XOR:
+    case X86Op::SAL:
+    case X86Op::SAR:
+    case X86Op::SHR:
+    case X86Op::NEG:
+    case X86Op::NOT:
+    case X86Op::INC:
+    case X86Op::DEC:
+        return inst.size == 4;
+    default:
+        return false;
+    }
+}
+
+size_t Peephole::destination(Symbol label) const {
+    auto it = labels_.find(label);
+    if (it == labels_.end())
+        return code_->size();
+    size_t k = it->second;
+    while (k < code_->size() && (*code_)[k].op == X86Op::LABEL)
+        k = next(k);
+    return k;
+}
+
+void Peephole::remove(size_t i, Rule rule) {
+    removed_[i] = true;
+    counts_[rule]++;
+}
+} // namespace myComp
@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <unordered_map>
+
+#include "Errors.h"
+#include "RegisterAllocator.h"
+
+namespace {
+using namespace myComp;
+
+// Allocation order, registers that need no saving come first
+constexpr int allocation_order[] = {
+    X86Reg::R10, X86Reg::R11, X86Reg::R9,  X86Reg::R8,  X86Reg::RSI,
+    X86Reg::RDI, X86Reg::RCX, X86Reg::RDX, X86Reg::RAX, X86Reg::RBX,
+    X86Reg::R12, X86Reg::R13, X86Reg::R14, X86Reg::R15};
+
+// Call `f` on the register of every operand that names one, and on the index
+// of a memory operand
+template <typename Inst, typename F>
+void for_each_register(Inst &inst, F &&f) {
+    for (auto *operand : {&inst.src, &inst.dst}) {
+        if (operand->is_reg() || operand->is_mem())
+            f(operand->reg);
+        if (operand->is_mem() && operand->index != -1)
+            f(operand->index);
+    }
+}
+
+// A straight-line run of instructions
+struct Block {
+    int first;
+    int last;
+    int successors[2] = {-1, -1};
+};
+
+// Set of registers, one bit per liveness index
+class RegisterSet {
+  public:
+    explicit RegisterSet(size_t size = 0) : words_((size + 63) / 64) {}
+
+    bool contains(int i) const { return words_[i / 64] >> (i % 64) & 1; }
+    void insert(int i) { words_[i / 64] |= uint64_t{1} << (i % 64); }
+
+    // this = uses | (this - defs)
+    void transfer(const RegisterSet &uses, const RegisterSet &defs) {
+        for (size_t w = 0; w < words_.size(); w++)
+            words_[w] = uses.words_[w] | (words_[w] & ~defs.words_[w]);
+    }
+
+    bool operator==(const RegisterSet &) const = default;
+
+    void unite(const RegisterSet &other) {
+        for (size_t w = 0; w < words_.size(); w++)
+            words_[w] |= other.words_[w];
+    }
+
+    template <typename F> void for_each(F &&f) const {
+        for (size_t w = 0; w < words_.size(); w++) {
+            for (uint64_t bits = words_[w]; bits != 0; bits &= bits - 1)
+                f(static_cast<int>(w * 64 + std::countr_zero(bits)));
+        }
+    }
+
+  private:
+    std::vector<uint64_t> words_;
+};
+
+// Split the code into blocks and link them
+std::vector<Block> build_blocks(const std::vector<X86Instruction> &code) {
+    std::vector<Block> blocks;
+    std::unordered_map<Symbol, int> labels;
+
+    int n = static_cast<int>(code.size());
+    for (int i = 0; i < n; i++) {
+        bool leader = i == 0 || code[i].op == X86Op::LABEL;
+        if (i > 0) {
+            X86Op prev = code[i - 1].op;
+            leader |= prev == X86Op::JMP || prev == X86Op::JCC ||
+                      prev == X86Op::RET;
+        }
+        if (leader)
+            blocks.push_back({i, i});
+        else
+            blocks.back().last = i;
+        if (code[i].op == X86Op::LABEL)
+            labels[code[i].src.symbol] = static_cast<int>(blocks.size()) - 1;
+    }
+
+    for (size_t b = 0; b < blocks.size(); b++) {
+        const X86Instruction &last = code[blocks[b].last];
+        int next = b + 1 < blocks.size() ? static_cast<int>(b) + 1 : -1;
+        switch (last.op) {
+        case X86Op::JMP:
+            blocks[b].successors[0] = labels.at(last.src.symbol);
+            break;
+        case X86Op::JCC:
+            blocks[b].successors[0] = labels.at(last.src.symbol);
+            blocks[b].successors[1] = next;
+            break;
+        case X86Op::RET:
+            break;
+        default:
+            blocks[b].successors[0] = next;
+            break;
+        }
+    }
+    return blocks;
+}
+} // namespace
+
+namespace myComp {
+int RegisterAllocator::index(int reg) const {
+    return X86Reg::is_virtual(reg)
+               ? X86Reg::NUM_PHYSICAL + reg - X86Reg::FIRST_VIRTUAL
+               : reg;
+}
+
+void RegisterAllocator::run(std::vector<X86Instruction> &code,
+                            int &frame_size) {
+    used_ = 0;
+    spilled_ = 0;
+    reload_.clear();
+
+    // Reloads are short, so this ends after a few rounds
+    while (true) {
+        build(code);
+        if (!scan())
+            break;
+        spill(code, frame_size);
+    }
+
+    // Rewrite the virtual registers
+    for (auto &inst : code) {
+        for_each_register(inst, [&](int &reg) {
+            if (X86Reg::is_virtual(reg))
+                reg = intervals_[reg - X86Reg::FIRST_VIRTUAL].assigned;
+            if (X86Reg::is_physical(reg))
+                used_ |= 1u << reg;
+        });
+    }
+
+    // Copies between registers that got the same register
+    std::erase_if(code, [](const X86Instruction &inst) {
+        return inst.op == X86Op::MOV && inst.size == 8 && inst.src.is_reg() &&
+               inst.dst.is_reg() && inst.src.reg == inst.dst.reg;
+    });
+}
+
+void RegisterAllocator::build(const std::vector<X86Instruction> &code) {
+    // Number of virtual registers
+    int virtuals = 0;
+    for (const auto &inst : code) {
+        for_each_register(inst, [&](int reg) {
+            if (X86Reg::is_virtual(reg))
+                virtuals = std::max(virtuals, reg - X86Reg::FIRST_VIRTUAL + 1);
+        });
+    }
+    size_t size = X86Reg::NUM_PHYSICAL + virtuals;
+    reload_.resize(virtuals, false);
+
+    // Registers read before being written and registers written in each
+    // block
+    std::vector<Block> blocks = build_blocks(code);
+    std::vector<RegisterSet> uses(blocks.size(), RegisterSet(size));
+    std::vector<RegisterSet> defs(blocks.size(), RegisterSet(size));
+    for (size_t b = 0; b < blocks.size(); b++) {
+        for (int i = blocks[b].first; i <= blocks[b].last; i++) {
+            for_each_access(
+                code[i],
+                [&](int reg) {
+                    if (!defs[b].contains(index(reg)))
+                        uses[b].insert(index(reg));
+                },
+                [&](int reg) { defs[b].insert(index(reg)); });
+        }
+    }
+
+    // Backward liveness until nothing changes
+    std::vector<RegisterSet> live_in(blocks.size(), RegisterSet(size));
+    std::vector<RegisterSet> live_out(blocks.size(), RegisterSet(size));
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t b = blocks.size(); b-- > 0;) {
+            for (int successor : blocks[b].successors) {
+                if (successor >= 0)
+                    live_out[b].unite(live_in[successor]);
+            }
+            RegisterSet in = live_out[b];
+            in.transfer(uses[b], defs[b]);
+            if (in != live_in[b]) {
+                live_in[b] = std::move(in);
+                changed = true;
+            }
+        }
+    }
+
+    // Position 2i reads the operands of instruction i, 2i + 1 writes them
+    intervals_.assign(virtuals, {});
+    for (int v = 0; v < virtuals; v++) {
+        intervals_[v].reg = X86Reg::FIRST_VIRTUAL + v;
+        intervals_[v].start = INT_MAX;
+        intervals_[v].end = -1;
+        intervals_[v].spillable = !reload_[v];
+    }
+    auto extend = [&](int i, int position) {
+        if (i < X86Reg::NUM_PHYSICAL)
+            return;
+        Interval &interval = intervals_[i - X86Reg::NUM_PHYSICAL];
+        interval.start = std::min(interval.start, position);
+        interval.end = std::max(interval.end, position);
+    };
+
+    for (auto &ranges : fixed_)
+        ranges.clear();
+
+    for (size_t b = 0; b < blocks.size(); b++) {
+        int begin = 2 * blocks[b].first;
+        int end = 2 * blocks[b].last + 1;
+        live_in[b].for_each([&](int i) { extend(i, begin); });
+        live_out[b].for_each([&](int i) { extend(i, end); });
+
+        // Walk backward to find the exact ranges of the physical registers
+        int open[X86Reg::NUM_PHYSICAL];
+        std::fill(std::begin(open), std::end(open), -1);
+        live_out[b].for_each([&](int i) {
+            if (i < X86Reg::NUM_PHYSICAL)
+                open[i] = end;
+        });
+        for (int i = blocks[b].last; i >= blocks[b].first; i--) {
+            for_each_access(
+                code[i], [](int) {},
+                [&](int reg) {
+                    if (X86Reg::is_virtual(reg))
+                        return;
+                    int last = open[reg] >= 0 ? open[reg] : 2 * i + 1;
+                    fixed_[reg].emplace_back(2 * i + 1, last);
+                    open[reg] = -1;
+                });
+            for_each_access(
+                code[i],
+                [&](int reg) {
+                    if (X86Reg::is_physical(reg) && open[reg] < 0)
+                        open[reg] = 2 * i;
+                },
+                [](int) {});
+            for_each_access(
+                code[i], [&](int reg) { extend(index(reg), 2 * i); },
+                [&](int reg) { extend(index(reg), 2 * i + 1); });
+        }
+        for (int reg = 0; reg < X86Reg::NUM_PHYSICAL; reg++) {
+            if (open[reg] >= 0)
+                fixed_[reg].emplace_back(begin, open[reg]);
+        }
+    }
+
+    // Sort and merge the fixed ranges
+    for (auto &ranges : fixed_) {
+        std::sort(ranges.begin(), ranges.end());
+        std::vector<std::pair<int, int>> merged;
+        for (auto range : ranges) {
+            if (!merged.empty() && range.first <= merged.back().second + 1)
+                merged.back().second =
+                    std::max(merged.back().second, range.second);
+            else
+                merged.push_back(range);
+        }
+        ranges = std::move(merged);
+    }
+
+    // Copies suggest a register
+    for (const auto &inst : code) {
+        if (inst.op != X86Op::MOV || !inst.src.is_reg() || !inst.dst.is_reg())
+            continue;
+        int a = inst.src.reg, b = inst.dst.reg;
+        if (X86Reg::is_virtual(a) && X86Reg::is_virtual(b)) {
+            intervals_[a - X86Reg::FIRST_VIRTUAL].hint_interval =
+                b - X86Reg::FIRST_VIRTUAL;
+            intervals_[b - X86Reg::FIRST_VIRTUAL].hint_interval =
+                a - X86Reg::FIRST_VIRTUAL;
+        } else if (X86Reg::is_virtual(a) && X86Reg::is_physical(b)) {
+            intervals_[a - X86Reg::FIRST_VIRTUAL].hint = b;
+        } else if (X86Reg::is_physical(a) && X86Reg::is_virtual(b)) {
+            intervals_[b - X86Reg::FIRST_VIRTUAL].hint = a;
+        }
+    }
+}
+
+bool RegisterAllocator::conflicts(int reg, int start, int end) const {
+    const auto &ranges = fixed_[reg];
+    auto it = std::lower_bound(
+        ranges.begin(), ranges.end(), start,
+        [](const std::pair<int, int> &range, int s) { return range.second < s; });
+    return it != ranges.end() && it->first <= end;
+}
+
+bool RegisterAllocator::scan() {
+    std::vector<int> order;
+    for (int v = 0; v < static_cast<int>(intervals_.size()); v++) {
+        // Registers that are never used
+        if (intervals_[v].end >= 0)
+            order.push_back(v);
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return intervals_[a].start < intervals_[b].start;
+    });
+
+    // Intervals holding a register, and the interval owning each register
+    std::vector<int> active;
+    int owner[X86Reg::NUM_PHYSICAL];
+    std::fill(std::begin(owner), std::end(owner), -1);
+
+    bool spilled = false;
+    for (int v : order) {
+        Interval &cur = intervals_[v];
+
+        // Release the registers of the intervals that ended
+        std::erase_if(active, [&](int a) {
+            if (intervals_[a].end >= cur.start)
+                return false;
+            owner[intervals_[a].assigned] = -1;
+            return true;
+        });
+
+        auto available = [&](int reg) {
+            return reg >= 0 && owner[reg] < 0 &&
+                   !conflicts(reg, cur.start, cur.end);
+        };
+
+        int reg = -1;
+        if (cur.hint_interval >= 0 &&
+            available(intervals_[cur.hint_interval].assigned))
+            reg = intervals_[cur.hint_interval].assigned;
+        else if (available(cur.hint))
+            reg = cur.hint;
+        else {
+            for (int candidate : allocation_order) {
+                if (available(candidate)) {
+                    reg = candidate;
+                    break;
+                }
+            }
+        }
+
+        if (reg < 0) {
+            // Take the register of the active interval that ends last
+            int victim = -1;
+            for (int a : active) {
+                const Interval &interval = intervals_[a];
+                if (interval.spillable &&
+                    !conflicts(interval.assigned, cur.start, cur.end) &&
+                    (victim < 0 || interval.end > intervals_[victim].end))
+                    victim = a;
+            }
+
+            if (victim >= 0 &&
+                (!cur.spillable || intervals_[victim].end > cur.end)) {
+                reg = intervals_[victim].assigned;
+                intervals_[victim].assigned = SPILLED;
+                std::erase(active, victim);
+            } else if (cur.spillable) {
+                cur.assigned = SPILLED;
+                spilled = true;
+                continue;
+            } else {
+                throw LogicException("No free register");
+            }
+            spilled = true;
+        }
+
+        cur.assigned = reg;
+        owner[reg] = v;
+        active.push_back(v);
+    }
+    return spilled;
+}
+
+void RegisterAllocator::spill(std::vector<X86Instruction> &code,
+                              int &frame_size) {
+    // A slot for each spilled register
+    std::unordered_map<int, int> slots;
+    frame_size = (frame_size + 7) / 8 * 8;
+    for (const auto &interval : intervals_) {
+        if (interval.assigned == SPILLED) {
+            frame_size += 8;
+            slots[interval.reg] = -frame_size;
+            spilled_++;
+        }
+    }
+
+    int next = X86Reg::FIRST_VIRTUAL + static_cast<int>(intervals_.size());
+    std::vector<X86Instruction> out;
+    out.reserve(code.size() + slots.size() * 4);
+    for (auto inst : code) {
+        // Spilled registers read and written by the instruction
+        std::vector<int> read, written;
+        for_each_access(
+            inst,
+            [&](int reg) {
+                if (slots.contains(reg))
+                    read.push_back(reg);
+            },
+            [&](int reg) {
+                if (slots.contains(reg))
+                    written.push_back(reg);
+            });
+        if (read.empty() && written.empty()) {
+            out.push_back(inst);
+            continue;
+        }
+
+        // One new register per spilled register
+        std::vector<std::pair<int, int>> renamed;
+        for (int reg : read) {
+            if (std::ranges::find(renamed, reg, &std::pair<int, int>::first) ==
+                renamed.end())
+                renamed.emplace_back(reg, next++);
+        }
+        for (int reg : written) {
+            if (std::ranges::find(renamed, reg, &std::pair<int, int>::first) ==
+                renamed.end())
+                renamed.emplace_back(reg, next++);
+        }
+        auto rename = [&](int reg) {
+            return std::ranges::find(renamed, reg, &std::pair<int, int>::first)
+                ->second;
+        };
+
+        for (int reg : read) {
+            out.push_back(
+                {X86Op::MOV, 8, X86Cond::E,
+                 X86Operand::make_mem(X86Reg::RBP, slots[reg], 8),
+                 X86Operand::make_reg(rename(reg), 8)});
+        }
+        for_each_register(inst, [&](int &reg) {
+            if (slots.contains(reg))
+                reg = rename(reg);
+        });
+        out.push_back(inst);
+        for (int reg : written) {
+            out.push_back(
+                {X86Op::MOV, 8, X86Cond::E, X86Operand::make_reg(rename(reg), 8),
+                 X86Operand::make_mem(X86Reg::RBP, slots[reg], 8)});
+        }
+    }
+    code = std::move(out);
+
+    reload_.resize(next - X86Reg::FIRST_VIRTUAL, true);
+}
+} // namespace myComp
@@ -0,0 +1,223 @@
+#include "ScanKernel.h"
+#include "Errors.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MYCOMP_X86_SIMD 1
+#endif
+
+namespace {
+using namespace myComp;
+
+// Scalar implementations, also used for the tails of the vector loops
+bool is_space(unsigned char c) {
+    return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+}
+
+bool is_identifier(unsigned char c) {
+    return static_cast<unsigned char>((c | 0x20) - 'a') <= 'z' - 'a' ||
+           static_cast<unsigned char>(c - '0') <= 9 || c == '_';
+}
+
+bool is_digit(unsigned char c) {
+    return static_cast<unsigned char>(c - '0') <= 9;
+}
+
+const char *skip_whitespace_scalar(const char *p, const char *end) {
+    while (p < end && is_space(*p))
+        ++p;
+    return p;
+}
+
+const char *identifier_end_scalar(const char *p, const char *end) {
+    while (p < end && is_identifier(*p))
+        ++p;
+    return p;
+}
+
+const char *digit_end_scalar(const char *p, const char *end) {
+    while (p < end && is_digit(*p))
+        ++p;
+    return p;
+}
+
+#ifdef MYCOMP_X86_SIMD
+// Unsigned `lo <= x <= hi` on every byte
+__m128i in_range_sse2(__m128i x, char lo, char hi) {
+    __m128i t = _mm_sub_epi8(x, _mm_set1_epi8(lo));
+    __m128i limit = _mm_set1_epi8(static_cast<char>(hi - lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(t, limit), t);
+}
+
+__m128i space_mask_sse2(__m128i x) {
+    return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')),
+                        in_range_sse2(x, '\t', '\r'));
+}
+
+__m128i identifier_mask_sse2(__m128i x) {
+    __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+    return _mm_or_si128(
+        _mm_or_si128(in_range_sse2(lower, 'a', 'z'), in_range_sse2(x, '0', '9')),
+        _mm_cmpeq_epi8(x, _mm_set1_epi8('_')));
+}
+
+const char *skip_whitespace_sse2(const char *p, const char *end) {
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned space = _mm_movemask_epi8(space_mask_sse2(x));
+        if (space != 0xFFFF)
+            return p + __builtin_ctz(~space);
+        p += 16;
+    }
+    return skip_whitespace_scalar(p, end);
+}
+
+const char *identifier_end_sse2(const char *p, const char *end) {
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned ident = _mm_movemask_epi8(identifier_mask_sse2(x));
+        if (ident != 0xFFFF)
+            return p + __builtin_ctz(~ident);
+        p += 16;
+    }
+    return identifier_end_scalar(p, end);
+}
+
+const char *digit_end_sse2(const char *p, const char *end) {
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned digit = _mm_movemask_epi8(in_range_sse2(x, '0', '9'));
+        if (digit != 0xFFFF)
+            return p + __builtin_ctz(~digit);
+        p += 16;
+    }
+    return digit_end_scalar(p, end);
+}
+
+#define MYCOMP_AVX2 __attribute__((target("avx2")))
+
+MYCOMP_AVX2 __m256i in_range_avx2(__m256i x, char lo, char hi) {
+    __m256i t = _mm256_sub_epi8(x, _mm256_set1_epi8(lo));
+    __m256i limit = _mm256_set1_epi8(static_cast<char>(hi - lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(t, limit), t);
+}
+
+MYCOMP_AVX2 __m256i space_mask_avx2(__m256i x) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')),
+                           in_range_avx2(x, '\t', '\r'));
+}
+
+MYCOMP_AVX2 __m256i identifier_mask_avx2(__m256i x) {
+    __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+    return _mm256_or_si256(_mm256_or_si256(in_range_avx2(lower, 'a', 'z'),
+                                           in_range_avx2(x, '0', '9')),
+                           _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_')));
+}
+
+MYCOMP_AVX2 const char *skip_whitespace_avx2(const char *p, const char *end) {
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        unsigned space = _mm256_movemask_epi8(space_mask_avx2(x));
+        if (space != 0xFFFFFFFF)
+            return p + __builtin_ctz(~space);
+        p += 32;
+    }
+    return skip_whitespace_sse2(p, end);
+}
+
+MYCOMP_AVX2 const char *identifier_end_avx2(const char *p, const char *end) {
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        unsigned ident = _mm256_movemask_epi8(identifier_mask_avx2(x));
+        if (ident != 0xFFFFFFFF)
+            return p + __builtin_ctz(~ident);
+        p += 32;
+    }
+    return identifier_end_sse2(p, end);
+}
+
+MYCOMP_AVX2 const char *digit_end_avx2(const char *p, const char *end) {
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        unsigned digit = _mm256_movemask_epi8(in_range_avx2(x, '0', '9'));
+        if (digit != 0xFFFFFFFF)
+            return p + __builtin_ctz(~digit);
+        p += 32;
+    }
+    return digit_end_sse2(p, end);
+}
+#endif
+} // namespace
+
+namespace myComp {
+ScanKernel::Level ScanKernel::detect() {
+#ifdef MYCOMP_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return Level::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return Level::SSE2;
+#endif
+    return Level::SCALAR;
+}
+
+const char *ScanKernel::name(Level level) {
+    switch (level) {
+    case Level::SCALAR:
+        return "scalar";
+    case Level::SSE2:
+        return "sse2";
+    case Level::AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+void ScanKernel::select(Level level) {
+    if (level > detect())
+        throw InvalidException(std::string("scan kernel ") + name(level));
+
+    Kernels &kernels = get();
+    switch (level) {
+    case Level::SCALAR:
+        kernels = {level, skip_whitespace_scalar, identifier_end_scalar,
+                   digit_end_scalar};
+        break;
+#ifdef MYCOMP_X86_SIMD
+    case Level::SSE2:
+        kernels = {level, skip_whitespace_sse2, identifier_end_sse2,
+                   digit_end_sse2};
+        break;
+    case Level::AVX2:
+        kernels = {level, skip_whitespace_avx2, identifier_end_avx2,
+                   digit_end_avx2};
+        break;
+#endif
+    default:
+        throw UnreachableException(__func__);
+    }
+}
+
+ScanKernel::Kernels &ScanKernel::get() {
+    static Kernels kernels = [] {
+        Kernels ret{Level::SCALAR, skip_whitespace_scalar,
+                    identifier_end_scalar, digit_end_scalar};
+#ifdef MYCOMP_X86_SIMD
+        switch (detect()) {
+        case Level::AVX2:
+            ret = {Level::AVX2, skip_whitespace_avx2, identifier_end_avx2,
+                   digit_end_avx2};
+            break;
+        case Level::SSE2:
+            ret = {Level::SSE2, skip_whitespace_sse2, identifier_end_sse2,
+                   digit_end_sse2};
+            break;
+        default:
+            break;
+        }
+#endif
+        return ret;
+    }();
+    return kernels;
+}
+} // namespace myComp
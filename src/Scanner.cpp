@@ -1,5 +1,9 @@
+#include <array>
+#include <bit>
+
 #include "Scanner.h"
 #include "Errors.h"
+#include "ScanKernel.h"
 
 using namespace std;
 
@@ -7,8 +11,14 @@ namespace {
 using namespace myComp;
 using namespace std;
 
+struct Keyword {
+    string_view name;
+    TokenType type;
+};
+
 // List of keywords
-const unordered_map<string, TokenType> keywords = {
+// The perfect hash below is regenerated at compile time from this table
+constexpr Keyword keywords[] = {
     // Types
     {"void", TokenType::VOID},
     {"int", TokenType::INT},
@@ -21,221 +31,192 @@ const unordered_map<string, TokenType> keywords = {
     {"for", TokenType::FOR},
     {"return", TokenType::RETURN},
 };
+
+constexpr size_t NUM_KEYWORDS = size(keywords);
+
+// Number of slots, a power of 2 at least twice the number of keywords
+constexpr size_t KEYWORD_SLOTS = bit_ceil(2 * NUM_KEYWORDS);
+
+// Hash on the length and the first, second and last characters
+// Only the seed is searched, so lookups never touch the whole identifier
+constexpr uint32_t keyword_hash(string_view str, uint32_t seed) {
+    auto mix = [](uint32_t h, unsigned char c) { return (h ^ c) * 0x01000193; };
+    uint32_t h = mix(seed, str.size());
+    h = mix(h, str.front());
+    h = mix(h, str.size() > 1 ? str[1] : 0);
+    h = mix(h, str.back());
+    return (h ^ (h >> 16)) & (KEYWORD_SLOTS - 1);
+}
+
+struct KeywordTable {
+    uint32_t seed = 0;
+    // Index into `keywords` of each slot, -1 for empty slots
+    array<int8_t, KEYWORD_SLOTS> slots{};
+};
+
+// Search for a seed that maps every keyword to a distinct slot
+consteval KeywordTable build_keyword_table() {
+    for (uint32_t seed = 0; seed < 100000; seed++) {
+        KeywordTable table{seed};
+        table.slots.fill(-1);
+        bool collision = false;
+        for (size_t i = 0; i < NUM_KEYWORDS && !collision; i++) {
+            auto &slot = table.slots[keyword_hash(keywords[i].name, seed)];
+            collision = slot != -1;
+            slot = static_cast<int8_t>(i);
+        }
+        if (!collision)
+            return table;
+    }
+    throw "no perfect hash for the keyword table";
+}
+
+constexpr KeywordTable keyword_table = build_keyword_table();
+
+// Return the keyword type, or nullptr if `str` is not a keyword
+const TokenType *find_keyword(string_view str) {
+    int8_t index = keyword_table.slots[keyword_hash(str, keyword_table.seed)];
+    if (index < 0 || keywords[index].name != str)
+        return nullptr;
+    return &keywords[index].type;
+}
 } // namespace
 
 namespace myComp {
 void Scanner::set_input(const string &filename) {
-    // Open the input file
-    _input.open(filename);
+    // Map the input file, throw an error if it cannot be opened
+    _source.open(filename);
 
-    // If the file cannot be opened, throw an error
-    if (!_input.is_open())
-        throw IOException("cannot open file " + filename);
+    _cur = _source.begin();
+    _end = _source.end();
+    _token_start = _cur;
 }
 
-void Scanner::next() {
+void Scanner::next(uint8_t &kind, uint32_t &payload) {
+    _payload = 0;
+    kind = static_cast<uint8_t>(scan_token());
+    payload = _payload;
+}
+
+TokenType Scanner::scan_token() {
     // Skip whitespace and peek the first character
     int ch = next_char();
 
     // Determine the type based on the first character
     switch (ch) {
     case char_traits<char>::eof():
-        _token = TokenFactory::getToken(TokenType::T_EOF);
-        return;
+        return TokenType::T_EOF;
     case '*':
-        _token = TokenFactory::getToken(TokenType::STAR);
-        return;
+        return TokenType::STAR;
     case '/':
-        _token = TokenFactory::getToken(TokenType::SLASH);
-        return;
+        return TokenType::SLASH;
     case '%':
-        _token = TokenFactory::getToken(TokenType::MOD);
-        return;
+        return TokenType::MOD;
     case '^':
-        _token = TokenFactory::getToken(TokenType::XOR);
-        return;
+        return TokenType::XOR;
     case '~':
-        _token = TokenFactory::getToken(TokenType::INVERT);
-        return;
+        return TokenType::INVERT;
     case ';':
-        _token = TokenFactory::getToken(TokenType::SEMI);
-        return;
+        return TokenType::SEMI;
     case ',':
-        _token = TokenFactory::getToken(TokenType::COMMA);
-        return;
+        return TokenType::COMMA;
     case '{':
-        _token = TokenFactory::getToken(TokenType::LBRACE);
-        return;
+        return TokenType::LBRACE;
     case '}':
-        _token = TokenFactory::getToken(TokenType::RBRACE);
-        return;
+        return TokenType::RBRACE;
     case '(':
-        _token = TokenFactory::getToken(TokenType::LPAREN);
-        return;
+        return TokenType::LPAREN;
     case ')':
-        _token = TokenFactory::getToken(TokenType::RPAREN);
-        return;
+        return TokenType::RPAREN;
     case '[':
-        _token = TokenFactory::getToken(TokenType::LBRACKET);
-        return;
+        return TokenType::LBRACKET;
     case ']':
-        _token = TokenFactory::getToken(TokenType::RBRACKET);
-        return;
+        return TokenType::RBRACKET;
     case '+':
-        ch = _input.peek();
-        if (ch == '+') {
-            _input.get();
-            _token = TokenFactory::getToken(TokenType::INC);
-        } else {
-            _token = TokenFactory::getToken(TokenType::PLUS);
-        }
-        return;
+        return accept('+') ? TokenType::INC : TokenType::PLUS;
     case '-':
-        ch = _input.peek();
-        if (ch == '-') {
-            _input.get();
-            _token = TokenFactory::getToken(TokenType::DEC);
-        } else {
-            _token = TokenFactory::getToken(TokenType::MINUS);
-        }
-        return;
+        return accept('-') ? TokenType::DEC : TokenType::MINUS;
     case '|':
-        ch = _input.peek();
-        if (ch == '|') {
-            _input.get();
-            _token = TokenFactory::getToken(TokenType::LOGICAL_OR);
-        } else {
-            _token = TokenFactory::getToken(TokenType::OR);
-        }
-        return;
+        return accept('|') ? TokenType::LOGICAL_OR : TokenType::OR;
     case '&':
-        ch = _input.peek();
-        if (ch == '&') {
-            _input.get();
-            _token = TokenFactory::getToken(TokenType::LOGICAL_AND);
-        } else {
-            _token = TokenFactory::getToken(TokenType::AND);
-        }
-        return;
+        return accept('&') ? TokenType::LOGICAL_AND : TokenType::AND;
     case '=':
-        ch = _input.peek();
-        if (ch == '=') {
-            _input.get();
-            _token = TokenFactory::getToken(TokenType::EQUALS);
-        } else {
-            _token = TokenFactory::getToken(TokenType::ASSIGN);
-        }
-        return;
+        return accept('=') ? TokenType::EQUALS : TokenType::ASSIGN;
     case '!':
-        ch = _input.peek();
-        if (ch == '=') {
-            _input.get();
-            _token = TokenFactory::getToken(TokenType::NEQ);
-        } else {
-            _token = TokenFactory::getToken(TokenType::NOT);
-        }
-        return;
+        return accept('=') ? TokenType::NEQ : TokenType::NOT;
     case '<':
-        ch = _input.peek();
-        if (ch == '=') {
-            _input.get();
-            _token = TokenFactory::getToken(TokenType::LESS_EQ);
-        } else if (ch == '<') {
-            _input.get();
-            _token = TokenFactory::getToken(TokenType::L_SHIFT);
-        } else {
-            _token = TokenFactory::getToken(TokenType::LESS);
-        }
-        return;
+        if (accept('='))
+            return TokenType::LESS_EQ;
+        return accept('<') ? TokenType::L_SHIFT : TokenType::LESS;
     case '>':
-        ch = _input.peek();
-        if (ch == '=') {
-            _input.get();
-            _token = TokenFactory::getToken(TokenType::GREATER_EQ);
-        } else if (ch == '>') {
-            _input.get();
-            _token = TokenFactory::getToken(TokenType::R_SHIFT);
-        } else {
-            _token = TokenFactory::getToken(TokenType::GREATER);
-        }
-        return;
+        if (accept('='))
+            return TokenType::GREATER_EQ;
+        return accept('>') ? TokenType::R_SHIFT : TokenType::GREATER;
     case '.':
-        ch = _input.peek();
-        if (ch == '.') {
-            _input.get();
-            ch = _input.get();
-            if (ch != '.')
-                break;
-            _token = TokenFactory::getToken(TokenType::ELLIPSIS);
-        } else {
-            _token = TokenFactory::getToken(TokenType::DOT);
-        }
-        return;
+        if (!accept('.'))
+            return TokenType::DOT;
+        if (get() != '.')
+            break;
+        return TokenType::ELLIPSIS;
     case '\'':
-        _token = TokenFactory::getIntegerLiteral(scan_char());
-        return;
+        _integer = scan_char();
+        return TokenType::INT_LITERAL;
     case '"':
-        _token = TokenFactory::getStringLiteral(scan_string());
-        return;
+        _payload = Interner::intern(scan_string()).id();
+        return TokenType::STRING_LITERAL;
     default:
         if (isdigit(ch)) {
-            _token = TokenFactory::getIntegerLiteral(scan_int(ch));
-            return;
+            _integer = scan_int(ch);
+            return TokenType::INT_LITERAL;
         }
 
         if (isalpha(ch) || ch == '_') {
-            if (string str = scan_identifier(ch); keywords.contains(str)) {
-                _token = TokenFactory::getToken(keywords.at(str));
-            } else {
-                _token = TokenFactory::getIdentifier(str);
-            }
-            return;
+            string_view str = scan_identifier();
+            if (const TokenType *keyword = find_keyword(str))
+                return *keyword;
+            _payload = Interner::intern(str).id();
+            return TokenType::IDENTIFIER;
         }
     }
 
     // If we reach here, there is an unrecognized token
-    throw SyntaxException("unrecognized character " + to_string(ch), _line);
+    throw SyntaxException("unrecognized character " + to_string(ch), location());
 }
 
 int Scanner::next_char() {
-    while (isspace(_input.peek())) {
-        if (_input.peek() == '\n')
-            _line++;
-        _input.get();
-    }
-
-    return _input.get();
+    _cur = ScanKernel::skip_whitespace(_cur, _end);
+    _token_start = _cur;
+    return get();
 }
 
-int Scanner::scan_int(int c) {
-    int k = c - '0';
+long long Scanner::scan_int(int c) {
+    long long k = c - '0';
 
-    // Convert each character into an integer and add it to the total
-    while (isdigit(_input.peek())) {
-        c = _input.get();
-        k = k * 10 + (c - '0');
+    // Find the end of the digits, then convert them into an integer
+    const char *end = ScanKernel::digit_end(_cur, _end);
+    for (; _cur < end; _cur++) {
+        k = k * 10 + (*_cur - '0');
     }
 
     return k;
 }
 
-string Scanner::scan_identifier(int c) {
-    string identifier{static_cast<char>(c)};
+string_view Scanner::scan_identifier() {
+    // The first character has already been consumed
+    const char *start = _cur - 1;
 
-    // Add each character to the identifier
-    while (isalnum(_input.peek()) || _input.peek() == '_') {
-        identifier += _input.get();
-    }
+    // Find the end of the identifier
+    _cur = ScanKernel::identifier_end(_cur, _end);
 
-    return identifier;
+    return {start, static_cast<size_t>(_cur - start)};
 }
 
 int Scanner::scan_escape_sequence() {
-    int ch = _input.get();
+    int ch = get();
 
     // Deal with escape sequences
     if (ch == '\\') {
-        ch = _input.get();
+        ch = get();
         switch (ch) {
         case 'a':
             return '\a';
@@ -258,7 +239,7 @@ int Scanner::scan_escape_sequence() {
         case '\'':
             return '\'';
         default:
-            throw SyntaxException("invalid escape sequence", _line);
+            throw SyntaxException("invalid escape sequence", location());
         }
     }
 
@@ -269,19 +250,32 @@ int Scanner::scan_char() {
     int ch = scan_escape_sequence();
 
     // Ensure that the character is closed
-    if (_input.get() != '\'')
-        throw SyntaxException("expected closing '", _line);
+    if (get() != '\'')
+        throw SyntaxException("expected closing '", location());
 
     return ch;
 }
 
-string Scanner::scan_string() {
-    string str;
-    int ch;
-    while ((ch = scan_escape_sequence()) != '"') {
-        str += ch;
+string_view Scanner::scan_string() {
+    const char *start = _cur;
+
+    // Fast path: without escape sequences the literal is a slice of the input
+    while (_cur < _end && *_cur != '"' && *_cur != '\\')
+        _cur++;
+    if (_cur == _end)
+        throw SyntaxException("expected closing \"", location());
+    if (*_cur == '"')
+        return {start, static_cast<size_t>(_cur++ - start)};
+
+    // Otherwise decode the rest of the literal into the buffer
+    _string_buffer.assign(start, _cur);
+    while (peek() != '"') {
+        if (peek() == char_traits<char>::eof())
+            throw SyntaxException("expected closing \"", location());
+        _string_buffer += static_cast<char>(scan_escape_sequence());
     }
-    return str;
+    get();
+    return _string_buffer;
 }
 
 } // namespace myComp
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SourceBuffer.h"
+#include "Errors.h"
+
+namespace myComp {
+std::string SourceLocation::str() const {
+    return "line " + std::to_string(line) + ", column " +
+           std::to_string(column);
+}
+
+void SourceBuffer::open(const std::string &filename) {
+    close();
+
+    // Use the standard input
+    if (filename == "-") {
+        read_all(STDIN_FILENO, filename);
+        return;
+    }
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw IOException("cannot open file " + filename);
+
+    // Only regular files can be mapped
+    struct stat st {};
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        // Token offsets are 32-bit
+        if (st.st_size > std::numeric_limits<uint32_t>::max()) {
+            ::close(fd);
+            throw IOException("file too large " + filename);
+        }
+
+        void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            // The scanner walks the file from the beginning to the end
+            madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+            data_ = static_cast<const char *>(addr);
+            size_ = st.st_size;
+            mapped_ = true;
+            ::close(fd);
+            return;
+        }
+    }
+
+    // Fall back to reading the file
+    read_all(fd, filename);
+    ::close(fd);
+}
+
+void SourceBuffer::close() {
+    if (mapped_)
+        munmap(const_cast<char *>(data_), size_);
+    fallback_.clear();
+    line_starts_.clear();
+    data_ = "";
+    size_ = 0;
+    mapped_ = false;
+}
+
+void SourceBuffer::read_all(int fd, const std::string &filename) {
+    char chunk[65536];
+    while (true) {
+        ssize_t n = ::read(fd, chunk, sizeof(chunk));
+        if (n == 0)
+            break;
+        if (n < 0)
+            throw IOException("cannot read file " + filename);
+        fallback_.append(chunk, n);
+        if (fallback_.size() > std::numeric_limits<uint32_t>::max())
+            throw IOException("file too large " + filename);
+    }
+
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+}
+
+SourceLocation SourceBuffer::location(uint32_t offset) const {
+    if (line_starts_.empty()) {
+        line_starts_.push_back(0);
+        for (const char *p = data_, *end = data_ + size_;
+             (p = static_cast<const char *>(memchr(p, '\n', end - p)));) {
+            ++p;
+            line_starts_.push_back(p - data_);
+        }
+    }
+
+    // The last line starting at or before the offset
+    auto it = std::upper_bound(line_starts_.begin(), line_starts_.end(), offset);
+    int line = static_cast<int>(it - line_starts_.begin());
+    return {line, static_cast<int>(offset - *(it - 1)) + 1};
+}
+} // namespace myComp
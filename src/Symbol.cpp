@@ -0,0 +1,68 @@
+#include <cstring>
+
+#include "Errors.h"
+#include "Symbol.h"
+
+namespace myComp {
+Interner::Interner()
+    : segments_(std::make_unique<std::unique_ptr<std::string_view[]>[]>(
+          MAX_SEGMENTS)) {
+    // Id 0 is reserved for the empty string
+    segments_[0] = std::make_unique<std::string_view[]>(SEGMENT_SIZE);
+    count_ = 1;
+    ids_.emplace(std::string_view(), 0);
+}
+
+Symbol Interner::intern(std::string_view str) {
+    // The symbols a thread has already seen are found without the lock
+    thread_local std::unordered_map<std::string_view, uint32_t> seen;
+    if (auto it = seen.find(str); it != seen.end())
+        return Symbol(it->second);
+
+    Interner &interner = get();
+    std::lock_guard lock(interner.mutex_);
+    auto it = interner.ids_.find(str);
+    if (it == interner.ids_.end()) {
+        uint32_t id = interner.count_;
+        if (id >> SEGMENT_BITS >= MAX_SEGMENTS)
+            throw LogicException("too many symbols");
+        auto &segment = interner.segments_[id >> SEGMENT_BITS];
+        if (segment == nullptr)
+            segment = std::make_unique<std::string_view[]>(SEGMENT_SIZE);
+
+        std::string_view stored = interner.store(str);
+        segment[id & (SEGMENT_SIZE - 1)] = stored;
+        interner.count_++;
+        it = interner.ids_.emplace(stored, id).first;
+    }
+    seen.emplace(it->first, it->second);
+    return Symbol(it->second);
+}
+
+size_t Interner::size() {
+    Interner &interner = get();
+    std::lock_guard lock(interner.mutex_);
+    return interner.count_;
+}
+
+std::string_view Interner::store(std::string_view str) {
+    // Long strings get a block of their own, inserted before the current
+    // block so that it stays the last one
+    if (str.size() > BLOCK_SIZE / 4) {
+        auto pos = blocks_.empty() ? blocks_.end() : blocks_.end() - 1;
+        char *dest = blocks_.insert(pos, std::make_unique<char[]>(str.size()))
+                         ->get();
+        std::memcpy(dest, str.data(), str.size());
+        return {dest, str.size()};
+    }
+
+    if (block_used_ + str.size() > BLOCK_SIZE) {
+        blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+        block_used_ = 0;
+    }
+    char *dest = blocks_.back().get() + block_used_;
+    std::memcpy(dest, str.data(), str.size());
+    block_used_ += str.size();
+    return {dest, str.size()};
+}
+} // namespace myComp
@@ -0,0 +1,51 @@
+#include "ThreadPool.h"
+
+namespace myComp {
+ThreadPool::ThreadPool(size_t threads) {
+    for (size_t i = 0; i < threads; i++)
+        threads_.emplace_back([this] { work(); });
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto &thread : threads_)
+        thread.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard lock(mutex_);
+        tasks_.push(std::move(task));
+    }
+    ready_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock lock(mutex_);
+    idle_.wait(lock, [this] { return tasks_.empty() && running_ == 0; });
+}
+
+void ThreadPool::work() {
+    std::unique_lock lock(mutex_);
+    while (true) {
+        ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+        if (tasks_.empty())
+            return;
+
+        auto task = std::move(tasks_.front());
+        tasks_.pop();
+        running_++;
+        lock.unlock();
+        task();
+        lock.lock();
+        running_--;
+        if (tasks_.empty() && running_ == 0)
+            idle_.notify_all();
+    }
+}
+} // namespace myComp
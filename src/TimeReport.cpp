@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sys/resource.h>
+
+#include "TimeReport.h"
+
+namespace {
+using namespace myComp;
+
+// Whether operator new counts, set before any worker thread starts
+bool counting = false;
+
+// Allocations of the current thread, a file is compiled on a single thread
+thread_local size_t allocation_count = 0;
+thread_local size_t allocation_bytes = 0;
+
+// Peak resident set of the process in kilobytes
+long peak_rss_kb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Write a string as a JSON string
+void write_json(std::ostream &os, std::string_view str) {
+    os << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            os << '\\';
+        os << c;
+    }
+    os << '"';
+}
+} // namespace
+
+// Count the allocations once the report asks for it, the other forms of
+// operator new and delete go through these
+void *operator new(std::size_t size) {
+    if (counting) {
+        allocation_count++;
+        allocation_bytes += size;
+    }
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace myComp {
+void TimeReport::start(std::string_view phase) {
+    stop();
+
+    auto it = std::find_if(phases_.begin(), phases_.end(),
+                           [&](const Phase &p) { return p.name == phase; });
+    if (it == phases_.end()) {
+        phases_.push_back({std::string(phase)});
+        it = phases_.end() - 1;
+    }
+    current_ = static_cast<int>(it - phases_.begin());
+    start_rss_kb_ = peak_rss_kb();
+    start_allocations_ = allocations();
+    start_bytes_ = allocated_bytes();
+    started_ = Clock::now();
+}
+
+void TimeReport::stop() {
+    if (current_ < 0)
+        return;
+    auto now = Clock::now();
+    Phase &phase = phases_[current_];
+    phase.milliseconds +=
+        std::chrono::duration<double, std::milli>(now - started_).count();
+    phase.peak_rss_kb += peak_rss_kb() - start_rss_kb_;
+    phase.allocations += allocations() - start_allocations_;
+    phase.bytes += allocated_bytes() - start_bytes_;
+    events_.push_back({phase.name, "phase", microseconds(started_),
+                       microseconds(now) - microseconds(started_)});
+    current_ = -1;
+}
+
+void TimeReport::split(std::string_view from, std::string_view phase,
+                       const Usage &usage) {
+    auto find = [&](std::string_view name) {
+        return std::find_if(phases_.begin(), phases_.end(),
+                            [&](const Phase &p) { return p.name == name; });
+    };
+    auto source = find(from);
+    if (source == phases_.end())
+        return;
+    source->milliseconds -= usage.milliseconds;
+    source->allocations -= usage.allocations;
+    source->bytes -= usage.bytes;
+
+    auto it = find(phase);
+    if (it == phases_.end())
+        it = phases_.insert(source, {std::string(phase)});
+    it->milliseconds += usage.milliseconds;
+    it->allocations += usage.allocations;
+    it->bytes += usage.bytes;
+}
+
+TimeReport::Usage TimeReport::usage(std::string_view phase) const {
+    for (const auto &p : phases_) {
+        if (p.name == phase)
+            return {p.milliseconds, p.allocations, p.bytes};
+    }
+    return {};
+}
+
+void TimeReport::function(Symbol name, Clock::time_point start,
+                          Clock::time_point end) {
+    functions_.emplace_back(
+        name.view(),
+        std::chrono::duration<double, std::milli>(end - start).count());
+    events_.push_back({std::string(name.view()), "function",
+                       microseconds(start),
+                       microseconds(end) - microseconds(start)});
+}
+
+void TimeReport::merge(const TimeReport &other, std::string_view file,
+                       int thread) {
+    for (const auto &phase : other.phases_) {
+        auto it = std::find_if(
+            phases_.begin(), phases_.end(),
+            [&](const Phase &p) { return p.name == phase.name; });
+        if (it == phases_.end()) {
+            phases_.push_back({phase.name});
+            it = phases_.end() - 1;
+        }
+        it->milliseconds += phase.milliseconds;
+        it->peak_rss_kb += phase.peak_rss_kb;
+        it->allocations += phase.allocations;
+        it->bytes += phase.bytes;
+    }
+    for (const auto &[name, milliseconds] : other.functions_)
+        functions_.emplace_back(std::string(file) + ':' + name, milliseconds);
+
+    // The intervals of the other report start from its own creation
+    double offset = microseconds(other.origin_);
+    for (Event event : other.events_) {
+        event.start += offset;
+        event.thread = thread;
+        events_.push_back(std::move(event));
+    }
+}
+
+void TimeReport::print(std::ostream &os, size_t slowest,
+                       bool concurrent) const {
+    Phase total{"total"};
+    for (const auto &phase : phases_) {
+        total.milliseconds += phase.milliseconds;
+        total.peak_rss_kb += phase.peak_rss_kb;
+        total.allocations += phase.allocations;
+        total.bytes += phase.bytes;
+    }
+
+    auto flags = os.flags();
+    os << "===----- Time report -----===\n"
+       << std::left << std::setw(16) << "phase" << std::right << std::setw(12)
+       << "wall (ms)";
+    if (!concurrent)
+        os << std::setw(14) << "peak RSS +KB";
+    os << std::setw(14) << "allocations" << std::setw(14) << "bytes" << '\n';
+    auto row = [&](const Phase &phase) {
+        os << std::left << std::setw(16) << phase.name << std::right
+           << std::fixed << std::setprecision(3) << std::setw(12)
+           << phase.milliseconds;
+        if (!concurrent)
+            os << std::setw(14) << phase.peak_rss_kb;
+        os << std::setw(14) << phase.allocations << std::setw(14)
+           << phase.bytes << '\n';
+    };
+    for (const auto &phase : phases_)
+        row(phase);
+    row(total);
+
+    // Files compiled at once share the memory of the process, the growth
+    // during a phase is not its own
+    if (concurrent)
+        os << "peak RSS of the process (KB): " << peak_rss_kb() << '\n';
+
+    // The slowest functions first
+    auto functions = functions_;
+    size_t count = std::min(slowest, functions.size());
+    std::partial_sort(functions.begin(), functions.begin() + count,
+                      functions.end(), [](const auto &a, const auto &b) {
+                          return a.second > b.second;
+                      });
+    if (count > 0)
+        os << "slowest functions (ms):\n";
+    for (size_t i = 0; i < count; i++) {
+        os << "  " << std::left << std::setw(28) << functions[i].first
+           << std::right << std::fixed << std::setprecision(3)
+           << std::setw(12) << functions[i].second << '\n';
+    }
+    os.flags(flags);
+}
+
+void TimeReport::write_trace(std::ostream &os) const {
+    os << "{\"traceEvents\":[";
+    for (size_t i = 0; i < events_.size(); i++) {
+        const Event &event = events_[i];
+        os << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+        write_json(os, event.name);
+        os << ",\"cat\":\"" << event.category
+           << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+           << ",\"ts\":" << std::fixed
+           << std::setprecision(3) << event.start
+           << ",\"dur\":" << event.duration << '}';
+    }
+    os << "\n]}\n";
+}
+
+void TimeReport::count_allocations() { counting = true; }
+
+size_t TimeReport::allocations() { return allocation_count; }
+
+size_t TimeReport::allocated_bytes() { return allocation_bytes; }
+
+double TimeReport::microseconds(Clock::time_point time) const {
+    return std::chrono::duration<double, std::micro>(time - origin_).count();
+}
+} // namespace myComp
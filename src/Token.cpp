@@ -57,33 +57,11 @@ string Token::str() const {
         return "int_literal(" + to_string(int_val_) + ")";
 
     if (type_ == TokenType::STRING_LITERAL)
-        return "string_literal(" + str_val_ + ")";
+        return "string_literal(" + symbol_.str() + ")";
 
     if (type_ == TokenType::IDENTIFIER)
-        return "identifier(" + str_val_ + ")";
+        return "identifier(" + symbol_.str() + ")";
 
     return token_str.at(type_);
 }
-
-unordered_map<string, Token> &TokenFactory::getCache() {
-    static unordered_map<string, Token> cache;
-    return cache;
-}
-
-Token *TokenFactory::getOrCreate(TokenType type, long long int_val,
-                                 const string &str_val) {
-    string str = token_str.at(type);
-    if (type == TokenType::INT_LITERAL)
-        str += "(" + to_string(int_val) + ")";
-    else if (type == TokenType::STRING_LITERAL || type == TokenType::IDENTIFIER)
-        str += "(" + str_val + ")";
-    if (const auto it = getCache().find(str); it != getCache().end())
-        return &it->second;
-    if (type == TokenType::INT_LITERAL)
-        return &getCache().emplace(str, Token(type, int_val, "")).first->second;
-    if (type == TokenType::STRING_LITERAL || type == TokenType::IDENTIFIER)
-        return &getCache().emplace(str, Token(type, 0, str_val)).first->second;
-    return &getCache().emplace(str, Token(type, 0, "")).first->second;
-}
-
 } // namespace myComp
\ No newline at end of file
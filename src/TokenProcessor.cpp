@@ -3,40 +3,103 @@
 namespace myComp {
 
 void TokenProcessor::print(std::ostream &output) {
-    for (auto &token : tokens) {
-        output << token->str() << std::endl;
+    // Only the tokens still buffered can be printed
+    for (size_t i = current_token; i + 1 < scanned; i++) {
+        output << token_at(i).str() << std::endl;
     }
 }
 
 void TokenProcessor::process() {
-    scanner.next();
-    while (scanner.get_token()->type() != TokenType::T_EOF) {
-        tokens.push_back(scanner.get_token());
-        line_numbers.push_back(scanner.get_line());
-        scanner.next();
-    }
+    while (!done)
+        push();
+}
+
+void TokenProcessor::stream() {
+    mask = LOOKAHEAD - 1;
+    kinds.resize(LOOKAHEAD);
+    payloads.resize(LOOKAHEAD);
+    offsets.resize(LOOKAHEAD);
+    integers.resize(LOOKAHEAD);
 }
 
-std::pair<Token *, int> TokenProcessor::next_token() {
-    if (current_token >= tokens.size()) {
-        return {nullptr, -1};
+void TokenProcessor::scan() {
+    // The parser only ran past the end when T_EOF is not buffered
+    if (done)
+        throw LogicException("read past the end of the tokens");
+
+    if (!measured) {
+        // Tokens before current_token are consumed, their slots can be reused
+        while (!done && scanned - current_token < LOOKAHEAD)
+            push();
+        return;
     }
-    Token *token = tokens[current_token];
-    int line_number = line_numbers[current_token];
-    current_token++;
-    return {token, line_number};
+
+    auto start = TimeReport::Clock::now();
+    size_t allocations = TimeReport::allocations();
+    size_t bytes = TimeReport::allocated_bytes();
+    while (!done && scanned - current_token < LOOKAHEAD)
+        push();
+    usage.milliseconds += std::chrono::duration<double, std::milli>(
+                              TimeReport::Clock::now() - start)
+                              .count();
+    usage.allocations += TimeReport::allocations() - allocations;
+    usage.bytes += TimeReport::allocated_bytes() - bytes;
 }
-std::pair<Token *, int> TokenProcessor::peek_token() {
-    if (current_token >= tokens.size()) {
-        return {nullptr, -1};
+
+void TokenProcessor::push() {
+    size_t slot = scanned++ & mask;
+    if (slot == kinds.size()) {
+        kinds.emplace_back();
+        payloads.emplace_back();
+        offsets.emplace_back();
     }
-    return {tokens[current_token], line_numbers[current_token]};
+
+    scanner.next(kinds[slot], payloads[slot]);
+    offsets[slot] = scanner.get_offset();
+    auto type = static_cast<TokenType>(kinds[slot]);
+    if (type == TokenType::INT_LITERAL) {
+        // A growing pool in eager mode, the token's own slot in streaming mode
+        size_t index = mask == SIZE_MAX ? integers.size() : slot;
+        if (index == integers.size())
+            integers.emplace_back();
+        integers[index] = scanner.integer();
+        payloads[slot] = static_cast<uint32_t>(index);
+    }
+    done = type == TokenType::T_EOF;
+}
+
+Token TokenProcessor::token_at(size_t index) const {
+    size_t slot = index & mask;
+    auto type = static_cast<TokenType>(kinds[slot]);
+    if (type == TokenType::INT_LITERAL)
+        return {type, integers[payloads[slot]], Symbol()};
+    return {type, 0, Symbol::from_id(payloads[slot])};
+}
+
+Token TokenProcessor::next_token() {
+    fill();
+    Token token = token_at(current_token);
+    // Stay on the trailing T_EOF
+    if (token.type() != TokenType::T_EOF)
+        current_token++;
+    return token;
+}
+
+Token TokenProcessor::peek_token() {
+    fill();
+    return token_at(current_token);
+}
+
+size_t TokenProcessor::expect(TokenType type) {
+    TokenType got = peek_type();
+    if (got != type)
+        throw UnexpectedTokenException(got, current_location(), type);
+    return current_token++ & mask;
 }
 
 Type *TokenProcessor::next_data_type() {
-    auto [token, line] = this->next_token();
     Type *ret = nullptr;
-    switch (token->type()) {
+    switch (peek_type()) {
     case TokenType::VOID:
         ret = TypeFactory::get_void();
         break;
@@ -50,47 +113,27 @@ Type *TokenProcessor::next_data_type() {
         ret = TypeFactory::get_signed(8);
         break;
     default:
-        throw InvalidException("data type", line);
+        throw InvalidException("data type", current_location());
     }
-    // std::tie(token, line) = this->next_token();
-    while (this->peek_token().first->type() == TokenType::STAR) {
+    this->next_token();
+    while (this->peek_type() == TokenType::STAR) {
         ret = TypeFactory::get_pointer(ret);
         this->next_token();
     }
     return ret;
 }
 
-std::string TokenProcessor::next_identifier() {
-    auto [token, line] = this->next_token();
-    if (token->type() != TokenType::IDENTIFIER) {
-        throw UnexpectedTokenException(token->type(), line,
-                                       TokenType::IDENTIFIER);
-    }
-    return token->string_val();
+Symbol TokenProcessor::next_identifier() {
+    return Symbol::from_id(payloads[expect(TokenType::IDENTIFIER)]);
 }
 
-void TokenProcessor::match(TokenType type) {
-    auto [token, line] = this->next_token();
-    if (token->type() != type) {
-        throw UnexpectedTokenException(token->type(), line, type);
-    }
-}
+void TokenProcessor::match(TokenType type) { expect(type); }
 
 long long TokenProcessor::next_integer() {
-    auto [token, line] = this->next_token();
-    if (token->type() != TokenType::INT_LITERAL) {
-        throw UnexpectedTokenException(token->type(), line,
-                                       TokenType::INT_LITERAL);
-    }
-    return token->integer_val();
+    return integers[payloads[expect(TokenType::INT_LITERAL)]];
 }
 
-std::string TokenProcessor::next_string() {
-    auto [token, line] = this->next_token();
-    if (token->type() != TokenType::STRING_LITERAL) {
-        throw UnexpectedTokenException(token->type(), line,
-                                       TokenType::STRING_LITERAL);
-    }
-    return token->string_val();
+Symbol TokenProcessor::next_string() {
+    return Symbol::from_id(payloads[expect(TokenType::STRING_LITERAL)]);
 }
-} // namespace myComp
\ No newline at end of file
+} // namespace myComp
@@ -1,3 +1,5 @@
+#include <cstdint>
+
 #include "Type.h"
 #include "Errors.h"
 namespace {
@@ -174,4 +176,15 @@ Type *int_literal_type(long long val) {
         return TypeFactory::get_signed(4);
     return TypeFactory::get_signed(8);
 }
+
+long long normalize(long long value, const Type *type) {
+    size_t bits = type->size() * 8;
+    if (bits >= 64)
+        return value;
+    uint64_t mask = (uint64_t{1} << bits) - 1;
+    uint64_t raw = static_cast<uint64_t>(value) & mask;
+    if (type->is_signed() && (raw >> (bits - 1)) != 0)
+        raw |= ~mask;
+    return static_cast<long long>(raw);
+}
 } // namespace myComp
\ No newline at end of file
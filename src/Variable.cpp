@@ -2,44 +2,49 @@
 #include "Context.h"
 #include "Errors.h"
 namespace myComp {
-Variable *VariableManager::find(const std::string &name) {
-    auto &cache = getCache();
+Variable *VariableManager::find(Symbol name) {
+    auto &index = getCache().index;
 
     // Search for the variable in current scope
-    auto it = cache.find(Context::get_name() + "_" + name);
-    if (it != cache.end()) {
-        return it->second.get();
+    auto it = index.find(key(Context::get_name(), name));
+    if (it != index.end()) {
+        return it->second;
     }
 
     // Search for the variable in global scope
-    it = cache.find("global_" + name);
-    if (it != cache.end()) {
-        return it->second.get();
+    it = index.find(key(Context::global(), name));
+    if (it != index.end()) {
+        return it->second;
     }
 
-    throw LogicException("Variable " + name + " not defined");
+    throw LogicException("Variable " + name.str() + " not defined");
 }
 
-void VariableManager::insert(Type *type, const std::string &name,
-                             const std::string &scope) {
-    if (getCache().contains(scope + "_" + name)) {
-        throw LogicException("Variable " + name + " already defined" + " in " +
-                             scope);
+void VariableManager::insert(Type *type, Symbol name, Symbol scope) {
+    auto &cache = getCache();
+    if (cache.index.contains(key(scope, name))) {
+        throw LogicException("Variable " + name.str() + " already defined" +
+                             " in " + scope.str());
     }
 
-    auto &cache = getCache();
-    cache[scope + "_" + name] = std::make_unique<Variable>(type, name, scope);
+    cache.variables.push_back(
+        std::make_unique<Variable>(Variable{type, name, scope}));
+    cache.index[key(scope, name)] = cache.variables.back().get();
 }
 
-std::vector<Variable *>
-VariableManager::get_variables_in_scope(const std::string &scope) {
+std::vector<Variable *> VariableManager::get_variables_in_scope(Symbol scope) {
     std::vector<Variable *> ret;
-    auto &cache = getCache();
-    for (auto &it : cache) {
-        if (it.second->scope == scope) {
-            ret.push_back(it.second.get());
+    for (auto &var : getCache().variables) {
+        if (var->scope == scope) {
+            ret.push_back(var.get());
         }
     }
     return ret;
 }
-} // namespace myComp
\ No newline at end of file
+
+void VariableManager::clear() {
+    auto &cache = getCache();
+    cache.index.clear();
+    cache.variables.clear();
+}
+} // namespace myComp
@@ -1,38 +1,152 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
 #include "X86_CodeGenerator.h"
+#include "Context.h"
 #include "data.h"
 #include "Errors.h"
+
+namespace {
+using namespace myComp;
+
+// Condition code of a relation, unsigned values and pointers compare below
+// and above
+X86Cond condition_code(Comparison relation, Type *type) {
+    bool is_signed = type->is_signed();
+    switch (relation) {
+    case Comparison::EQUAL:
+        return X86Cond::E;
+    case Comparison::NOT_EQUAL:
+        return X86Cond::NE;
+    case Comparison::LESS:
+        return is_signed ? X86Cond::L : X86Cond::B;
+    case Comparison::LESS_EQUAL:
+        return is_signed ? X86Cond::LE : X86Cond::BE;
+    case Comparison::GREATER:
+        return is_signed ? X86Cond::G : X86Cond::A;
+    case Comparison::GREATER_EQUAL:
+        return is_signed ? X86Cond::GE : X86Cond::AE;
+    default:
+        throw LogicException("Invalid comparison");
+    }
+}
+
+// Multiplier of a division by a constant, the quotient is the high half of
+// the product shifted right, with the dividend added or subtracted first when
+// the multiplier does not fit
+struct Magic {
+    uint64_t multiplier;
+    int shift;
+    bool add;
+};
+
+// Magic numbers of Hacker's Delight, chapter 10, for N-bit operations
+// `d` is the divisor in two's complement, |d| >= 2 and not a power of 2
+template <typename U> Magic signed_magic(U d) {
+    constexpr int N = sizeof(U) * 8;
+    constexpr U two = U(1) << (N - 1);
+    U ad = d >> (N - 1) ? U(0) - d : d;
+    U t = two + (d >> (N - 1));
+    U anc = t - 1 - t % ad;
+    int p = N - 1;
+    U q1 = two / anc;
+    U r1 = two - q1 * anc;
+    U q2 = two / ad;
+    U r2 = two - q2 * ad;
+    U delta;
+    do {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad) {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    U m = q2 + 1;
+    if (d >> (N - 1))
+        m = U(0) - m;
+    return {m, p - N, false};
+}
+
+// `d` is at least 2 and not a power of 2
+template <typename U> Magic unsigned_magic(U d) {
+    constexpr int N = sizeof(U) * 8;
+    constexpr U max_signed = (U(1) << (N - 1)) - 1;
+    bool add = false;
+    int p = N - 1;
+    U q = max_signed / d;
+    U r = max_signed - q * d;
+    U power = 0;
+    U delta;
+    do {
+        p++;
+        power = p == N ? 1 : power * 2;
+        if (r + 1 >= d - r) {
+            add |= q >= max_signed;
+            q = 2 * q + 1;
+            r = 2 * r + 1 - d;
+        } else {
+            add |= q >= max_signed + 1;
+            q = 2 * q;
+            r = 2 * r + 1;
+        }
+        delta = d - 1 - r;
+    } while (p < 2 * N && power < delta);
+    return {static_cast<U>(q + 1), p - N, add};
+}
+} // namespace
+
 namespace myComp {
 void X86_CodeGenerator::set_output(std::string_view filename) {
-    output_file_.open(filename.data());
-    if (!output_file_.is_open()) {
-        throw IOException("cannot open file " + std::string(filename));
+    // An object file unless assembly is asked for
+    if (filename.ends_with(".o")) {
+        output_ = std::make_unique<X86_ElfOutput>(filename);
+    } else {
+        output_ = std::make_unique<X86_AsmOutput>(filename);
     }
 }
 
-void X86_CodeGenerator::free_register(int reg) {
-    if (reg < 0 || reg >= NUM_REGISTERS) {
-        throw InvalidException("register index " + std::to_string(reg));
+void X86_CodeGenerator::set_jit() {
+    output_ = std::make_unique<X86_JitOutput>();
+}
+
+int X86_CodeGenerator::run_main() {
+    auto *jit = dynamic_cast<X86_JitOutput *>(output_.get());
+    if (jit == nullptr) {
+        throw LogicException("The code is not in memory");
     }
-    if (free_registers_[reg]) {
-        throw LogicException("register double free");
+    if (main_ == nullptr) {
+        throw InvalidException("program without a main function");
     }
-    free_registers_[reg] = true;
-}
 
-void X86_CodeGenerator::function_prelude(std::string_view name) {
-    // Prelude assembly code
-    output_file_ << "\t.text\n"
-                 << "\t.globl\t" << name << "\n"
-                 << "\t.type\t" << name << ", @function\n"
-                 << name << ":\n"
-                 << "\tpushq\t%rbp\n"
-                 << "\tmovq\t%rsp, %rbp\n";
+    void *address = jit->address(main_->name_);
+    if (main_->return_type_->is_void()) {
+        reinterpret_cast<void (*)()>(address)();
+        return 0;
+    }
+    return reinterpret_cast<int (*)()>(address)();
+}
 
+void X86_CodeGenerator::function_prelude(FunctionPrototype *function) {
     // Mark the start of a function
     in_function_ = true;
 
-    // Record the function name
-    function_name_ = name;
+    // Record the function prototype
+    function_ = function;
+
+    // Start an empty function
+    code_.clear();
+    next_register_ = X86Reg::FIRST_VIRTUAL;
 
     // Initialize stack size = 0
     stack_size_ = 0;
@@ -45,16 +159,108 @@ void X86_CodeGenerator::function_postlude() {
     // Generate end label
     add_label(end_label_);
 
+    // The epilogue, it reads the return value
+    X86Operand result;
+    if (!function_->return_type_->is_void()) {
+        result = register_operand(X86Reg::RAX, 8);
+    }
+    emit(X86Op::RET, 8, result);
+
+    write_function();
+
     // Mark the end of a function
     in_function_ = false;
 
     // Clear the offset map
     variable_offsets_.clear();
+}
+
+void X86_CodeGenerator::write_function() {
+    int frame_size = stack_size_;
+    allocator_.run(code_, frame_size);
+    peephole_.run(code_);
+    functions_++;
+
+    // Save the callee-saved registers the function uses
+    std::vector<std::pair<int, int>> saved;
+    for (int reg = 0; reg < X86Reg::NUM_PHYSICAL; reg++) {
+        if ((X86Reg::CALLEE_SAVED & allocator_.used()) >> reg & 1) {
+            frame_size = (frame_size + 7) / 8 * 8 + 8;
+            saved.emplace_back(reg, -frame_size);
+        }
+    }
+
+    // A leaf function keeps its frame in the red zone, the 128 bytes below
+    // %rsp that signal handlers leave alone, so it needs neither %rbp nor an
+    // adjustment of %rsp
+    bool leaf = frame_size + 8 <= RED_ZONE &&
+                std::none_of(code_.begin(), code_.end(), [](const auto &inst) {
+                    return inst.op == X86Op::CALL;
+                });
+
+    // Frame slots are addressed from %rbp, or from where %rbp would be in a
+    // leaf function, 8 bytes below %rsp
+    int base = X86Reg::RBP;
+    int bias = 0;
+    if (leaf) {
+        base = X86Reg::RSP;
+        bias = -8;
+        for (auto &inst : code_) {
+            for (X86Operand *operand : {&inst.src, &inst.dst}) {
+                if (operand->is_mem() && operand->reg == X86Reg::RBP) {
+                    operand->reg = base;
+                    operand->value += bias;
+                }
+            }
+        }
+        frames_omitted_++;
+    }
+
+    // Align the stack size to 16 bytes
+    frame_size = (frame_size + 15) / 16 * 16;
+
+    // Add the prologue, and the epilogue before each return
+    auto rsp = register_operand(X86Reg::RSP, 8);
+    auto rbp = register_operand(X86Reg::RBP, 8);
+    std::vector<X86Instruction> listing;
+    listing.reserve(code_.size() + 3 + saved.size());
+    if (!leaf) {
+        listing.push_back({X86Op::PUSH, 8, X86Cond::E, rbp});
+        listing.push_back({X86Op::MOV, 8, X86Cond::E, rsp, rbp});
+        if (frame_size > 0) {
+            listing.push_back({X86Op::SUB, 8, X86Cond::E,
+                               X86Operand::make_imm(frame_size), rsp});
+        }
+    }
+    for (auto [reg, offset] : saved) {
+        listing.push_back({X86Op::MOV, 8, X86Cond::E, register_operand(reg, 8),
+                           X86Operand::make_mem(base, offset + bias, 8)});
+    }
 
-    // Restore stack pointer
-    output_file_ << "\taddq\t$" << stack_size_ << ", %rsp\n"
-                 << "\tpopq\t%rbp\n"
-                 << "\tret\n";
+    for (const auto &inst : code_) {
+        if (inst.op == X86Op::RET) {
+            // Restore the registers and the stack pointer
+            for (auto [reg, offset] : saved) {
+                listing.push_back(
+                    {X86Op::MOV, 8, X86Cond::E,
+                     X86Operand::make_mem(base, offset + bias, 8),
+                     register_operand(reg, 8)});
+            }
+            if (!leaf && frame_size > 0) {
+                listing.push_back({X86Op::ADD, 8, X86Cond::E,
+                                   X86Operand::make_imm(frame_size), rsp});
+            }
+            if (!leaf) {
+                listing.push_back({X86Op::POP, 8, X86Cond::E, rbp});
+            }
+        }
+        listing.push_back(inst);
+    }
+
+    output_->function(function_->name_, listing);
+    if (function_->name_.view() == "main") {
+        main_ = function_;
+    }
 }
 
 void X86_CodeGenerator::load_parameters(const std::vector<Variable *> &params) {
@@ -74,14 +280,10 @@ void X86_CodeGenerator::load_parameters(const std::vector<Variable *> &params) {
             // Record the offset
             variable_offsets_[params[i]] = -stack_size_;
 
-            // Generate assembly code
-            if (size == 4) {
-                output_file_ << "\tmovl\t" << d_registers[NUM_REGISTERS - i - 1]
-                             << ", " << -stack_size_ << "(%rbp)\n";
-            } else {
-                output_file_ << "\tmovq\t" << registers[NUM_REGISTERS - i - 1]
-                             << ", " << -stack_size_ << "(%rbp)\n";
-            }
+            // Store the register
+            emit(X86Op::MOV, size,
+                 register_operand(X86Reg::ARGUMENTS[i], size),
+                 X86Operand::make_mem(X86Reg::RBP, -stack_size_, size));
         } else {
             // Record the offset
             variable_offsets_[params[i]] = up_offset;
@@ -111,11 +313,8 @@ void X86_CodeGenerator::allocate_local_variables(
         variable_offsets_[var] = -stack_size_;
     }
 
-    // Align the stack size to 16 bytes before allocating space
-    stack_size_ = (stack_size_ + 15) / 16 * 16;
-
-    // Allocate space on the stack for the local variables
-    output_file_ << "\tsubq\t$" << stack_size_ << ", %rsp\n";
+    // The space is allocated at the end of the function, once the spill slots
+    // are known
 }
 
 std::string X86_CodeGenerator::allocate_label() {
@@ -123,542 +322,507 @@ std::string X86_CodeGenerator::allocate_label() {
 }
 
 void X86_CodeGenerator::add_label(std::string_view label) {
-    output_file_ << label << ":\n";
+    emit(X86Op::LABEL, 0, X86Operand::make_symbol(Symbol(label)));
 }
 
-void X86_CodeGenerator::jump_on_zero(int reg, std::string_view label) {
-    output_file_ << "\tcmpq\t$0, " << registers[reg] << "\n"
-                 << "\tje\t" << label << "\n";
+void X86_CodeGenerator::jump_on_zero(int reg, Type *type,
+                                     std::string_view label) {
+    int size = type->size();
+    emit(X86Op::CMP, size, X86Operand::make_imm(0),
+         register_operand(reg, size));
+    emit_condition(X86Op::JCC, X86Cond::E,
+                   X86Operand::make_symbol(Symbol(label)));
+}
 
-    free_register(reg);
+void X86_CodeGenerator::jump_on_non_zero(int reg, Type *type,
+                                         std::string_view label) {
+    int size = type->size();
+    emit(X86Op::CMP, size, X86Operand::make_imm(0),
+         register_operand(reg, size));
+    emit_condition(X86Op::JCC, X86Cond::NE,
+                   X86Operand::make_symbol(Symbol(label)));
 }
 
-void X86_CodeGenerator::jump_on_non_zero(int reg, std::string_view label) {
-    output_file_ << "\tcmpq\t$0, " << registers[reg] << "\n"
-                 << "\tjne\t" << label << "\n";
+void X86_CodeGenerator::jump(std::string_view label) {
+    emit(X86Op::JMP, 0, X86Operand::make_symbol(Symbol(label)));
+}
 
-    free_register(reg);
+void X86_CodeGenerator::jump_on_compare(int reg1, int reg2, Type *type,
+                                        Comparison relation,
+                                        std::string_view label) {
+    int size = type->size();
+    emit(X86Op::CMP, size, register_operand(reg2, size),
+         register_operand(reg1, size));
+    emit_condition(X86Op::JCC, condition_code(relation, type),
+                   X86Operand::make_symbol(Symbol(label)));
 }
 
-void X86_CodeGenerator::jump(std::string_view label) {
-    output_file_ << "\tjmp\t" << label << "\n";
+void X86_CodeGenerator::jump_on_compare_immediate(int reg, long long val,
+                                                  Type *type,
+                                                  Comparison relation,
+                                                  std::string_view label) {
+    // cmpq only takes a sign-extended 32-bit immediate
+    if (val != static_cast<int>(val)) {
+        jump_on_compare(reg, load_immediate(val), type, relation, label);
+        return;
+    }
+
+    int size = type->size();
+    emit(X86Op::CMP, size, X86Operand::make_imm(val),
+         register_operand(reg, size));
+    emit_condition(X86Op::JCC, condition_code(relation, type),
+                   X86Operand::make_symbol(Symbol(label)));
 }
 
 void X86_CodeGenerator::return_from_function(int reg) {
-    int size = FunctionManager::find(function_name_)->return_type_->size();
-    if (size == 4) {
-        output_file_ << "\tmovl\t" << d_registers[reg] << ", %eax\n";
-    } else {
-        output_file_ << "\tmovq\t" << registers[reg] << ", %rax\n";
-    }
+    int size = function_->return_type_->size() == 4 ? 4 : 8;
+    emit(X86Op::MOV, size, register_operand(reg, size),
+         register_operand(X86Reg::RAX, size));
 
-    free_register(reg);
     jump(end_label_);
 }
 
+void X86_CodeGenerator::return_from_function() { jump(end_label_); }
+
 void X86_CodeGenerator::type_cast(int reg, Type *src, Type *dest) {
     if (src->size() >= dest->size()) {
         return;
     }
 
-    int src_size = src->size();
-    std::string src_reg = get_reg_by_size(reg, src_size);
-    int dest_size = dest->size();
-    std::string dest_reg = get_reg_by_size(reg, dest_size);
-
-    char sign_suffix = src->is_signed() ? 's' : 'z';
-    char src_suffix = get_suffix_by_size(src_size);
-    char dest_suffix = get_suffix_by_size(dest_size);
-    std::string mov_inst =
-        std::string("mov") + sign_suffix + src_suffix + dest_suffix;
-
-    output_file_ << "\t" << mov_inst << "\t" << src_reg << ", " << dest_reg
-                 << "\n";
+    emit(src->is_signed() ? X86Op::MOVSX : X86Op::MOVZX, dest->size(),
+         register_operand(reg, src->size()),
+         register_operand(reg, dest->size()));
 }
 
 int X86_CodeGenerator::negate(int reg, Type *type) {
-    if (type->size() <= 4) {
-        output_file_ << "\tnegl\t" << d_registers[reg] << "\n";
-    } else {
-        output_file_ << "\tnegq\t" << registers[reg] << "\n";
-    }
+    int size = operation_size(type);
+    emit(X86Op::NEG, size, {}, register_operand(reg, size));
 
     return reg;
 }
 
-int X86_CodeGenerator::add(int reg1, int reg2, Type *type) {
-    if (type->size() <= 4) {
-        output_file_ << "\taddl\t" << d_registers[reg2] << ", "
-                     << d_registers[reg1] << "\n";
-    } else {
-        output_file_ << "\taddq\t" << registers[reg2] << ", " << registers[reg1]
-                     << "\n";
-    }
+int X86_CodeGenerator::binary(X86Op op, int reg1, int reg2, Type *type) {
+    int size = operation_size(type);
+    emit(op, size, register_operand(reg2, size), register_operand(reg1, size));
 
-    free_register(reg2);
     return reg1;
 }
 
-int X86_CodeGenerator::subtract(int reg1, int reg2, Type *type) {
-    if (type->size() <= 4) {
-        output_file_ << "\tsubl\t" << d_registers[reg2] << ", "
-                     << d_registers[reg1] << "\n";
-    } else {
-        output_file_ << "\tsubq\t" << registers[reg2] << ", " << registers[reg1]
-                     << "\n";
-    }
+int X86_CodeGenerator::add(int reg1, int reg2, Type *type) {
+    return binary(X86Op::ADD, reg1, reg2, type);
+}
 
-    free_register(reg2);
-    return reg1;
+int X86_CodeGenerator::subtract(int reg1, int reg2, Type *type) {
+    return binary(X86Op::SUB, reg1, reg2, type);
 }
 
 int X86_CodeGenerator::multiply(int reg1, int reg2, Type *type) {
-    if (type->size() <= 4) {
-        output_file_ << "\timull\t" << d_registers[reg2] << ", "
-                     << d_registers[reg1] << "\n";
+    return binary(X86Op::IMUL, reg1, reg2, type);
+}
+
+int X86_CodeGenerator::divide_base(int reg1, int reg2, Type *type,
+                                   int result) {
+    int size = operation_size(type);
+
+    // The dividend goes in %rdx:%rax, the allocator keeps both free for it
+    emit(X86Op::MOV, size, register_operand(reg1, size),
+         register_operand(X86Reg::RAX, size));
+    if (type->is_signed()) {
+        emit(X86Op::CQTO, size);
+        emit(X86Op::IDIV, size, register_operand(reg2, size));
     } else {
-        output_file_ << "\timulq\t" << registers[reg2] << ", "
-                     << registers[reg1] << "\n";
+        emit(X86Op::MOV, 4, X86Operand::make_imm(0),
+             register_operand(X86Reg::RDX, 4));
+        emit(X86Op::DIV, size, register_operand(reg2, size));
     }
+    emit(X86Op::MOV, size, register_operand(result, size),
+         register_operand(reg1, size));
 
-    free_register(reg2);
     return reg1;
 }
 
 int X86_CodeGenerator::divide(int reg1, int reg2, Type *type) {
-    // Make sure the rdx register is free
-    bool should_pop = false;
-    if (free_registers_[RDX_INDEX]) {
-        free_registers_[RDX_INDEX] = false;
-    } else {
-        // Push the rdx register onto the stack
-        output_file_ << "\tpushq\t%rdx\n";
-        should_pop = true;
-    }
+    return divide_base(reg1, reg2, type, X86Reg::RAX);
+}
 
-    if (type->is_signed()) {
-        if (type->size() <= 4) {
-            output_file_ << "\tmovl\t" << d_registers[reg1] << ", %eax\n"
-                         << "\tcltd\n"
-                         << "\tidivl\t" << d_registers[reg2] << "\n"
-                         << "\tmovl\t%eax, " << d_registers[reg1] << "\n";
-        } else {
-            output_file_ << "\tmovq\t" << registers[reg1] << ", %rax\n"
-                         << "\tcqto\n"
-                         << "\tidivq\t" << registers[reg2] << "\n"
-                         << "\tmovq\t%rax, " << registers[reg1] << "\n";
+int X86_CodeGenerator::modulo(int reg1, int reg2, Type *type) {
+    return divide_base(reg1, reg2, type, X86Reg::RDX);
+}
+
+int X86_CodeGenerator::immediate_quotient(int reg, long long val,
+                                          Type *type) {
+    int size = operation_size(type);
+    int bits = size * 8;
+    val = normalize(val, type);
+    if (val == 1) {
+        return reg;
+    }
+    int quotient = allocate_register();
+    auto magnitude = static_cast<uint64_t>(val);
+
+    if (!type->is_signed()) {
+        // A shift, or the high half of the product by the magic number
+        if (std::has_single_bit(magnitude)) {
+            copy_register(quotient, reg);
+            emit(X86Op::SHR, size, X86Operand::make_imm(std::countr_zero(magnitude)),
+                 register_operand(quotient, size));
+            return quotient;
         }
-    } else {
-        if (type->size() <= 4) {
-            output_file_ << "\tmovl\t" << d_registers[reg1] << ", %eax\n"
-                         << "\tmovl\t$0, %edx\n"
-                         << "\tdivl\t" << d_registers[reg2] << "\n"
-                         << "\tmovl\t%eax, " << d_registers[reg1] << "\n";
-        } else {
-            output_file_ << "\tmovq\t" << registers[reg1] << ", %rax\n"
-                         << "\tmovl\t$0, %edx\n"
-                         << "\tdivq\t" << registers[reg2] << "\n"
-                         << "\tmovq\t%rax, " << registers[reg1] << "\n";
+        Magic magic = size == 4 ? unsigned_magic<uint32_t>(magnitude)
+                                : unsigned_magic<uint64_t>(magnitude);
+        emit(X86Op::MOV, size,
+             X86Operand::make_imm(size == 4 ? static_cast<int32_t>(magic.multiplier)
+                                            : static_cast<long long>(magic.multiplier)),
+             register_operand(X86Reg::RAX, size));
+        emit(X86Op::MUL, size, register_operand(reg, size));
+        emit(X86Op::MOV, size, register_operand(X86Reg::RDX, size),
+             register_operand(quotient, size));
+        if (magic.add) {
+            // The multiplier has N + 1 bits, (x - h) / 2 + h cannot overflow
+            int sum = allocate_register();
+            copy_register(sum, reg);
+            emit(X86Op::SUB, size, register_operand(quotient, size),
+                 register_operand(sum, size));
+            emit(X86Op::SHR, size, X86Operand::make_imm(1),
+                 register_operand(sum, size));
+            emit(X86Op::ADD, size, register_operand(quotient, size),
+                 register_operand(sum, size));
+            quotient = sum;
+            magic.shift--;
+        }
+        if (magic.shift > 0) {
+            emit(X86Op::SHR, size, X86Operand::make_imm(magic.shift),
+                 register_operand(quotient, size));
         }
+        return quotient;
     }
 
-    // Restore the rdx register
-    if (should_pop) {
-        output_file_ << "\tpopq\t%rdx\n";
-    } else {
-        free_registers_[RDX_INDEX] = true;
+    if (val == -1) {
+        copy_register(quotient, reg);
+        emit(X86Op::NEG, size, {}, register_operand(quotient, size));
+        return quotient;
     }
 
-    free_register(reg2);
-    return reg1;
-}
-
-int X86_CodeGenerator::modulo(int reg1, int reg2, Type *type) {
-    // Make sure the rdx register is free
-    bool should_pop = false;
-    if (free_registers_[RDX_INDEX]) {
-        free_registers_[RDX_INDEX] = false;
-    } else {
-        // Push the rdx register onto the stack
-        output_file_ << "\tpushq\t%rdx\n";
-        should_pop = true;
+    // Round toward zero: a negative dividend is biased by |d| - 1 before the
+    // shift, or the quotient is incremented when it is negative
+    if (val < 0) {
+        magnitude = 0 - magnitude;
     }
-
-    if (type->is_signed()) {
-        if (type->size() <= 4) {
-            output_file_ << "\tmovl\t" << d_registers[reg1] << ", %eax\n"
-                         << "\tcltd\n"
-                         << "\tidivl\t" << d_registers[reg2] << "\n"
-                         << "\tmovl\t%edx, " << d_registers[reg1] << "\n";
-        } else {
-            output_file_ << "\tmovq\t" << registers[reg1] << ", %rax\n"
-                         << "\tcqto\n"
-                         << "\tidivq\t" << registers[reg2] << "\n"
-                         << "\tmovq\t%rdx, " << registers[reg1] << "\n";
+    if (size == 4) {
+        magnitude = static_cast<uint32_t>(magnitude);
+    }
+    if (std::has_single_bit(magnitude)) {
+        int k = std::countr_zero(magnitude);
+        copy_register(quotient, reg);
+        if (k > 1) {
+            emit(X86Op::SAR, size, X86Operand::make_imm(bits - 1),
+                 register_operand(quotient, size));
         }
+        emit(X86Op::SHR, size, X86Operand::make_imm(bits - k),
+             register_operand(quotient, size));
+        emit(X86Op::ADD, size, register_operand(reg, size),
+             register_operand(quotient, size));
+        emit(X86Op::SAR, size, X86Operand::make_imm(k),
+             register_operand(quotient, size));
     } else {
-        if (type->size() <= 4) {
-            output_file_ << "\tmovl\t" << d_registers[reg1] << ", %eax\n"
-                         << "\tmovl\t$0, %edx\n"
-                         << "\tdivl\t" << d_registers[reg2] << "\n"
-                         << "\tmovl\t%edx, " << d_registers[reg1] << "\n";
-        } else {
-            output_file_ << "\tmovq\t" << registers[reg1] << ", %rax\n"
-                         << "\tmovl\t$0, %edx\n"
-                         << "\tdivq\t" << registers[reg2] << "\n"
-                         << "\tmovq\t%rdx, " << registers[reg1] << "\n";
+        Magic magic =
+            size == 4 ? signed_magic<uint32_t>(static_cast<uint32_t>(val))
+                      : signed_magic<uint64_t>(static_cast<uint64_t>(val));
+        auto multiplier =
+            size == 4 ? static_cast<int32_t>(magic.multiplier)
+                      : static_cast<long long>(magic.multiplier);
+        emit(X86Op::MOV, size, X86Operand::make_imm(multiplier),
+             register_operand(X86Reg::RAX, size));
+        emit(X86Op::IMUL, size, register_operand(reg, size));
+        emit(X86Op::MOV, size, register_operand(X86Reg::RDX, size),
+             register_operand(quotient, size));
+        if (val > 0 && multiplier < 0) {
+            emit(X86Op::ADD, size, register_operand(reg, size),
+                 register_operand(quotient, size));
+        } else if (val < 0 && multiplier > 0) {
+            emit(X86Op::SUB, size, register_operand(reg, size),
+                 register_operand(quotient, size));
+        }
+        if (magic.shift > 0) {
+            emit(X86Op::SAR, size, X86Operand::make_imm(magic.shift),
+                 register_operand(quotient, size));
         }
+        int sign = allocate_register();
+        copy_register(sign, quotient);
+        emit(X86Op::SHR, size, X86Operand::make_imm(bits - 1),
+             register_operand(sign, size));
+        emit(X86Op::ADD, size, register_operand(sign, size),
+             register_operand(quotient, size));
+        return quotient;
     }
-
-    // Restore the rdx register
-    if (should_pop) {
-        output_file_ << "\tpopq\t%rdx\n";
-    } else {
-        free_registers_[RDX_INDEX] = true;
+    if (val < 0) {
+        emit(X86Op::NEG, size, {}, register_operand(quotient, size));
     }
+    return quotient;
+}
 
-    free_register(reg2);
-    return reg1;
+int X86_CodeGenerator::immediate_divide(int reg, long long val, Type *type) {
+    return immediate_quotient(reg, val, type);
 }
 
-int X86_CodeGenerator::bitwise_not(int reg, Type *type) {
-    if (type->size() <= 4) {
-        output_file_ << "\tnotl\t" << d_registers[reg] << "\n";
-    } else {
-        output_file_ << "\tnotq\t" << registers[reg] << "\n";
+int X86_CodeGenerator::immediate_modulo(int reg, long long val, Type *type) {
+    int size = operation_size(type);
+    val = normalize(val, type);
+
+    // The low bits of an unsigned value
+    auto magnitude = static_cast<uint64_t>(val);
+    if (!type->is_signed() && std::has_single_bit(magnitude)) {
+        emit_immediate(X86Op::AND, size, val - 1, reg);
+        return reg;
     }
 
+    // x - x / d * d
+    int quotient = immediate_quotient(reg, val, type);
+    if (quotient == reg) {
+        quotient = duplicate_register(reg);
+    }
+    emit_immediate(X86Op::IMUL, size, val, quotient);
+    emit(X86Op::SUB, size, register_operand(quotient, size),
+         register_operand(reg, size));
     return reg;
 }
 
-int X86_CodeGenerator::bitwise_or(int reg1, int reg2, Type *type) {
-    if (type->size() <= 4) {
-        output_file_ << "\torl\t" << d_registers[reg2] << ", "
-                     << d_registers[reg1] << "\n";
-    } else {
-        output_file_ << "\torq\t" << registers[reg2] << ", " << registers[reg1]
-                     << "\n";
+void X86_CodeGenerator::emit_immediate(X86Op op, int size, long long val,
+                                       int reg) {
+    if (val != static_cast<int32_t>(val)) {
+        int operand = load_immediate(val);
+        emit(op, size, register_operand(operand, size),
+             register_operand(reg, size));
+        return;
     }
-
-    free_register(reg2);
-    return reg1;
+    emit(op, size, X86Operand::make_imm(val), register_operand(reg, size));
 }
 
-int X86_CodeGenerator::bitwise_and(int reg1, int reg2, Type *type) {
-    if (type->size() <= 4) {
-        output_file_ << "\tandl\t" << d_registers[reg2] << ", "
-                     << d_registers[reg1] << "\n";
-    } else {
-        output_file_ << "\tandq\t" << registers[reg2] << ", " << registers[reg1]
-                     << "\n";
-    }
+int X86_CodeGenerator::bitwise_not(int reg, Type *type) {
+    int size = operation_size(type);
+    emit(X86Op::NOT, size, {}, register_operand(reg, size));
 
-    free_register(reg2);
-    return reg1;
+    return reg;
 }
 
-int X86_CodeGenerator::bitwise_xor(int reg1, int reg2, Type *type) {
-    if (type->size() <= 4) {
-        output_file_ << "\txorl\t" << d_registers[reg2] << ", "
-                     << d_registers[reg1] << "\n";
-    } else {
-        output_file_ << "\txorq\t" << registers[reg2] << ", " << registers[reg1]
-                     << "\n";
-    }
+int X86_CodeGenerator::bitwise_or(int reg1, int reg2, Type *type) {
+    return binary(X86Op::OR, reg1, reg2, type);
+}
 
-    free_register(reg2);
-    return reg1;
+int X86_CodeGenerator::bitwise_and(int reg1, int reg2, Type *type) {
+    return binary(X86Op::AND, reg1, reg2, type);
 }
 
-int X86_CodeGenerator::left_shift(int reg1, int reg2, Type *type) {
-    // Make sure the rcx register is free
-    bool should_pop = false;
-    if (free_registers_[RCX_INDEX]) {
-        free_registers_[RCX_INDEX] = false;
-    } else {
-        // Push the rcx register onto the stack
-        output_file_ << "\tpushq\t%rcx\n";
-        should_pop = true;
-    }
+int X86_CodeGenerator::bitwise_xor(int reg1, int reg2, Type *type) {
+    return binary(X86Op::XOR, reg1, reg2, type);
+}
 
+int X86_CodeGenerator::shift_base(X86Op op, int reg1, int reg2, Type *type) {
     // Move the shift amount into the cl register
-    output_file_ << "\tmovb\t" << b_registers[reg2] << ", %cl\n";
+    emit(X86Op::MOV, 1, register_operand(reg2, 1),
+         register_operand(X86Reg::RCX, 1));
 
     // Perform the shift
-    if (type->size() <= 4) {
-        output_file_ << "\tsall\t%cl, " << d_registers[reg1] << "\n";
-    } else {
-        output_file_ << "\tsalq\t%cl, " << registers[reg1] << "\n";
-    }
+    int size = operation_size(type);
+    emit(op, size, register_operand(X86Reg::RCX, 1),
+         register_operand(reg1, size));
 
-    // Restore the rcx register
-    if (should_pop) {
-        output_file_ << "\tpopq\t%rcx\n";
-    } else {
-        free_registers_[RCX_INDEX] = true;
-    }
-
-    free_register(reg2);
     return reg1;
 }
 
-int X86_CodeGenerator::right_shift(int reg1, int reg2, Type *type) {
-    // Make sure the rcx register is free
-    bool should_pop = false;
-    if (free_registers_[RCX_INDEX]) {
-        free_registers_[RCX_INDEX] = false;
-    } else {
-        // Push the rcx register onto the stack
-        output_file_ << "\tpushq\t%rcx\n";
-        should_pop = true;
-    }
-
-    // Move the shift amount into the cl register
-    output_file_ << "\tmovb\t" << b_registers[reg2] << ", %cl\n";
-
-    // Perform the shift
-    if (type->is_signed()) {
-        if (type->size() <= 4) {
-            output_file_ << "\tsarl\t%cl, " << d_registers[reg1] << "\n";
-        } else {
-            output_file_ << "\tsarq\t%cl, " << registers[reg1] << "\n";
-        }
-    } else {
-        if (type->size() <= 4) {
-            output_file_ << "\tshrl\t%cl, " << d_registers[reg1] << "\n";
-        } else {
-            output_file_ << "\tshrq\t%cl, " << registers[reg1] << "\n";
-        }
-    }
-
-    // Restore the rcx register
-    if (should_pop) {
-        output_file_ << "\tpopq\t%rcx\n";
-    } else {
-        free_registers_[RCX_INDEX] = true;
-    }
+int X86_CodeGenerator::left_shift(int reg1, int reg2, Type *type) {
+    return shift_base(X86Op::SAL, reg1, reg2, type);
+}
 
-    free_register(reg2);
-    return reg1;
+int X86_CodeGenerator::right_shift(int reg1, int reg2, Type *type) {
+    return shift_base(type->is_signed() ? X86Op::SAR : X86Op::SHR, reg1, reg2,
+                      type);
 }
 
 int X86_CodeGenerator::compare_base(int reg1, int reg2, Type *type,
-                                    std::string_view inst) {
-    switch (type->size()) {
-    case 1:
-        output_file_ << "\tcmpb\t" << b_registers[reg2] << ", "
-                     << b_registers[reg1] << "\n";
-        break;
-    case 4:
-        output_file_ << "\tcmpl\t" << d_registers[reg2] << ", "
-                     << d_registers[reg1] << "\n";
-        break;
-    case 8:
-        output_file_ << "\tcmpq\t" << registers[reg2] << ", " << registers[reg1]
-                     << "\n";
-        break;
-    }
+                                    Comparison relation) {
+    int size = type->size();
+    emit(X86Op::CMP, size, register_operand(reg2, size),
+         register_operand(reg1, size));
 
     // Set the flag
-    output_file_ << "\t" << inst << "\t" << b_registers[reg1] << "\n"
-                 << "\tmovzbl\t" << b_registers[reg1] << ", "
-                 << d_registers[reg1] << "\n";
+    emit_condition(X86Op::SETCC, condition_code(relation, type),
+                   register_operand(reg1, 1));
+    emit(X86Op::MOVZX, 4, register_operand(reg1, 1),
+         register_operand(reg1, 4));
 
-    free_register(reg2);
     return reg1;
 }
 
 int X86_CodeGenerator::compare_equal(int reg1, int reg2, Type *type) {
-    return compare_base(reg1, reg2, type, "sete");
+    return compare_base(reg1, reg2, type, Comparison::EQUAL);
 }
 
 int X86_CodeGenerator::compare_not_equal(int reg1, int reg2, Type *type) {
-    return compare_base(reg1, reg2, type, "setne");
+    return compare_base(reg1, reg2, type, Comparison::NOT_EQUAL);
 }
 
 int X86_CodeGenerator::compare_less(int reg1, int reg2, Type *type) {
-    return compare_base(reg1, reg2, type, "setl");
+    return compare_base(reg1, reg2, type, Comparison::LESS);
 }
 
 int X86_CodeGenerator::compare_less_equal(int reg1, int reg2, Type *type) {
-    return compare_base(reg1, reg2, type, "setle");
+    return compare_base(reg1, reg2, type, Comparison::LESS_EQUAL);
 }
 
 int X86_CodeGenerator::compare_greater(int reg1, int reg2, Type *type) {
-    return compare_base(reg1, reg2, type, "setg");
+    return compare_base(reg1, reg2, type, Comparison::GREATER);
 }
 
 int X86_CodeGenerator::compare_greater_equal(int reg1, int reg2, Type *type) {
-    return compare_base(reg1, reg2, type, "setge");
+    return compare_base(reg1, reg2, type, Comparison::GREATER_EQUAL);
 }
 
 int X86_CodeGenerator::logical_not(int reg, Type *type) {
-    switch (type->size()) {
-    case 1:
-        output_file_ << "\tcmpb\t$0, " << b_registers[reg] << "\n";
-        break;
-    case 4:
-        output_file_ << "\tcmpl\t$0, " << d_registers[reg] << "\n";
-        break;
-    case 8:
-        output_file_ << "\tcmpq\t$0, " << registers[reg] << "\n";
-        break;
-    }
+    int size = type->size();
+    emit(X86Op::CMP, size, X86Operand::make_imm(0), register_operand(reg, size));
 
     // Set the flag
-    output_file_ << "\tsete\t" << b_registers[reg] << "\n"
-                 << "\tmovzbl\t" << b_registers[reg] << ", " << d_registers[reg]
-                 << "\n";
+    emit_condition(X86Op::SETCC, X86Cond::E, register_operand(reg, 1));
+    emit(X86Op::MOVZX, 4, register_operand(reg, 1), register_operand(reg, 4));
 
     return reg;
 }
 
-void X86_CodeGenerator::immediate_multiply(int reg, int val) {
-    // If not power of 2, throw an error
-    if (val % 2 != 0) {
-        throw LogicException("Immediate value must be a power of 2");
+void X86_CodeGenerator::immediate_multiply(int reg, long long val,
+                                           Type *type) {
+    int size = operation_size(type);
+    val = normalize(val, type);
+    if (val == 0) {
+        emit(X86Op::MOV, 4, X86Operand::make_imm(0), register_operand(reg, 4));
+        return;
     }
 
-    int shift = 0;
-    while (val % 2 == 0) {
-        val /= 2;
-        shift++;
-    }
-    if (shift > 0) {
-        output_file_ << "\tsalq\t$" << shift << ", " << registers[reg] << "\n";
+    // A negative value multiplies by its magnitude then negates
+    auto magnitude = static_cast<uint64_t>(val);
+    if (val < 0) {
+        magnitude = 0 - magnitude;
     }
-}
-
-void X86_CodeGenerator::immediate_divide(int reg, int val) {
-    // If not power of 2, throw an error
-    if (val % 2 != 0) {
-        throw LogicException("Immediate value must be a power of 2");
+    if (size == 4) {
+        magnitude = static_cast<uint32_t>(magnitude);
     }
-    int shift = 0;
-    while (val % 2 == 0) {
-        val /= 2;
-        shift++;
+    if (!multiply_sequence(reg, magnitude, size)) {
+        emit_immediate(X86Op::IMUL, size, val, reg);
+        return;
     }
-    if (shift > 0) {
-        output_file_ << "\tshrq\t$" << shift << ", " << registers[reg] << "\n";
+    if (val < 0) {
+        emit(X86Op::NEG, size, {}, register_operand(reg, size));
     }
 }
 
-void X86_CodeGenerator::immediate_add(int reg, int val) {
-    output_file_ << "\taddq\t$" << val << ", " << registers[reg] << "\n";
-}
-
-std::string X86_CodeGenerator::variable_location(Variable *var) {
-    if (variable_offsets_.contains(var)) {
-        // Local variable : offset(%rbp)
-        return std::to_string(variable_offsets_[var]) + "(%rbp)";
-    } else {
-        // Global variable : name(%rip)
-        return var->name + "(%rip)";
+bool X86_CodeGenerator::multiply_sequence(int reg, uint64_t val, int size) {
+    // lea multiplies by 3, 5 or 9, a shift by a power of 2
+    auto lea_factor = [](uint64_t val) {
+        return val == 3 || val == 5 || val == 9;
+    };
+    auto lea = [&](uint64_t factor) {
+        emit(X86Op::LEA, size,
+             X86Operand::make_indexed(reg, reg, static_cast<int>(factor - 1),
+                                      0, 8),
+             register_operand(reg, size));
+    };
+    auto shift = [&](int count) {
+        if (count > 0) {
+            emit(X86Op::SAL, size, X86Operand::make_imm(count),
+                 register_operand(reg, size));
+        }
+    };
+
+    // 2^k, then 3, 5 or 9 times 2^k
+    int zeros = std::countr_zero(val);
+    uint64_t odd = val >> zeros;
+    if (odd == 1) {
+        shift(zeros);
+        return true;
     }
-}
-
-int X86_CodeGenerator::post_increment(Variable *var) {
-    // Load the variable's value into a register
-    int reg = load_variable(var);
-
-    // Get the location of the variable
-    std::string loc = variable_location(var);
-
-    // Increment the variable
-    switch (var->type->size()) {
-    case 1:
-        output_file_ << "\tincb\t" << loc << "\n";
-        break;
-    case 4:
-        output_file_ << "\tincl\t" << loc << "\n";
-        break;
-    case 8:
-        output_file_ << "\tincq\t" << loc << "\n";
-        break;
+    if (lea_factor(odd)) {
+        lea(odd);
+        shift(zeros);
+        return true;
     }
 
-    return reg;
-}
-
-int X86_CodeGenerator::post_decrement(Variable *var) {
-    // Load the variable's value into a register
-    int reg = load_variable(var);
-
-    // Get the location of the variable
-    std::string loc = variable_location(var);
+    // Products of two of them, as 15, 25, 27, 45 and 81
+    for (uint64_t factor : {3, 5, 9}) {
+        if (odd % factor == 0 && lea_factor(odd / factor)) {
+            lea(factor);
+            lea(odd / factor);
+            shift(zeros);
+            return true;
+        }
+    }
 
-    // Decrement the variable
-    switch (var->type->size()) {
-    case 1:
-        output_file_ << "\tdecb\t" << loc << "\n";
-        break;
-    case 4:
-        output_file_ << "\tdecl\t" << loc << "\n";
-        break;
-    case 8:
-        output_file_ << "\tdecq\t" << loc << "\n";
-        break;
+    // 2^k + 1 and 2^k - 1, with a copy of the value
+    X86Op op;
+    if (std::has_single_bit(val - 1)) {
+        op = X86Op::ADD;
+    } else if (std::has_single_bit(val + 1)) {
+        op = X86Op::SUB;
+    } else {
+        return false;
     }
+    int copy = duplicate_register(reg);
+    shift(std::countr_zero(op == X86Op::ADD ? val - 1 : val + 1));
+    emit(op, size, register_operand(copy, size), register_operand(reg, size));
+    return true;
+}
 
+int X86_CodeGenerator::add_scaled(int reg1, int reg2, int scale,
+                                  Type *type) {
+    int reg = allocate_register();
+    emit(X86Op::LEA, operation_size(type),
+         X86Operand::make_indexed(reg1, reg2, scale, 0, 8),
+         register_operand(reg, operation_size(type)));
     return reg;
 }
 
-int X86_CodeGenerator::pre_increment(Variable *var) {
-    // Get the location of the variable
-    std::string loc = variable_location(var);
-
-    // Increment the variable
-    switch (var->type->size()) {
-    case 1:
-        output_file_ << "\tincb\t" << loc << "\n";
-        break;
-    case 4:
-        output_file_ << "\tincl\t" << loc << "\n";
-        break;
-    case 8:
-        output_file_ << "\tincq\t" << loc << "\n";
-        break;
+X86Operand X86_CodeGenerator::variable_location(Variable *var, int size) {
+    if (variable_offsets_.contains(var)) {
+        // Local variable : offset(%rbp)
+        return X86Operand::make_mem(X86Reg::RBP, variable_offsets_[var], size);
+    } else {
+        // Global variable : name(%rip)
+        return X86Operand::make_rip(var->name, size);
     }
-
-    // Load the variable's value into a register
-    return load_variable(var);
 }
 
-int X86_CodeGenerator::pre_decrement(Variable *var) {
-    // Get the location of the variable
-    std::string loc = variable_location(var);
-
-    // Decrement the variable
-    switch (var->type->size()) {
-    case 1:
-        output_file_ << "\tdecb\t" << loc << "\n";
-        break;
-    case 4:
-        output_file_ << "\tdecl\t" << loc << "\n";
-        break;
-    case 8:
-        output_file_ << "\tdecq\t" << loc << "\n";
-        break;
+X86Operand X86_CodeGenerator::memory_operand(const MemoryAddress &address,
+                                             int size) {
+    int base = address.base;
+    if (address.variable != nullptr) {
+        X86Operand location = variable_location(address.variable, size);
+        if (location.reg != X86Reg::RIP || address.index == -1) {
+            location.value += address.disp;
+            location.index = address.index;
+            location.scale = static_cast<uint8_t>(address.scale);
+            return location;
+        }
+        base = allocate_register();
+        emit(X86Op::LEA, 8, variable_location(address.variable, 8),
+             register_operand(base, 8));
     }
-
-    // Load the variable's value into a register
-    return load_variable(var);
+    return X86Operand::make_indexed(base, address.index, address.scale,
+                                    address.disp, size);
 }
 
-int X86_CodeGenerator::load_immediate(int val) {
+int X86_CodeGenerator::load_immediate(long long val) {
     int reg = allocate_register();
-    output_file_ << "\tmovq\t$" << val << ", " << registers[reg] << "\n";
+    emit(X86Op::MOV, 8, X86Operand::make_imm(val), register_operand(reg, 8));
     return reg;
 }
 
-int X86_CodeGenerator::load_string_literal(std::string_view str) {
+int X86_CodeGenerator::load_string_literal(Symbol str) {
     // Get the label for the string literal
-    std::string label = string_literals[str.data()];
+    const std::string &label = string_literals.at(str);
 
     // Load the address of the string literal into a register
     int reg = allocate_register();
-    output_file_ << "\tleaq\t" << label << "(%rip), " << registers[reg] << "\n";
+    emit(X86Op::LEA, 8, X86Operand::make_rip(Symbol(label), 8),
+         register_operand(reg, 8));
 
     return reg;
 }
@@ -667,24 +831,23 @@ int X86_CodeGenerator::load_variable(Variable *var) {
     // Allocate a register
     int reg = allocate_register();
 
-    // Get the location of the variable
-    std::string loc = variable_location(var);
-
     // Load the variable's value into the register
     if (var->type->is_array()) {
-        output_file_ << "\tleaq\t" << loc << ", " << registers[reg] << "\n";
+        emit(X86Op::LEA, 8, variable_location(var, 8),
+             register_operand(reg, 8));
     } else {
         switch (var->type->size()) {
         case 1:
-            output_file_ << "\tmovzbl\t" << loc << ", " << d_registers[reg]
-                         << "\n";
+            emit(X86Op::MOVZX, 4, variable_location(var, 1),
+                 register_operand(reg, 4));
             break;
         case 4:
-            output_file_ << "\tmovl\t" << loc << ", " << d_registers[reg]
-                         << "\n";
+            emit(X86Op::MOV, 4, variable_location(var, 4),
+                 register_operand(reg, 4));
             break;
         case 8:
-            output_file_ << "\tmovq\t" << loc << ", " << registers[reg] << "\n";
+            emit(X86Op::MOV, 8, variable_location(var, 8),
+                 register_operand(reg, 8));
             break;
         }
     }
@@ -696,88 +859,52 @@ int X86_CodeGenerator::load_variable_address(Variable *var) {
     // Allocate a register
     int reg = allocate_register();
 
-    // Get the location of the variable
-    std::string loc = variable_location(var);
-
     // Load the address of the variable into the register
-    output_file_ << "\tleaq\t" << loc << ", " << registers[reg] << "\n";
+    emit(X86Op::LEA, 8, variable_location(var, 8), register_operand(reg, 8));
 
     return reg;
 }
 
-void X86_CodeGenerator::move_immediate(int reg, int val) {
-    output_file_ << "\tmovq\t$" << val << ", " << registers[reg] << "\n";
+void X86_CodeGenerator::move_immediate(int reg, long long val) {
+    emit(X86Op::MOV, 8, X86Operand::make_imm(val), register_operand(reg, 8));
 }
 
 void X86_CodeGenerator::move_register(int reg, Variable *var) {
-    // Get the location of the variable
-    std::string loc = variable_location(var);
-
     // Move the register's value into the variable
-    if (var->type->is_array()) {
-        output_file_ << "\tmovq\t" << registers[reg] << ", " << loc << "\n";
-    } else {
-        switch (var->type->size()) {
-        case 1:
-            output_file_ << "\tmovb\t" << b_registers[reg] << ", " << loc
-                         << "\n";
-            break;
-        case 4:
-            output_file_ << "\tmovl\t" << d_registers[reg] << ", " << loc
-                         << "\n";
-            break;
-        case 8:
-            output_file_ << "\tmovq\t" << registers[reg] << ", " << loc << "\n";
-            break;
-        }
-    }
-
-    free_register(reg);
+    int size = var->type->is_array() ? 8 : var->type->size();
+    emit(X86Op::MOV, size, register_operand(reg, size),
+         variable_location(var, size));
 }
 
-void X86_CodeGenerator::move_register(int reg, int address_reg,
+void X86_CodeGenerator::move_register(int reg, const MemoryAddress &address,
                                       Type *data_type) {
     // Move the register's value into the address
-    switch (data_type->size()) {
-    case 1:
-        output_file_ << "\tmovb\t" << b_registers[reg] << ", ("
-                     << registers[address_reg] << ")\n";
-        break;
-    case 4:
-        output_file_ << "\tmovl\t" << d_registers[reg] << ", ("
-                     << registers[address_reg] << ")\n";
-        break;
-    case 8:
-        output_file_ << "\tmovq\t" << registers[reg] << ", ("
-                     << registers[address_reg] << ")\n";
-        break;
-    }
-
-    free_register(reg);
-    free_register(address_reg);
+    int size = data_type->size();
+    emit(X86Op::MOV, size, register_operand(reg, size),
+         memory_operand(address, size));
 }
 
-int X86_CodeGenerator::load_from_memory(int address_reg, Type *data_type) {
+int X86_CodeGenerator::load_from_memory(const MemoryAddress &address,
+                                        Type *data_type) {
     // Allocate a register
     int reg = allocate_register();
 
     // Load the value from the address into the register
     switch (data_type->size()) {
     case 1:
-        output_file_ << "\tmovzbl\t(" << registers[address_reg] << "), "
-                     << d_registers[reg] << "\n";
+        emit(X86Op::MOVZX, 4, memory_operand(address, 1),
+             register_operand(reg, 4));
         break;
     case 4:
-        output_file_ << "\tmovl\t(" << registers[address_reg] << "), "
-                     << d_registers[reg] << "\n";
+        emit(X86Op::MOV, 4, memory_operand(address, 4),
+             register_operand(reg, 4));
         break;
     case 8:
-        output_file_ << "\tmovq\t(" << registers[address_reg] << "), "
-                     << registers[reg] << "\n";
+        emit(X86Op::MOV, 8, memory_operand(address, 8),
+             register_operand(reg, 8));
         break;
     }
 
-    free_register(address_reg);
     return reg;
 }
 
@@ -786,32 +913,56 @@ int X86_CodeGenerator::duplicate_register(int reg) {
     int new_reg = allocate_register();
 
     // Duplicate the register's value
-    output_file_ << "\tmovq\t" << registers[reg] << ", " << registers[new_reg]
-                 << "\n";
+    emit(X86Op::MOV, 8, register_operand(reg, 8), register_operand(new_reg, 8));
 
     return new_reg;
 }
 
+void X86_CodeGenerator::copy_register(int dest, int src) {
+    emit(X86Op::MOV, 8, register_operand(src, 8), register_operand(dest, 8));
+}
+
 void X86_CodeGenerator::move_to_argument(int reg, int n) {
-    if (n <= 6) {
-        output_file_ << "\tmovq\t" << registers[reg] << ", "
-                     << registers[NUM_REGISTERS - n] << "\n";
-    } else {
-        output_file_ << "\tpushq\t" << registers[reg] << "\n";
+    // Argument registers are only written right before the call, so that
+    // evaluating the other arguments cannot overwrite them
+    arguments_.emplace_back(reg, n);
+}
+
+int X86_CodeGenerator::call_function(FunctionPrototype *func, int num_args) {
+    // The arguments of this call are the last recorded ones
+    std::vector<int> args(num_args);
+    for (auto it = arguments_.end() - num_args; it != arguments_.end(); ++it) {
+        args[it->second - 1] = it->first;
+    }
+    arguments_.resize(arguments_.size() - num_args);
+
+    // Push the arguments passed through stack, keeping %rsp 16-byte aligned
+    int stack_args = std::max(num_args - 6, 0);
+    int padding = stack_args % 2 * 8;
+    if (padding > 0) {
+        emit(X86Op::SUB, 8, X86Operand::make_imm(padding),
+             register_operand(X86Reg::RSP, 8));
+    }
+    for (int n = num_args; n > 6; n--) {
+        emit(X86Op::PUSH, 8, register_operand(args[n - 1], 8));
     }
 
-    free_register(reg);
-}
+    // Move the first 6 arguments into their registers
+    int register_args = std::min(num_args, 6);
+    for (int n = 1; n <= register_args; n++) {
+        emit(X86Op::MOV, 8, register_operand(args[n - 1], 8),
+             register_operand(X86Reg::ARGUMENTS[n - 1], 8));
+    }
 
-int X86_CodeGenerator::call_function(std::string_view name) {
     // Call the function
-    output_file_ << "\tcall\t" << name << "\n";
+    X86Operand argument_count;
+    argument_count.value = register_args;
+    emit(X86Op::CALL, 8, X86Operand::make_symbol(func->name_), argument_count);
 
     // Remove the arguments in the stack
-    FunctionPrototype *func = FunctionManager::find(name.data());
-    if (func->parameters_.size() > 6) {
-        output_file_ << "\taddq\t$" << 8 * (func->parameters_.size() - 6)
-                     << ", %rsp\n";
+    if (stack_args > 0) {
+        emit(X86Op::ADD, 8, X86Operand::make_imm(8 * stack_args + padding),
+             register_operand(X86Reg::RSP, 8));
     }
 
     // If the function returns void, return -1
@@ -821,81 +972,34 @@ int X86_CodeGenerator::call_function(std::string_view name) {
 
     // Allocate a register
     int reg = allocate_register();
-    output_file_ << "\tmovq\t%rax, " << registers[reg] << "\n";
+    emit(X86Op::MOV, 8, register_operand(X86Reg::RAX, 8),
+         register_operand(reg, 8));
     return reg;
 }
 
 void X86_CodeGenerator::prelude() {
-    // Free all the registers
-    free_all_registers();
-
-    output_file_ << "\t.text\n";
-
     // Generate the string literals
-    for (auto &[str, label] : string_literals) {
+    for (auto &[symbol, label] : string_literals) {
         label = allocate_label();
-
-        // Unescape the string
-        std::string str_literal;
-        for (size_t i = 0; i < str.size(); ++i) {
-            switch (str[i]) {
-            case '\a':
-                str_literal += R"(\a)";
-                break;
-            case '\b':
-                str_literal += R"(\b)";
-                break;
-            case '\f':
-                str_literal += R"(\f)";
-                break;
-            case '\n':
-                str_literal += R"(\n)";
-                break;
-            case '\r':
-                str_literal += R"(\r)";
-                break;
-            case '\t':
-                str_literal += R"(\t)";
-                break;
-            case '\v':
-                str_literal += R"(\v)";
-                break;
-            case '\\':
-                str_literal += R"(\\)";
-                break;
-            case '\'':
-                str_literal += R"(\')";
-                break;
-            case '\"':
-                str_literal += R"(\")";
-                break;
-            default:
-                str_literal += str[i];
-                break;
-            }
-        }
-
-        allocate_string_literal(str_literal, label);
+        allocate_string_literal(symbol.view(), label);
     }
 
     // Generate the global variables
     std::vector<Variable *> global_vars =
-        VariableManager::get_variables_in_scope("global");
+        VariableManager::get_variables_in_scope(Context::global());
     for (auto var : global_vars) {
         allocate_global_variables(var);
     }
 }
 
 void X86_CodeGenerator::postlude() {
-    // Close the output file
-    output_file_.close();
+    // Write and close the output file, code in memory stays until it is run
+    output_->finish();
 }
 
 void X86_CodeGenerator::allocate_string_literal(std::string_view str,
                                                 std::string_view label) {
-    output_file_ << "\t.section\t.rodata\n"
-                 << label << ":\n"
-                 << "\t.string\t\"" << str << "\"\n";
+    output_->string_literal(Symbol(label), str);
 }
 
 void X86_CodeGenerator::allocate_global_variables(Variable *var) {
@@ -912,66 +1016,24 @@ void X86_CodeGenerator::allocate_global_variables(Variable *var) {
     }
 
     // Allocate space for the variable
-    output_file_ << "\t.data\n"
-                 << "\t.globl\t" << var->name << "\n"
-                 << var->name << ":\n";
-    for (int i = 0; i < num_elements; ++i) {
-        switch (size_element) {
-        case 1:
-            output_file_ << "\t.byte\t0\n";
-            break;
-        case 4:
-            output_file_ << "\t.long\t0\n";
-            break;
-        case 8:
-            output_file_ << "\t.quad\t0\n";
-            break;
-        }
-    }
-}
-
-std::string X86_CodeGenerator::get_reg_by_size(int reg, int size) {
-    switch (size) {
-    case 1:
-        return b_registers[reg];
-    case 4:
-        return d_registers[reg];
-    case 8:
-        return registers[reg];
-    default:
-        throw LogicException("Invalid size");
-    }
+    output_->global_variable(var->name, size_element, num_elements);
 }
 
-int X86_CodeGenerator::allocate_register() {
-    for (int i = 0; i < NUM_REGISTERS; ++i) {
-        if (free_registers_[i]) {
-            free_registers_[i] = false;
-            return i;
-        }
-    }
-    throw LogicException("No free register");
+void X86_CodeGenerator::emit(X86Op op, int size, X86Operand src,
+                             X86Operand dst) {
+    code_.push_back({op, static_cast<uint8_t>(size), X86Cond::E, src, dst});
 }
 
-void X86_CodeGenerator::free_all_registers() {
-    for (int i = 0; i < NUM_REGISTERS; ++i) {
-        free_registers_[i] = true;
+void X86_CodeGenerator::emit_condition(X86Op op, X86Cond cond,
+                                       X86Operand operand) {
+    // setcc writes its operand, jcc reads its label
+    if (op == X86Op::SETCC) {
+        code_.push_back({op, 1, cond, {}, operand});
+    } else {
+        code_.push_back({op, 0, cond, operand});
     }
 }
 
-char X86_CodeGenerator::get_suffix_by_size(int size) {
-    switch (size) {
-    case 1:
-        return 'b';
-    case 2:
-        return 'w';
-    case 4:
-        return 'l';
-    case 8:
-        return 'q';
-    default:
-        throw LogicException("Invalid size");
-    }
-}
+int X86_CodeGenerator::allocate_register() { return next_register_++; }
 
-} // namespace myComp
\ No newline at end of file
+} // namespace myComp
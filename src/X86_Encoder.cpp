@@ -0,0 +1,440 @@
+#include <bit>
+#include <elf.h>
+#include <initializer_list>
+#include <source_location>
+#include <unordered_map>
+
+#include "Errors.h"
+#include "X86_Encoder.h"
+
+namespace {
+using namespace myComp;
+
+using Bytes = std::vector<uint8_t>;
+
+// Condition codes in the encoding of setcc and jcc, indexed by X86Cond
+constexpr uint8_t condition_codes[] = {0x4, 0x5, 0xC, 0xE, 0xF,
+                                       0xD, 0x2, 0x6, 0x7, 0x3};
+
+// /digit of the group 1 arithmetic instructions
+int arithmetic_extension(X86Op op) {
+    switch (op) {
+    case X86Op::ADD:
+        return 0;
+    case X86Op::OR:
+        return 1;
+    case X86Op::AND:
+        return 4;
+    case X86Op::SUB:
+        return 5;
+    case X86Op::XOR:
+        return 6;
+    case X86Op::CMP:
+        return 7;
+    default:
+        throw UnreachableException(
+            std::source_location::current().function_name());
+    }
+}
+
+bool fits_int8(long long value) { return value >= -128 && value <= 127; }
+bool fits_int32(long long value) {
+    return value == static_cast<int32_t>(value);
+}
+
+// %spl, %bpl, %sil and %dil need a REX prefix, without one these numbers
+// name %ah, %ch, %dh and %bh
+bool needs_rex(const X86Operand &operand) {
+    return operand.is_reg() && operand.size == 1 && operand.reg >= 4 &&
+           operand.reg < 8;
+}
+
+// Builds the bytes of one instruction
+class Writer {
+  public:
+    Writer(Bytes &bytes, std::vector<X86_Relocation> &relocations)
+        : bytes_(bytes), relocations_(relocations) {}
+
+    void byte(uint8_t value) { bytes_.push_back(value); }
+
+    void immediate(long long value, int size) {
+        for (int i = 0; i < size; i++)
+            byte(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    // Operand-size prefix and REX prefix
+    void prefixes(int size, int reg, const X86Operand *rm, bool force_rex) {
+        if (size == 2)
+            byte(0x66);
+        uint8_t rex = 0x40;
+        if (size == 8)
+            rex |= 0x08;
+        if (reg >= 8)
+            rex |= 0x04;
+        if (rm != nullptr && rm->reg >= 8 && (rm->is_reg() || rm->is_mem()))
+            rex |= 0x01;
+        if (rm != nullptr && rm->is_mem() && rm->index >= 8)
+            rex |= 0x02;
+        if (rex != 0x40 || force_rex)
+            byte(rex);
+    }
+
+    // An instruction with a ModRM byte, `reg` is a register or an opcode
+    // extension, `rm` a register or memory operand
+    void modrm(int size, std::initializer_list<uint8_t> opcode, int reg,
+               const X86Operand &rm, bool byte_reg = false) {
+        prefixes(size, reg, &rm, needs_rex(rm) || (byte_reg && reg >= 4));
+        for (uint8_t op : opcode)
+            byte(op);
+
+        int r = (reg & 7) << 3;
+        if (rm.is_reg()) {
+            byte(static_cast<uint8_t>(0xC0 | r | (rm.reg & 7)));
+            return;
+        }
+        if (!rm.is_mem())
+            throw LogicException("Operand is neither a register nor memory");
+
+        if (rm.reg == X86Reg::RIP) {
+            byte(static_cast<uint8_t>(r | 5));
+            relocations_.push_back(
+                {bytes_.size(), rm.symbol, R_X86_64_PC32, rm.value});
+            immediate(0, 4);
+            return;
+        }
+
+        int base = rm.reg & 7;
+        int mod = rm.value == 0 && base != 5 ? 0
+                  : fits_int8(rm.value)      ? 1
+                                             : 2;
+        if (rm.index != -1) {
+            // A SIB byte with the scale and the index
+            byte(static_cast<uint8_t>(mod << 6 | r | 4));
+            byte(static_cast<uint8_t>(std::countr_zero(rm.scale) << 6 |
+                                      (rm.index & 7) << 3 | base));
+        } else {
+            byte(static_cast<uint8_t>(mod << 6 | r | base));
+            if (base == 4)
+                byte(0x24);
+        }
+        if (mod == 1)
+            immediate(rm.value, 1);
+        else if (mod == 2)
+            immediate(rm.value, 4);
+    }
+
+    // An instruction whose register is in the low bits of the opcode
+    void short_form(int size, uint8_t opcode, const X86Operand &reg) {
+        prefixes(size, 0, &reg, needs_rex(reg));
+        byte(static_cast<uint8_t>(opcode + (reg.reg & 7)));
+    }
+
+    // A field read relative to the end of the instruction
+    void finish(size_t first_relocation) {
+        for (size_t i = first_relocation; i < relocations_.size(); i++)
+            relocations_[i].addend -= bytes_.size() - relocations_[i].offset;
+    }
+
+  private:
+    Bytes &bytes_;
+    std::vector<X86_Relocation> &relocations_;
+};
+
+void encode_move(Writer &w, const X86Instruction &inst) {
+    const X86Operand &src = inst.src;
+    const X86Operand &dst = inst.dst;
+    int size = inst.size;
+    bool is_byte = size == 1;
+
+    if (src.is_reg()) {
+        w.modrm(size, {static_cast<uint8_t>(is_byte ? 0x88 : 0x89)}, src.reg,
+                dst, is_byte);
+    } else if (src.is_mem()) {
+        w.modrm(size, {static_cast<uint8_t>(is_byte ? 0x8A : 0x8B)}, dst.reg,
+                src, is_byte);
+    } else if (dst.is_reg() && size != 8) {
+        w.short_form(size, is_byte ? 0xB0 : 0xB8, dst);
+        w.immediate(src.value, size);
+    } else if (dst.is_reg() && !fits_int32(src.value)) {
+        // movabsq
+        w.short_form(size, 0xB8, dst);
+        w.immediate(src.value, 8);
+    } else {
+        w.modrm(size, {static_cast<uint8_t>(is_byte ? 0xC6 : 0xC7)}, 0, dst);
+        w.immediate(src.value, size == 8 ? 4 : size);
+    }
+}
+
+void encode_extension(Writer &w, const X86Instruction &inst) {
+    const X86Operand &src = inst.src;
+    const X86Operand &dst = inst.dst;
+    bool is_signed = inst.op == X86Op::MOVSX;
+
+    switch (src.size) {
+    case 1:
+        w.modrm(dst.size,
+                {0x0F, static_cast<uint8_t>(is_signed ? 0xBE : 0xB6)}, dst.reg,
+                src);
+        break;
+    case 2:
+        w.modrm(dst.size,
+                {0x0F, static_cast<uint8_t>(is_signed ? 0xBF : 0xB7)}, dst.reg,
+                src);
+        break;
+    case 4:
+        // movslq, or a movl that clears the upper half
+        if (is_signed)
+            w.modrm(8, {0x63}, dst.reg, src);
+        else
+            w.modrm(4, {0x8B}, dst.reg, src);
+        break;
+    default:
+        throw LogicException("Invalid extension");
+    }
+}
+
+void encode_arithmetic(Writer &w, const X86Instruction &inst) {
+    const X86Operand &src = inst.src;
+    const X86Operand &dst = inst.dst;
+    int size = inst.size;
+    bool is_byte = size == 1;
+    int ext = arithmetic_extension(inst.op);
+
+    if (src.is_imm()) {
+        if (is_byte) {
+            w.modrm(size, {0x80}, ext, dst);
+            w.immediate(src.value, 1);
+        } else if (fits_int8(src.value)) {
+            w.modrm(size, {0x83}, ext, dst);
+            w.immediate(src.value, 1);
+        } else {
+            w.modrm(size, {0x81}, ext, dst);
+            w.immediate(src.value, size == 2 ? 2 : 4);
+        }
+    } else if (src.is_reg()) {
+        w.modrm(size, {static_cast<uint8_t>(ext << 3 | (is_byte ? 0 : 1))},
+                src.reg, dst, is_byte);
+    } else {
+        w.modrm(size, {static_cast<uint8_t>(ext << 3 | (is_byte ? 2 : 3))},
+                dst.reg, src, is_byte);
+    }
+}
+
+void encode_shift(Writer &w, const X86Instruction &inst) {
+    int ext = inst.op == X86Op::SAL ? 4 : inst.op == X86Op::SHR ? 5 : 7;
+    bool is_byte = inst.size == 1;
+    if (inst.src.is_imm() && inst.src.value == 1) {
+        w.modrm(inst.size, {static_cast<uint8_t>(is_byte ? 0xD0 : 0xD1)}, ext,
+                inst.dst);
+    } else if (inst.src.is_imm()) {
+        w.modrm(inst.size, {static_cast<uint8_t>(is_byte ? 0xC0 : 0xC1)}, ext,
+                inst.dst);
+        w.immediate(inst.src.value, 1);
+    } else {
+        // The count is in %cl
+        w.modrm(inst.size, {static_cast<uint8_t>(is_byte ? 0xD2 : 0xD3)}, ext,
+                inst.dst);
+    }
+}
+
+// Instructions of group 3 and 4, the operand is the destination, or the
+// source for a division or a widening multiplication
+void encode_unary(Writer &w, const X86Instruction &inst) {
+    const X86Operand &operand =
+        inst.dst.kind != X86Operand::Kind::NONE ? inst.dst : inst.src;
+    bool is_byte = inst.size == 1;
+    uint8_t group3 = is_byte ? 0xF6 : 0xF7;
+    uint8_t group4 = is_byte ? 0xFE : 0xFF;
+
+    switch (inst.op) {
+    case X86Op::NOT:
+        return w.modrm(inst.size, {group3}, 2, operand);
+    case X86Op::NEG:
+        return w.modrm(inst.size, {group3}, 3, operand);
+    case X86Op::MUL:
+        return w.modrm(inst.size, {group3}, 4, operand);
+    case X86Op::IMUL:
+        return w.modrm(inst.size, {group3}, 5, operand);
+    case X86Op::DIV:
+        return w.modrm(inst.size, {group3}, 6, operand);
+    case X86Op::IDIV:
+        return w.modrm(inst.size, {group3}, 7, operand);
+    case X86Op::INC:
+        return w.modrm(inst.size, {group4}, 0, operand);
+    case X86Op::DEC:
+        return w.modrm(inst.size, {group4}, 1, operand);
+    default:
+        throw UnreachableException(
+            std::source_location::current().function_name());
+    }
+}
+
+// Encode an instruction that is neither a label nor a jump
+void encode_instruction(Writer &w, const X86Instruction &inst) {
+    switch (inst.op) {
+    case X86Op::MOV:
+        return encode_move(w, inst);
+    case X86Op::MOVZX:
+    case X86Op::MOVSX:
+        return encode_extension(w, inst);
+    case X86Op::LEA:
+        return w.modrm(inst.size, {0x8D}, inst.dst.reg, inst.src);
+    case X86Op::ADD:
+    case X86Op::SUB:
+    case X86Op::AND:
+    case X86Op::OR:
+    case X86Op::XOR:
+    case X86Op::CMP:
+        return encode_arithmetic(w, inst);
+    case X86Op::TEST:
+        return w.modrm(inst.size,
+                       {static_cast<uint8_t>(inst.size == 1 ? 0x84 : 0x85)},
+                       inst.src.reg, inst.dst, inst.size == 1);
+    case X86Op::IMUL:
+        if (inst.dst.kind == X86Operand::Kind::NONE)
+            return encode_unary(w, inst);
+        if (inst.src.is_imm()) {
+            // The three-operand form with the destination as the source
+            bool short_immediate = fits_int8(inst.src.value);
+            w.modrm(inst.size,
+                    {static_cast<uint8_t>(short_immediate ? 0x6B : 0x69)},
+                    inst.dst.reg, inst.dst);
+            return w.immediate(inst.src.value, short_immediate ? 1 : 4);
+        }
+        return w.modrm(inst.size, {0x0F, 0xAF}, inst.dst.reg, inst.src);
+    case X86Op::SAL:
+    case X86Op::SAR:
+    case X86Op::SHR:
+        return encode_shift(w, inst);
+    case X86Op::NEG:
+    case X86Op::NOT:
+    case X86Op::INC:
+    case X86Op::DEC:
+    case X86Op::IDIV:
+    case X86Op::DIV:
+    case X86Op::MUL:
+        return encode_unary(w, inst);
+    case X86Op::SETCC: {
+        uint8_t cc = condition_codes[static_cast<int>(inst.cond)];
+        return w.modrm(4, {0x0F, static_cast<uint8_t>(0x90 | cc)}, 0,
+                       inst.dst);
+    }
+    case X86Op::PUSH:
+        if (inst.src.is_reg())
+            return w.short_form(4, 0x50, inst.src);
+        return w.modrm(4, {0xFF}, 6, inst.src);
+    case X86Op::POP:
+        return w.short_form(4, 0x58, inst.src);
+    case X86Op::CALL:
+        // The linker may route the call through the PLT
+        w.byte(0xE8);
+        w.immediate(0, 4);
+        return;
+    case X86Op::CQTO:
+        if (inst.size == 8)
+            w.byte(0x48);
+        return w.byte(0x99);
+    case X86Op::RET:
+        return w.byte(0xC3);
+    default:
+        throw LogicException("Instruction cannot be encoded");
+    }
+}
+
+bool is_jump(X86Op op) { return op == X86Op::JMP || op == X86Op::JCC; }
+
+// Length of a jump in its short or near form
+int jump_length(const X86Instruction &inst, bool is_short) {
+    if (is_short)
+        return 2;
+    return inst.op == X86Op::JMP ? 5 : 6;
+}
+} // namespace
+
+namespace myComp {
+void X86_Encoder::encode(const std::vector<X86Instruction> &code,
+                         std::vector<uint8_t> &text,
+                         std::vector<X86_Relocation> &relocations) {
+    size_t n = code.size();
+    pieces_.assign(n, {});
+    offsets_.assign(n + 1, 0);
+    short_.assign(n, true);
+
+    // Encode everything but the jumps, find the labels
+    std::unordered_map<Symbol, size_t> labels;
+    for (size_t i = 0; i < n; i++) {
+        const X86Instruction &inst = code[i];
+        if (inst.op == X86Op::LABEL) {
+            labels[inst.src.symbol] = i;
+            continue;
+        }
+        if (is_jump(inst.op))
+            continue;
+
+        Piece &piece = pieces_[i];
+        Writer w(piece.bytes, piece.relocations);
+        encode_instruction(w, inst);
+        if (inst.op == X86Op::CALL) {
+            piece.relocations.push_back(
+                {1, inst.src.symbol, R_X86_64_PLT32, 0});
+        }
+        w.finish(0);
+    }
+
+    // Lay out the function until every short jump reaches its target
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < n; i++) {
+            offsets_[i + 1] =
+                offsets_[i] + (is_jump(code[i].op)
+                                   ? jump_length(code[i], short_[i])
+                                   : pieces_[i].bytes.size());
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (!is_jump(code[i].op) || !short_[i])
+                continue;
+            auto target = static_cast<int64_t>(
+                offsets_[labels.at(code[i].src.symbol)]);
+            if (!fits_int8(target - static_cast<int64_t>(offsets_[i + 1]))) {
+                short_[i] = false;
+                changed = true;
+            }
+        }
+    }
+
+    uint64_t base = text.size();
+    for (size_t i = 0; i < n; i++) {
+        const X86Instruction &inst = code[i];
+        if (!is_jump(inst.op)) {
+            text.insert(text.end(), pieces_[i].bytes.begin(),
+                        pieces_[i].bytes.end());
+            for (auto relocation : pieces_[i].relocations) {
+                relocation.offset += base + offsets_[i];
+                relocations.push_back(relocation);
+            }
+            continue;
+        }
+
+        uint8_t cc = condition_codes[static_cast<int>(inst.cond)];
+        int64_t distance =
+            static_cast<int64_t>(offsets_[labels.at(inst.src.symbol)]) -
+            static_cast<int64_t>(offsets_[i + 1]);
+        std::vector<X86_Relocation> none;
+        Writer w(text, none);
+        if (short_[i]) {
+            w.byte(inst.op == X86Op::JMP ? 0xEB
+                                         : static_cast<uint8_t>(0x70 | cc));
+            w.immediate(distance, 1);
+        } else {
+            if (inst.op == X86Op::JMP) {
+                w.byte(0xE9);
+            } else {
+                w.byte(0x0F);
+                w.byte(static_cast<uint8_t>(0x80 | cc));
+            }
+            w.immediate(distance, 4);
+        }
+    }
+}
+} // namespace myComp
@@ -0,0 +1,185 @@
+#include "X86_Instruction.h"
+#include "Errors.h"
+
+namespace {
+using namespace myComp;
+
+constexpr const char *q_registers[] = {
+    "%rax", "%rcx", "%rdx", "%rbx", "%rsp", "%rbp", "%rsi", "%rdi",
+    "%r8",  "%r9",  "%r10", "%r11", "%r12", "%r13", "%r14", "%r15"};
+constexpr const char *d_registers[] = {
+    "%eax", "%ecx", "%edx", "%ebx", "%esp", "%ebp", "%esi", "%edi",
+    "%r8d", "%r9d", "%r10d", "%r11d", "%r12d", "%r13d", "%r14d", "%r15d"};
+constexpr const char *w_registers[] = {
+    "%ax",  "%cx",  "%dx",   "%bx",   "%sp",   "%bp",   "%si",   "%di",
+    "%r8w", "%r9w", "%r10w", "%r11w", "%r12w", "%r13w", "%r14w", "%r15w"};
+constexpr const char *b_registers[] = {
+    "%al",  "%cl",  "%dl",   "%bl",   "%spl",  "%bpl",  "%sil",  "%dil",
+    "%r8b", "%r9b", "%r10b", "%r11b", "%r12b", "%r13b", "%r14b", "%r15b"};
+
+constexpr const char *conditions[] = {"e", "ne", "l",  "le", "g",
+                                      "ge", "b", "be", "a",  "ae"};
+
+char suffix(int size) {
+    switch (size) {
+    case 1:
+        return 'b';
+    case 2:
+        return 'w';
+    case 4:
+        return 'l';
+    case 8:
+        return 'q';
+    default:
+        throw LogicException("Invalid size");
+    }
+}
+
+const char *mnemonic(X86Op op) {
+    switch (op) {
+    case X86Op::MOV:
+        return "mov";
+    case X86Op::LEA:
+        return "lea";
+    case X86Op::ADD:
+        return "add";
+    case X86Op::SUB:
+        return "sub";
+    case X86Op::IMUL:
+        return "imul";
+    case X86Op::AND:
+        return "and";
+    case X86Op::OR:
+        return "or";
+    case X86Op::XOR:
+        return "xor";
+    case X86Op::SAL:
+        return "sal";
+    case X86Op::SAR:
+        return "sar";
+    case X86Op::SHR:
+        return "shr";
+    case X86Op::NEG:
+        return "neg";
+    case X86Op::NOT:
+        return "not";
+    case X86Op::INC:
+        return "inc";
+    case X86Op::DEC:
+        return "dec";
+    case X86Op::CMP:
+        return "cmp";
+    case X86Op::TEST:
+        return "test";
+    case X86Op::PUSH:
+        return "push";
+    case X86Op::POP:
+        return "pop";
+    case X86Op::IDIV:
+        return "idiv";
+    case X86Op::DIV:
+        return "div";
+    case X86Op::MUL:
+        return "mul";
+    default:
+        throw LogicException("Instruction has no plain mnemonic");
+    }
+}
+} // namespace
+
+namespace myComp {
+const char *register_name(int reg, int size) {
+    if (!X86Reg::is_physical(reg)) {
+        throw LogicException("Unallocated register " + std::to_string(reg));
+    }
+    switch (size) {
+    case 1:
+        return b_registers[reg];
+    case 2:
+        return w_registers[reg];
+    case 4:
+        return d_registers[reg];
+    case 8:
+        return q_registers[reg];
+    default:
+        throw LogicException("Invalid size");
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, const X86Operand &operand) {
+    switch (operand.kind) {
+    case X86Operand::Kind::REG:
+        return os << register_name(operand.reg, operand.size);
+    case X86Operand::Kind::IMM:
+        return os << '$' << operand.value;
+    case X86Operand::Kind::MEM:
+        if (operand.reg == X86Reg::RIP) {
+            os << operand.symbol;
+            if (operand.value != 0)
+                os << '+' << operand.value;
+            return os << "(%rip)";
+        }
+        if (operand.value != 0)
+            os << operand.value;
+        os << '(' << register_name(operand.reg, 8);
+        if (operand.index != -1) {
+            os << ',' << register_name(operand.index, 8) << ','
+               << static_cast<int>(operand.scale);
+        }
+        return os << ')';
+    case X86Operand::Kind::SYMBOL:
+        return os << operand.symbol;
+    default:
+        throw LogicException("Printing an empty operand");
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, const X86Instruction &inst) {
+    switch (inst.op) {
+    case X86Op::LABEL:
+        return os << inst.src << ":\n";
+    case X86Op::MOVZX:
+    case X86Op::MOVSX:
+        // There is no movzlq, writing a 32-bit register clears the upper half
+        if (inst.op == X86Op::MOVZX && inst.src.size == 4) {
+            return os << "\tmovl\t" << inst.src << ", "
+                      << register_name(inst.dst.reg, 4) << "\n";
+        }
+        return os << '\t' << (inst.op == X86Op::MOVZX ? "movz" : "movs")
+                  << suffix(inst.src.size) << suffix(inst.dst.size) << '\t'
+                  << inst.src << ", " << inst.dst << "\n";
+    case X86Op::SETCC:
+        return os << "\tset" << conditions[static_cast<int>(inst.cond)] << '\t'
+                  << inst.dst << "\n";
+    case X86Op::JMP:
+        return os << "\tjmp\t" << inst.src << "\n";
+    case X86Op::JCC:
+        return os << "\tj" << conditions[static_cast<int>(inst.cond)] << '\t'
+                  << inst.src << "\n";
+    case X86Op::CALL:
+        return os << "\tcall\t" << inst.src << "\n";
+    case X86Op::CQTO:
+        return os << (inst.size == 8 ? "\tcqto\n" : "\tcltd\n");
+    case X86Op::RET:
+        return os << "\tret\n";
+    default:
+        break;
+    }
+
+    // movq only takes a sign-extended 32-bit immediate
+    if (inst.op == X86Op::MOV && inst.src.is_imm() && inst.dst.is_reg() &&
+        inst.src.value != static_cast<int>(inst.src.value)) {
+        return os << "\tmovabsq\t" << inst.src << ", " << inst.dst << "\n";
+    }
+
+    os << '\t' << mnemonic(inst.op) << suffix(inst.size) << '\t';
+    if (inst.src.kind != X86Operand::Kind::NONE) {
+        os << inst.src;
+        if (inst.dst.kind != X86Operand::Kind::NONE)
+            os << ", ";
+    }
+    if (inst.dst.kind != X86Operand::Kind::NONE)
+        os << inst.dst;
+    return os << "\n";
+}
+} // namespace myComp
@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <dlfcn.h>
+#include <elf.h>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <unordered_set>
+
+#include "Errors.h"
+#include "X86_Output.h"
+
+// The runtime library, built into the compiler for the JIT
+extern "C" {
+void printint(long x);
+void printchar(long x);
+}
+
+namespace {
+using namespace myComp;
+
+// Sections of the object file, in order
+enum Section : uint16_t {
+    NO_SECTION,
+    TEXT,
+    DATA,
+    RODATA,
+    RELA_TEXT,
+    SYMTAB,
+    STRTAB,
+    SHSTRTAB,
+    NOTE_STACK,
+    NUM_SECTIONS,
+};
+
+// The symbol of a section that holds code or data has the number of the
+// section, the global symbols follow
+constexpr uint32_t FIRST_GLOBAL = RODATA + 1;
+
+// Names of strings, each ending with a null byte
+class StringTable {
+  public:
+    StringTable() : bytes_(1, '\0') {}
+
+    uint32_t add(std::string_view str) {
+        auto offset = static_cast<uint32_t>(bytes_.size());
+        bytes_.append(str);
+        bytes_.push_back('\0');
+        return offset;
+    }
+
+    const std::string &bytes() const { return bytes_; }
+
+  private:
+    std::string bytes_;
+};
+
+template <typename T> void append(std::string &out, const T &value) {
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void align(std::string &out, size_t alignment) {
+    out.resize((out.size() + alignment - 1) / alignment * alignment, '\0');
+}
+
+// jmp *0(%rip) followed by the address, padded with int3
+constexpr size_t STUB_SIZE = 16;
+
+size_t round_up(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+// Address of a symbol the translation unit uses but does not define
+void *resolve(Symbol name) {
+    if (name.view() == "printint")
+        return reinterpret_cast<void *>(&printint);
+    if (name.view() == "printchar")
+        return reinterpret_cast<void *>(&printchar);
+    void *address = dlsym(RTLD_DEFAULT, std::string(name.view()).c_str());
+    if (address == nullptr) {
+        throw InvalidException("reference to undefined symbol " +
+                               std::string(name.view()));
+    }
+    return address;
+}
+
+// Escape a string literal for the assembler
+std::string escape(std::string_view str) {
+    std::string result;
+    for (char c : str) {
+        switch (c) {
+        case '\a':
+            result += R"(\a)";
+            break;
+        case '\b':
+            result += R"(\b)";
+            break;
+        case '\f':
+            result += R"(\f)";
+            break;
+        case '\n':
+            result += R"(\n)";
+            break;
+        case '\r':
+            result += R"(\r)";
+            break;
+        case '\t':
+            result += R"(\t)";
+            break;
+        case '\v':
+            result += R"(\v)";
+            break;
+        case '\\':
+            result += R"(\\)";
+            break;
+        case '\'':
+            result += R"(\')";
+            break;
+        case '\"':
+            result += R"(\")";
+            break;
+        default:
+            result += c;
+            break;
+        }
+    }
+    return result;
+}
+} // namespace
+
+namespace myComp {
+X86_AsmOutput::X86_AsmOutput(std::string_view filename)
+    : file_(std::string(filename)) {
+    if (!file_.is_open()) {
+        throw IOException("cannot open file " + std::string(filename));
+    }
+}
+
+void X86_AsmOutput::function(Symbol name,
+                             const std::vector<X86Instruction> &code) {
+    file_ << "\t.text\n"
+          << "\t.globl\t" << name << "\n"
+          << "\t.type\t" << name << ", @function\n"
+          << name << ":\n";
+    for (const auto &inst : code) {
+        file_ << inst;
+    }
+}
+
+void X86_AsmOutput::string_literal(Symbol label, std::string_view str) {
+    file_ << "\t.section\t.rodata\n"
+          << label << ":\n"
+          << "\t.string\t\"" << escape(str) << "\"\n";
+}
+
+void X86_AsmOutput::global_variable(Symbol name, int element_size,
+                                    int count) {
+    file_ << "\t.data\n"
+          << "\t.globl\t" << name << "\n"
+          << name << ":\n";
+    for (int i = 0; i < count; ++i) {
+        switch (element_size) {
+        case 1:
+            file_ << "\t.byte\t0\n";
+            break;
+        case 4:
+            file_ << "\t.long\t0\n";
+            break;
+        case 8:
+            file_ << "\t.quad\t0\n";
+            break;
+        }
+    }
+}
+
+void X86_AsmOutput::finish() { file_.close(); }
+
+void X86_MemoryOutput::function(Symbol name,
+                             const std::vector<X86Instruction> &code) {
+    uint64_t offset = text_.size();
+    encoder_.encode(code, text_, relocations_);
+    definitions_.push_back({name, offset, text_.size() - offset, true});
+}
+
+void X86_MemoryOutput::string_literal(Symbol label, std::string_view str) {
+    literals_[label] = rodata_.size();
+    rodata_.insert(rodata_.end(), str.begin(), str.end());
+    rodata_.push_back(0);
+}
+
+void X86_MemoryOutput::global_variable(Symbol name, int element_size,
+                                       int count) {
+    // Align the variable to its elements
+    size_t alignment = std::max(element_size, 1);
+    data_.resize((data_.size() + alignment - 1) / alignment * alignment, 0);
+
+    uint64_t offset = data_.size();
+    uint64_t size = static_cast<uint64_t>(element_size) * count;
+    data_.resize(data_.size() + size, 0);
+    definitions_.push_back({name, offset, size, false});
+}
+
+X86_ElfOutput::X86_ElfOutput(std::string_view filename)
+    : file_(std::string(filename), std::ios::binary) {
+    if (!file_.is_open()) {
+        throw IOException("cannot open file " + std::string(filename));
+    }
+}
+
+void X86_ElfOutput::finish() {
+    StringTable strtab;
+    std::string symtab;
+    std::string rela;
+
+    // The null symbol and the symbols of the sections
+    append(symtab, Elf64_Sym{});
+    for (Section section : {TEXT, DATA, RODATA}) {
+        Elf64_Sym sym{};
+        sym.st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION);
+        sym.st_shndx = section;
+        append(symtab, sym);
+    }
+
+    // Global symbols, the defined ones first
+    std::unordered_map<Symbol, uint32_t> globals;
+    uint32_t num_symbols = FIRST_GLOBAL;
+    for (const auto &definition : definitions_) {
+        Elf64_Sym sym{};
+        sym.st_name = strtab.add(definition.name.view());
+        sym.st_info = ELF64_ST_INFO(
+            STB_GLOBAL, definition.is_function ? STT_FUNC : STT_OBJECT);
+        sym.st_shndx = definition.is_function ? TEXT : DATA;
+        sym.st_value = definition.offset;
+        sym.st_size = definition.size;
+        append(symtab, sym);
+        globals[definition.name] = num_symbols++;
+    }
+
+    for (const auto &relocation : relocations_) {
+        uint32_t symbol;
+        int64_t addend = relocation.addend;
+        if (auto it = literals_.find(relocation.symbol);
+            it != literals_.end()) {
+            symbol = RODATA;
+            addend += static_cast<int64_t>(it->second);
+        } else if (auto it = globals.find(relocation.symbol);
+                   it != globals.end()) {
+            symbol = it->second;
+        } else {
+            Elf64_Sym sym{};
+            sym.st_name = strtab.add(relocation.symbol.view());
+            sym.st_info = ELF64_ST_INFO(STB_GLOBAL, STT_NOTYPE);
+            sym.st_shndx = SHN_UNDEF;
+            append(symtab, sym);
+            symbol = num_symbols++;
+            globals[relocation.symbol] = symbol;
+        }
+
+        Elf64_Rela entry{};
+        entry.r_offset = relocation.offset;
+        entry.r_info = ELF64_R_INFO(symbol, relocation.type);
+        entry.r_addend = addend;
+        append(rela, entry);
+    }
+
+    StringTable shstrtab;
+    Elf64_Shdr headers[NUM_SECTIONS] = {};
+    std::string out(sizeof(Elf64_Ehdr), '\0');
+
+    // Put the contents of a section in the file and fill in its header
+    auto section = [&](Section index, std::string_view name, uint32_t type,
+                       uint64_t flags, std::string_view bytes,
+                       uint64_t alignment) {
+        align(out, alignment);
+        Elf64_Shdr &header = headers[index];
+        header.sh_name = shstrtab.add(name);
+        header.sh_type = type;
+        header.sh_flags = flags;
+        header.sh_offset = out.size();
+        header.sh_size = bytes.size();
+        header.sh_addralign = alignment;
+        out.append(bytes);
+    };
+    auto view = [](const std::vector<uint8_t> &bytes) {
+        return std::string_view(reinterpret_cast<const char *>(bytes.data()),
+                                bytes.size());
+    };
+
+    section(TEXT, ".text", SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR,
+            view(text_), 16);
+    section(DATA, ".data", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE, view(data_),
+            8);
+    section(RODATA, ".rodata", SHT_PROGBITS, SHF_ALLOC, view(rodata_), 1);
+    section(RELA_TEXT, ".rela.text", SHT_RELA, SHF_INFO_LINK, rela, 8);
+    headers[RELA_TEXT].sh_link = SYMTAB;
+    headers[RELA_TEXT].sh_info = TEXT;
+    headers[RELA_TEXT].sh_entsize = sizeof(Elf64_Rela);
+    section(SYMTAB, ".symtab", SHT_SYMTAB, 0, symtab, 8);
+    headers[SYMTAB].sh_link = STRTAB;
+    headers[SYMTAB].sh_info = FIRST_GLOBAL;
+    headers[SYMTAB].sh_entsize = sizeof(Elf64_Sym);
+    section(STRTAB, ".strtab", SHT_STRTAB, 0, strtab.bytes(), 1);
+    // The stack of the program does not need to be executable
+    section(NOTE_STACK, ".note.GNU-stack", SHT_PROGBITS, 0, {}, 1);
+    // Its own name goes in the table before the table is written
+    headers[SHSTRTAB].sh_name = shstrtab.add(".shstrtab");
+    headers[SHSTRTAB].sh_type = SHT_STRTAB;
+    headers[SHSTRTAB].sh_offset = out.size();
+    headers[SHSTRTAB].sh_size = shstrtab.bytes().size();
+    headers[SHSTRTAB].sh_addralign = 1;
+    out.append(shstrtab.bytes());
+
+    align(out, 8);
+    uint64_t section_headers = out.size();
+    for (const auto &header : headers)
+        append(out, header);
+
+    Elf64_Ehdr header{};
+    std::memcpy(header.e_ident, ELFMAG, SELFMAG);
+    header.e_ident[EI_CLASS] = ELFCLASS64;
+    header.e_ident[EI_DATA] = ELFDATA2LSB;
+    header.e_ident[EI_VERSION] = EV_CURRENT;
+    header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    header.e_type = ET_REL;
+    header.e_machine = EM_X86_64;
+    header.e_version = EV_CURRENT;
+    header.e_shoff = section_headers;
+    header.e_ehsize = sizeof(Elf64_Ehdr);
+    header.e_shentsize = sizeof(Elf64_Shdr);
+    header.e_shnum = NUM_SECTIONS;
+    header.e_shstrndx = SHSTRTAB;
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    file_.write(out.data(), static_cast<std::streamsize>(out.size()));
+    file_.close();
+}
+
+X86_JitOutput::~X86_JitOutput() {
+    if (memory_ != nullptr) {
+        munmap(memory_, size_);
+    }
+}
+
+void X86_JitOutput::finish() {
+    // A stub for each function called but not defined
+    std::unordered_set<Symbol> defined;
+    for (const auto &definition : definitions_)
+        defined.insert(definition.name);
+    std::unordered_map<Symbol, size_t> stubs;
+    std::vector<Symbol> externals;
+    for (const auto &relocation : relocations_) {
+        if (literals_.contains(relocation.symbol) ||
+            defined.contains(relocation.symbol) ||
+            stubs.contains(relocation.symbol)) {
+            continue;
+        }
+        stubs[relocation.symbol] = text_.size() + externals.size() * STUB_SIZE;
+        externals.push_back(relocation.symbol);
+    }
+
+    // Lay out the sections on their own pages
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t text_size =
+        round_up(text_.size() + externals.size() * STUB_SIZE, page);
+    size_t data_offset = text_size;
+    size_t rodata_offset = data_offset + round_up(data_.size(), page);
+    size_ = std::max(rodata_offset + round_up(rodata_.size(), page), page);
+
+    void *memory = mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw IOException(std::string("cannot map memory for the code: ") +
+                          std::strerror(errno));
+    }
+    memory_ = static_cast<uint8_t *>(memory);
+    std::copy(text_.begin(), text_.end(), memory_);
+    std::copy(data_.begin(), data_.end(), memory_ + data_offset);
+    std::copy(rodata_.begin(), rodata_.end(), memory_ + rodata_offset);
+
+    for (const auto &definition : definitions_) {
+        addresses_[definition.name] =
+            memory_ + (definition.is_function ? 0 : data_offset) +
+            definition.offset;
+    }
+
+    for (Symbol name : externals) {
+        uint8_t *stub = memory_ + stubs[name];
+        const uint8_t jump[] = {0xFF, 0x25, 0, 0, 0, 0};
+        std::copy(std::begin(jump), std::end(jump), stub);
+        void *target = resolve(name);
+        std::memcpy(stub + sizeof(jump), &target, sizeof(target));
+        std::fill(stub + sizeof(jump) + sizeof(target), stub + STUB_SIZE,
+                  0xCC);
+    }
+
+    for (const auto &relocation : relocations_) {
+        uint8_t *target;
+        if (auto it = literals_.find(relocation.symbol);
+            it != literals_.end()) {
+            target = memory_ + rodata_offset + it->second;
+        } else if (auto it = addresses_.find(relocation.symbol);
+                   it != addresses_.end()) {
+            target = it->second;
+        } else if (relocation.type == R_X86_64_PLT32) {
+            target = memory_ + stubs[relocation.symbol];
+        } else {
+            // Only functions are reached through a stub, the data of a
+            // library may be anywhere
+            throw InvalidException("reference to unresolved symbol " +
+                                   std::string(relocation.symbol.view()));
+        }
+
+        uint8_t *field = memory_ + relocation.offset;
+        int64_t value = target + relocation.addend - field;
+        if (value != static_cast<int32_t>(value)) {
+            throw InvalidException("relocation against " +
+                                   std::string(relocation.symbol.view()) +
+                                   ", it is out of reach");
+        }
+        auto value32 = static_cast<int32_t>(value);
+        std::memcpy(field, &value32, sizeof(value32));
+    }
+
+    // The code cannot be written any more, the literals neither
+    if (mprotect(memory_, text_size, PROT_READ | PROT_EXEC) != 0 ||
+        (!rodata_.empty() && mprotect(memory_ + rodata_offset,
+                                      size_ - rodata_offset, PROT_READ) != 0)) {
+        throw IOException(std::string("cannot protect the code: ") +
+                          std::strerror(errno));
+    }
+}
+
+void *X86_JitOutput::address(Symbol name) const {
+    auto it = addresses_.find(name);
+    return it == addresses_.end() ? nullptr : it->second;
+}
+} // namespace myComp
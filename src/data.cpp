@@ -59,8 +59,8 @@ const std::map<ASTNodeType, const char *> ASTNode_str = {
 };
 
 // String literals
-std::map<std::string, std::string> string_literals;
+thread_local std::map<Symbol, std::string> string_literals;
 
 // Assembly code generator
-CodeGenerator *code_generator;
+thread_local CodeGenerator *code_generator;
 } // namespace myComp
@@ -0,0 +1,3 @@
+int main() {
+    char c;
+    c = '
\ No newline at end of file
@@ -0,0 +1,5 @@
+int main() {
+    char *s;
+    s = "abc;
+    return 0;
+}
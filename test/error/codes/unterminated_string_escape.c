@@ -0,0 +1,5 @@
+int main() {
+    char *s;
+    s = "say \"hi\";
+    return 0;
+}
@@ -0,0 +1,73 @@
+void printint(long n);
+
+int global[16];
+char letters[8];
+
+int find_max(int *values, int count) {
+    int i;
+    int best;
+    best = values[0];
+    for (i = 1; i < count; i++) {
+        if (values[i] > best) {
+            best = values[i];
+        }
+    }
+    return best;
+}
+
+long sum_local() {
+    long squares[10];
+    int i;
+    long sum;
+    for (i = 0; i < 10; i++) {
+        squares[i] = i * i;
+    }
+    squares[3] = squares[3] + 100;
+    sum = 0;
+    for (i = 0; i < 10; i++) {
+        sum = sum * 3 + squares[i];
+    }
+    return sum;
+}
+
+int shift(int *p) {
+    p[0 - 1] = p[0] + p[1];
+    *(p + 2) = *(p - 1) * 2;
+    return p[2];
+}
+
+int main() {
+    int local[6];
+    char text[5];
+    long i;
+    int *p;
+    for (i = 0; i < 16; i++) {
+        global[i] = (i * 37) % 23;
+    }
+    printint(find_max(global, 16));
+    printint(find_max(global + 5, 3));
+    printint(sum_local());
+
+    local[0] = 4;
+    local[1] = 9;
+    local[2] = 16;
+    local[3] = 25;
+    local[4] = 36;
+    local[5] = 49;
+    printint(shift(local + 2));
+    for (i = 0; i < 6; i++) {
+        printint(local[i]);
+    }
+
+    for (i = 0; i < 5; i++) {
+        text[i] = 'a' + i;
+        letters[i + 2] = text[i] + 1;
+    }
+    printint(text[4] - text[0]);
+    printint(letters[2] + letters[6]);
+    p = global;
+    *p = 1000;
+    *(p + 15) = *p + 1;
+    printint(global[0] + global[15]);
+    return 0;
+}
@@ -0,0 +1,55 @@
+void printf(char *fmt, ...);
+
+int calls;
+
+int check(int x) {
+    calls = calls + 1;
+    return x;
+}
+
+int main() {
+    int i;
+    int n;
+    char c;
+    char *p;
+    char s[4];
+
+    n = 0;
+    for (i = 0; i < 10 && check(i) != 7; i++) {
+        n = n + i;
+    }
+    printf("%d %d %d\n", i, n, calls);
+
+    calls = 0;
+    if (check(0) && check(1)) {
+        printf("wrong\n");
+    }
+    if (check(1) || check(0)) {
+        printf("or %d\n", calls);
+    }
+    if (!(check(2) < 1) && !check(0)) {
+        printf("not %d\n", calls);
+    }
+
+    c = 200;
+    if (c > 100) {
+        printf("char above\n");
+    }
+    p = s;
+    if (p + 1 > p && p <= s + 3 && p != 0) {
+        printf("pointers\n");
+    }
+
+    n = 0;
+    i = 10;
+    while (i >= 0 || n < 3) {
+        i = i - 4;
+        n++;
+    }
+    printf("%d %d\n", i, n);
+
+    if (5 > i && i > -10) {
+        printf("constant left\n");
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+void printint(long n);
+
+int g;
+
+int main() {
+    int a;
+    int b;
+    long c;
+    char d;
+    int *p;
+    int q;
+    int i;
+
+    printint(7 * 6 - 2);
+    printint(-7 / 2);
+    printint(-7 % 2);
+    printint(1 << 30);
+    printint(~0 >> 4);
+    printint(!5 + (3 < 4) + (2 == 2) + (1 && 0) + (0 || 7));
+
+    a = 10;
+    b = a * 3;
+    c = 2147483647;
+    c = c + b;
+    printint(c);
+    c = 65536;
+    c = c * c * 3;
+    printint(c);
+    d = 300;
+    printint(d + 1);
+    a++;
+    printint(a);
+
+    if (g) {
+        b = 1;
+    } else {
+        b = 2;
+    }
+    printint(b);
+    a = 5;
+    if (g) {
+        b = a;
+    } else {
+        b = 5;
+    }
+    printint(b);
+
+    if (1 < 2) {
+        printint(100);
+    } else {
+        printint(200);
+    }
+    if (a - 5) {
+        printint(300);
+    }
+    while (0) {
+        printint(400);
+    }
+
+    a = 0;
+    b = 0;
+    while (a < 5) {
+        b = b + a;
+        a = a + 1;
+    }
+    printint(a);
+    printint(b);
+    c = 0;
+    for (i = 0; i < 4; i++) {
+        c = c + i;
+    }
+    printint(c);
+    printint(i);
+
+    q = 1;
+    p = &q;
+    *p = 9;
+    printint(q);
+
+    g = 3;
+    printint(g + 1);
+
+    a = 0;
+    if (a) {
+        printint(1 / a);
+    }
+
+    return 0;
+}
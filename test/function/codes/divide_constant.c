@@ -0,0 +1,94 @@
+void printint(long n);
+
+int values[12];
+long big[10];
+
+long mix(long sum, long value) {
+    return (sum * 31 + value) % 1000000007;
+}
+
+long by_int(int x) {
+    long sum;
+    sum = 0;
+    sum = mix(sum, x / 1);
+    sum = mix(sum, x / 2);
+    sum = mix(sum, x % 2);
+    sum = mix(sum, x / 3);
+    sum = mix(sum, x % 3);
+    sum = mix(sum, x / 5);
+    sum = mix(sum, x / 7);
+    sum = mix(sum, x % 7);
+    sum = mix(sum, x / 10);
+    sum = mix(sum, x % 10);
+    sum = mix(sum, x / 16);
+    sum = mix(sum, x % 16);
+    sum = mix(sum, x / 60);
+    sum = mix(sum, x / 641);
+    sum = mix(sum, x % 1000);
+    sum = mix(sum, x / 65536);
+    sum = mix(sum, x / 2147483647);
+    sum = mix(sum, x % 2147483647);
+    sum = mix(sum, x / (0 - 3));
+    sum = mix(sum, x % (0 - 7));
+    sum = mix(sum, x / (0 - 16));
+    sum = mix(sum, x % (0 - 16));
+    return sum;
+}
+
+long by_long(long x) {
+    long sum;
+    sum = 0;
+    sum = mix(sum, x / 3);
+    sum = mix(sum, x % 3);
+    sum = mix(sum, x / 7);
+    sum = mix(sum, x % 10);
+    sum = mix(sum, x / 64);
+    sum = mix(sum, x % 64);
+    sum = mix(sum, x / 1000000007);
+    sum = mix(sum, x / 4294967296);
+    sum = mix(sum, x % 4294967296);
+    sum = mix(sum, x / 6000000000);
+    sum = mix(sum, x % 6000000000);
+    sum = mix(sum, x / 9223372036854775807);
+    sum = mix(sum, x / (0 - 5));
+    sum = mix(sum, x % (0 - 1000));
+    return sum;
+}
+
+int bucket(char c) {
+    return c % 13 + c / 3;
+}
+
+int main() {
+    int i;
+    values[0] = 0;
+    values[1] = 1;
+    values[2] = 0 - 1;
+    values[3] = 7;
+    values[4] = 0 - 7;
+    values[5] = 123456789;
+    values[6] = 0 - 123456789;
+    values[7] = 2147483647;
+    values[8] = 0 - 2147483647;
+    values[9] = 0 - 2147483647 - 1;
+    values[10] = 65535;
+    values[11] = 0 - 65536;
+    for (i = 0; i < 12; i++) {
+        printint(by_int(values[i]));
+    }
+    big[0] = 0;
+    big[1] = 5;
+    big[2] = 0 - 5;
+    big[3] = 9223372036854775807;
+    big[4] = 0 - 9223372036854775807;
+    big[5] = 0 - 9223372036854775807 - 1;
+    big[6] = 4294967296;
+    big[7] = 0 - 4294967297;
+    big[8] = 123456789012345;
+    big[9] = 0 - 987654321098765;
+    for (i = 0; i < 10; i++) {
+        printint(by_long(big[i]));
+    }
+    printint(bucket(250) + bucket(7));
+    return 0;
+}
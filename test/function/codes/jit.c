@@ -0,0 +1,30 @@
+void printf(char *fmt, ...);
+void printint(long x);
+void printchar(long x);
+
+long total;
+char letters[3];
+
+long sum(int n) {
+    int i;
+    long s;
+    s = 0;
+    for (i = 1; i <= n; i++) {
+        s = s + i;
+    }
+    return s;
+}
+
+int main() {
+    total = sum(100);
+    printint(total);
+    letters[0] = 74;
+    letters[1] = 73;
+    letters[2] = 84;
+    printchar(letters[0]);
+    printchar(letters[1]);
+    printchar(letters[2]);
+    printchar(10);
+    printf("%s %ld\n", "done", total * 2);
+    return 0;
+}
@@ -0,0 +1,47 @@
+void printint(long n);
+
+int g;
+
+int add(int a, int b) {
+    return a + b;
+}
+
+int seven(int a, int b, int c, int d, int e, int f, int h) {
+    return a + b * c - d + e * f + h;
+}
+
+int squares() {
+    int x[5];
+    int i;
+    for (i = 0; i < 5; i++) {
+        x[i] = i * i;
+    }
+    return x[4] + x[2];
+}
+
+int big_frame() {
+    long x[40];
+    int i;
+    for (i = 0; i < 40; i++) {
+        x[i] = i;
+    }
+    return x[39] + x[0];
+}
+
+long pressure(long a, long b, long c) {
+    return (a + b) * (b + c) + (a * c + (b - a) * (c - b)) * ((a + 1) * (b + 2) + (c + 3) * (a + 4)) + ((a * b) - (b * c) + (c * a)) * ((a - 5) * (b - 6) - (c - 7) * (a - 8));
+}
+
+void set_global(int v) {
+    g = v;
+}
+
+int main() {
+    set_global(3);
+    printint(add(2, 5) + g);
+    printint(seven(1, 2, 3, 4, 5, 6, 7));
+    printint(squares());
+    printint(big_frame());
+    printint(pressure(3, 5, 7));
+    return 0;
+}
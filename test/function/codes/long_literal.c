@@ -0,0 +1,15 @@
+void printint(long n);
+
+int main() {
+    long h;
+    int i;
+    h = 2166136261;
+    printint(h);
+    printint(h & 4294967295);
+    printint(h * 16777619 & 4294967295);
+    h = 9000000000000000000;
+    printint(h);
+    i = 2147483647;
+    printint(i);
+    return 0;
+}
@@ -0,0 +1,147 @@
+void printint(long n);
+
+int fib(int n) {
+    int a;
+    int b;
+    int t;
+    int i;
+    a = 0;
+    b = 1;
+    for (i = 0; i < n; i++) {
+        t = a + b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+int swaps(int n) {
+    int x;
+    int y;
+    int z;
+    int i;
+    x = 1;
+    y = 2;
+    z = 3;
+    for (i = 0; i < n; i++) {
+        z = x;
+        x = y;
+        y = z;
+    }
+    return x * 100 + y * 10 + z;
+}
+
+long nested(int n) {
+    long sum;
+    int i;
+    int j;
+    sum = 0;
+    for (i = 0; i < n; i++) {
+        for (j = i; j < n; j++) {
+            if (i % 2 == 0 && j % 3 != 0) {
+                sum = sum + i * j;
+            } else {
+                sum = sum - 1;
+            }
+        }
+    }
+    return sum;
+}
+
+int wrap() {
+    char c;
+    int steps;
+    c = 250;
+    steps = 0;
+    while (c != 4) {
+        c++;
+        steps++;
+    }
+    return steps * 1000 + c;
+}
+
+int countdown(int n) {
+    int old;
+    int total;
+    total = 0;
+    while (n > 0) {
+        old = n--;
+        total = total + old;
+    }
+    return total + n;
+}
+
+int taken(int n) {
+    int kept;
+    int counter;
+    int *p;
+    p = &kept;
+    kept = 0;
+    for (counter = 0; counter < n; counter++) {
+        *p = *p + counter;
+    }
+    return kept + counter;
+}
+
+long pressure(int n) {
+    long a;
+    long b;
+    long c;
+    long d;
+    long e;
+    long f;
+    long g;
+    long h;
+    long k;
+    long m;
+    long q;
+    long r;
+    long s;
+    long u;
+    long v;
+    int i;
+    a = 1;
+    b = 2;
+    c = 3;
+    d = 4;
+    e = 5;
+    f = 6;
+    g = 7;
+    h = 8;
+    k = 9;
+    m = 10;
+    q = 11;
+    r = 12;
+    s = 13;
+    u = 14;
+    v = 15;
+    for (i = 0; i < n; i++) {
+        a = a + b;
+        b = b + c;
+        c = c + d;
+        d = d + e;
+        e = e + f;
+        f = f + g;
+        g = g + h;
+        h = h + k;
+        k = k + m;
+        m = m + q;
+        q = q + r;
+        r = r + s;
+        s = s + u;
+        u = u + v;
+        v = v + fib(i % 10);
+    }
+    return a + b + c + d + e + f + g + h + k + m + q + r + s + u + v;
+}
+
+int main() {
+    printint(fib(30));
+    printint(swaps(5));
+    printint(nested(20));
+    printint(wrap());
+    printint(countdown(10));
+    printint(taken(10));
+    printint(pressure(12));
+    return 0;
+}
@@ -0,0 +1,17 @@
+void printint(long n);
+
+int scale(int a, int b) {
+    return a * 1 + b * 2 + a * 3 + b * 1024;
+}
+
+int main() {
+    int x;
+    x = 7;
+    printint(x * 1);
+    printint(x * 2);
+    printint(x * 3);
+    printint(x * 8);
+    printint(scale(x, 5));
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+void printint(long n);
+
+int values[8];
+long big[6];
+long table[20];
+char bytes[20];
+
+long mix(long sum, long value) {
+    return (sum * 31 + value) % 1000000007;
+}
+
+long by_int(int x) {
+    long sum;
+    sum = 0;
+    sum = mix(sum, x * 0);
+    sum = mix(sum, x * 1);
+    sum = mix(sum, x * 3);
+    sum = mix(sum, x * 5);
+    sum = mix(sum, x * 9);
+    sum = mix(sum, x * 10);
+    sum = mix(sum, x * 7);
+    sum = mix(sum, x * 15);
+    sum = mix(sum, x * 17);
+    sum = mix(sum, x * 25);
+    sum = mix(sum, x * 45);
+    sum = mix(sum, x * 81);
+    sum = mix(sum, x * 96);
+    sum = mix(sum, x * 1023);
+    sum = mix(sum, x * 1000);
+    sum = mix(sum, x * 100000);
+    sum = mix(sum, 12 * x);
+    sum = mix(sum, x * (0 - 1));
+    sum = mix(sum, x * (0 - 3));
+    sum = mix(sum, x * (0 - 8));
+    sum = mix(sum, x * (0 - 100));
+    return sum;
+}
+
+long by_long(long x) {
+    long sum;
+    sum = 0;
+    sum = mix(sum, x * 3);
+    sum = mix(sum, x * 40);
+    sum = mix(sum, x * 63);
+    sum = mix(sum, x * 65);
+    sum = mix(sum, x * 4294967296);
+    sum = mix(sum, x * 4294967297);
+    sum = mix(sum, x * 6000000000);
+    sum = mix(sum, x * (0 - 9));
+    sum = mix(sum, 11 * x);
+    return sum;
+}
+
+long scaled(long a, int b) {
+    return a + b * 4 + (a * 8 + b);
+}
+
+int main() {
+    int i;
+    long sum;
+    values[0] = 0;
+    values[1] = 1;
+    values[2] = 0 - 1;
+    values[3] = 7;
+    values[4] = 0 - 123;
+    values[5] = 123456;
+    values[6] = 2147483647;
+    values[7] = 0 - 2147483647 - 1;
+    for (i = 0; i < 8; i++) {
+        printint(by_int(values[i]));
+    }
+    big[0] = 0;
+    big[1] = 5;
+    big[2] = 0 - 5;
+    big[3] = 9223372036854775807;
+    big[4] = 4294967295;
+    big[5] = 0 - 987654321098765;
+    for (i = 0; i < 6; i++) {
+        printint(by_long(big[i]));
+    }
+
+    for (i = 0; i < 20; i++) {
+        table[i] = i * 3;
+        bytes[i] = i * 7;
+    }
+    sum = 0;
+    for (i = 0; i < 20; i++) {
+        sum = mix(sum, table[i] + bytes[19 - i]);
+        sum = mix(sum, *(table + i) * *(bytes + i));
+    }
+    printint(sum);
+    printint(scaled(1000, 3));
+    printint(scaled(0 - 7, 0 - 2));
+    return 0;
+}
@@ -0,0 +1,53 @@
+void printf(char *fmt, ...);
+
+int sign(int x) {
+    if (x < 0) {
+        return -1;
+    } else {
+        if (x == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+long widen(int x) {
+    long y;
+    y = x;
+    return y * 3;
+}
+
+int count(int n) {
+    int i;
+    int k;
+    k = 0;
+    for (i = 0; i < n; i++) {
+        if (i % 3 == 0) {
+            if (i % 2 == 0) {
+                k = k + 2;
+            } else {
+                k = k + 1;
+            }
+        }
+    }
+    return k;
+}
+
+char low(long x) {
+    char c;
+    c = x;
+    return c;
+}
+
+int main() {
+    long total;
+    int i;
+    total = 0;
+    for (i = 0 - 3; i < 4; i++) {
+        total = total + sign(i) * widen(i - 1);
+    }
+    printf("%d %ld\n", sign(0 - 7), total);
+    printf("%d %d\n", count(0), count(20));
+    printf("%d %d\n", low(300), low(0 - 1));
+    return 0;
+}
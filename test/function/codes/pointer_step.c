@@ -0,0 +1,54 @@
+void printf(char *fmt, ...);
+
+int main() {
+    int a[5];
+    int *p;
+    int *q;
+    long *r;
+    long b[3];
+    char c;
+    int i;
+    int t;
+
+    for (i = 0; i < 5; i++) {
+        a[i] = i * 10;
+    }
+
+    p = a;
+    p++;
+    printf("%d\n", *p);
+    ++p;
+    printf("%d\n", *p);
+    p--;
+    printf("%d\n", *p);
+    q = 3 + a;
+    printf("%d\n", *q);
+    printf("%ld\n", q - p);
+    printf("%ld\n", p - q);
+
+    r = b;
+    b[2] = 7;
+    r++;
+    ++r;
+    printf("%ld\n", *r);
+
+    c = 254;
+    ++c;
+    printf("%d\n", c);
+    if (++c) {
+        printf("not zero\n");
+    } else {
+        printf("zero\n");
+    }
+
+    t = a[1] && a[2] || a[0];
+    printf("%d\n", t);
+    t = a[0] && a[1];
+    printf("%d\n", t);
+    t = a[0] || a[3] > 5;
+    printf("%d\n", t);
+    t = !a[0] + !a[1];
+    printf("%d\n", t);
+
+    return 0;
+}
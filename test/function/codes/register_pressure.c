@@ -0,0 +1,23 @@
+void printint(long n);
+long f8(long a, long b, long c, long d, long e, long f, long g, long h) {
+    return a - b + c * d - e + f * g - h;
+}
+long add(long a, long b) { return a + b; }
+long g;
+int main() {
+    long a; long b; long c; int i; long s;
+    a = 3; b = 5; c = 7;
+    printint((b+(a+(c+(b+(a+(c+(b+(a+(c+(b+(a+(c+(b+(a+(c+(b+(a+a))))))))))))))))));
+    printint((c<<a+(b/c+(a%b+(b*c+(a*b+(c*a+(b*c+(a*b+(c*a+(b*c+(a*b+(c*a+(b*c+(a*b+(b-c))))))))))))))));
+    printint(f8(1, 2, 3, 4, 5, 6, 7, 8));
+    printint(f8(add(1, 2), add(add(3, 4), 5), 6, 7, f8(1,2,3,4,5,6,7,8), 9, add(10, 11), 12));
+    printint(add(a, add(b, add(c, add(a / b, c % b)))) + add(a << 2, c >> 1) * (b - a));
+    s = 0;
+    for (i = 0; i < 100; i++) {
+        s = s + (i % 7) * (i / 3) + (s % 1000) / (i + 1) + (i << 2) + add(i, s % 13);
+    }
+    printint(s);
+    g = 10;
+    printint(g / 3 + g % 3 + (g << 3) + add(g / 4, g % 4));
+    return 0;
+}
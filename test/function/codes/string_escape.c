@@ -0,0 +1,33 @@
+void printint(long n);
+void printchar(long x);
+
+void print(char *s) {
+    while (*s != 0) {
+        printchar(*s);
+        s = s + 1;
+    }
+}
+
+int length(char *s) {
+    int n;
+    n = 0;
+    while (s[n] != 0) {
+        n++;
+    }
+    return n;
+}
+
+int main() {
+    print("say \"hi\"\n");
+    print("back\\slash\n");
+    print("\"\\\"\\\n");
+    print("\"\n");
+    print("tab\there\\n\n");
+    printint(length("a\"b"));
+    printint(length("\\\\"));
+    printint(length("\"\""));
+    printint('\\');
+    printint('\"');
+    printint('\'');
+    return 0;
+}
@@ -2,10 +2,15 @@
 
 import os
 import subprocess
+import sys
+import tempfile
 from pathlib import Path
 
 all_correct = True
 
+# 命令行中的参数会传给每一次编译, 例如 python3 test.py -const-propagation
+extra_args = sys.argv[1:]
+
 
 def cleanup():
     # 删除生成的文件
@@ -13,37 +18,62 @@ def cleanup():
         os.remove("out")
     if os.path.exists("out.s"):
         os.remove("out.s")
+    if os.path.exists("out.o"):
+        os.remove("out.o")
 
 
 def compile_and_run_test(test_file: Path):
-    # 生成汇编文件
-    compile_result = subprocess.run(
-        ["../myComp", test_file], stdout=subprocess.PIPE, stderr=subprocess.PIPE
-    )
     test_name = test_file.stem
     output_path = test_file.parent.parent.joinpath("outputs")
 
+    # 如果测试有 .args 文件, 则将其中的参数传给编译器
+    args = list(extra_args)
+    if output_path.joinpath(test_name + ".args").exists():
+        with open(output_path.joinpath(test_name + ".args"), "r") as f:
+            args += f.read().split()
+
+    # 如果测试文件有输入, 则将输入重定向到测试文件
+    input_file = output_path.joinpath(test_name + ".in")
+    stdin = open(input_file, "r") if input_file.exists() else subprocess.DEVNULL
+
+    # 生成目标文件, 带 -S 时生成汇编文件, 带 -jit 时编译器直接运行程序
+    compile_result = subprocess.run(
+        ["../myComp", *args, test_file],
+        stdin=stdin,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+    )
+
     # 如果编译失败, 保存标准输出中的错误信息
     if compile_result.returncode != 0:
         output = compile_result.stderr.decode("utf-8").strip()
+    elif "-jit" in args:
+        output = compile_result.stdout.decode("utf-8").strip()
     # 否则生成可执行文件
     else:
-        subprocess.call(["cc", "-o", "out", "out.s", "../lib/printint.c"])
+        output_file = "out.s" if "-S" in args else "out.o"
+        subprocess.call(["cc", "-o", "out", output_file, "../lib/printint.c"])
 
-        # 运行测试, 如果测试文件有输入, 则将输入重定向到测试文件
-        # output = subprocess.check_output(["./out"]).decode("utf-8").strip()
-        if output_path.joinpath(test_name + ".in").exists():
-            with open(output_path.joinpath(test_name + ".in"), "r") as f:
+        # 运行测试
+        if input_file.exists():
+            with open(input_file, "r") as f:
                 output = (
                     subprocess.check_output(["./out"], stdin=f).decode("utf-8").strip()
                 )
         else:
             output = subprocess.check_output(["./out"]).decode("utf-8").strip()
 
+    if stdin is not subprocess.DEVNULL:
+        stdin.close()
+
     # 比较实际输出与预期输出
     expected_output_file = test_file.parent.parent.joinpath("outputs").joinpath(
         test_name + ".out"
     )
+    check_output(test_name, output, expected_output_file)
+
+
+def check_output(test_name, output, expected_output_file):
     with open(expected_output_file, "r") as f:
         expected_output = f.read().strip()
 
@@ -61,6 +91,55 @@ def compile_and_run_test(test_file: Path):
     print()
 
 
+def batch_test(test_files):
+    # 在一个进程中用 4 个线程编译所有没有 .args 文件的测试, 每个文件生成自己的目标文件
+    test_files = [
+        f
+        for f in test_files
+        if not f.parent.parent.joinpath("outputs", f.stem + ".args").exists()
+    ]
+    print(f"compiling {len(test_files)} test files in one process")
+    print()
+
+    with tempfile.TemporaryDirectory() as batch_dir:
+        batch_dir = Path(batch_dir)
+        compile_result = subprocess.run(
+            [
+                Path("../myComp").resolve(),
+                "-j4",
+                *extra_args,
+                *[f.resolve() for f in test_files],
+            ],
+            cwd=batch_dir,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+        )
+        if compile_result.returncode != 0:
+            print("batch compilation failed")
+            print(compile_result.stderr.decode("utf-8").strip())
+            global all_correct
+            all_correct = False
+            return
+
+        for test_file in test_files:
+            output_path = test_file.parent.parent.joinpath("outputs")
+            output_file = batch_dir.joinpath(
+                test_file.stem + (".s" if "-S" in extra_args else ".o")
+            )
+            executable = batch_dir.joinpath(test_file.stem)
+            subprocess.call(["cc", "-o", executable, output_file, "../lib/printint.c"])
+
+            input_file = output_path.joinpath(test_file.stem + ".in")
+            stdin = open(input_file, "r") if input_file.exists() else subprocess.DEVNULL
+            output = subprocess.check_output([executable], stdin=stdin).decode("utf-8").strip()
+            if stdin is not subprocess.DEVNULL:
+                stdin.close()
+
+            check_output(
+                "batch " + test_file.stem, output, output_path.joinpath(test_file.stem + ".out")
+            )
+
+
 def main():
     # 所有的测试类型
     test_types = [
@@ -82,6 +161,17 @@ def main():
         for test_file in test_files:
             compile_and_run_test(test_file)
 
+    # 一次编译多个文件, -jit 只能运行一个文件
+    if "-jit" not in extra_args:
+        print("running batch tests")
+        batch_test(
+            [
+                f
+                for test_type in ["algorithm", "function"]
+                for f in Path(test_type).joinpath("codes").rglob("*.c")
+            ]
+        )
+
     cleanup()
 
     if all_correct: